@@ -71,5 +71,38 @@ class TestAdd(unittest.TestCase):
             print("  Test ran successfully: difference is", diff)
 
 
+class TestAddLayouts(unittest.TestCase):
+    """The wrappers use the tensors they are given as is, on the CPU."""
+
+    def setUp(self):
+        self.add = modules._dispatch("add", optype=th.float32)
+
+    def test_strided(self):
+        # Views into larger tensors, so only the innermost dimension is compact.
+        a = th.rand(1, 2, 16, 8)[:, :, ::2, :]
+        b = th.rand(1, 2, 8, 16)[..., :8]
+        out = th.zeros(1, 2, 8, 16)[..., 8:]
+        assert not a.is_contiguous() and not b.is_contiguous() and not out.is_contiguous()
+        self.add(a, b, out)
+        assert th.equal(out, a + b)
+
+    def test_preallocated(self):
+        out = th.empty(1, 2, 8, 8)
+        storage = out.data_ptr()
+        for _ in range(3):
+            a = th.rand(1, 2, 8, 8)
+            b = th.rand(1, 2, 8, 8)
+            self.add(a, b, out)
+            assert th.equal(out, a + b)
+        assert out.data_ptr() == storage
+
+    def test_in_place(self):
+        a = th.rand(1, 2, 8, 8)
+        b = th.rand(1, 2, 8, 8)
+        expected = a + b
+        self.add(a, b, a)
+        assert th.equal(a, expected)
+
+
 if __name__ == "__main__":
     unittest.main()
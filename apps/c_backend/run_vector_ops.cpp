@@ -0,0 +1,158 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+#include "HalideBuffer.h"
+#include "vector_ops_c.h"
+#include "vector_ops_native.h"
+
+using namespace Halide::Runtime;
+
+namespace {
+
+// Wide enough that every lane count has full vectors and a tail.
+const int width = 1031;
+// One row per lane count in vector_ops_generator.cpp.
+const int rows = 4;
+
+// Fill a and b with random values, starting with every pairing of the
+// extremes of the type.
+template<typename T>
+void make_inputs(Buffer<T> &a, Buffer<T> &b) {
+    a = Buffer<T>(width);
+    b = Buffer<T>(width);
+    for (int x = 0; x < width; x++) {
+        a(x) = (T)rand();
+        b(x) = (T)rand();
+    }
+    const uint64_t high_bit = (uint64_t)1 << (sizeof(T) * 8 - 1);
+    const T extremes[] = {(T)0, (T)-1, (T)high_bit, (T)(high_bit - 1)};
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            a(i * 4 + j) = extremes[i];
+            b(i * 4 + j) = extremes[j];
+        }
+    }
+}
+
+template<typename T>
+struct Outputs {
+    Buffer<T> native{width, rows};
+    Buffer<T> c{width, rows};
+};
+
+// Check both the C backend and the native output against a scalar
+// reference computed from the inputs.
+template<typename T, typename In, typename Ref>
+bool check(const char *name, const Outputs<T> &out,
+           const Buffer<In> &a, const Buffer<In> &b, Ref ref) {
+    bool ok = true;
+    for (int y = 0; y < rows; y++) {
+        for (int x = 0; x < width; x++) {
+            const int64_t correct = ref((int64_t)a(x), (int64_t)b(x));
+            if (out.native(x, y) != correct || out.c(x, y) != correct) {
+                printf("%s(%lld, %lld) at (%d, %d): native = %lld, c = %lld, correct = %lld\n",
+                       name, (long long)a(x), (long long)b(x), x, y,
+                       (long long)out.native(x, y), (long long)out.c(x, y),
+                       (long long)correct);
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+template<typename T>
+int64_t saturate(int64_t x) {
+    const int64_t lo = (int64_t)std::numeric_limits<T>::min();
+    const int64_t hi = (int64_t)std::numeric_limits<T>::max();
+    return x < lo ? lo : (x > hi ? hi : x);
+}
+
+int64_t scalar_absd(int64_t a, int64_t b) {
+    return a > b ? a - b : b - a;
+}
+
+int64_t scalar_mul(int64_t a, int64_t b) {
+    return a * b;
+}
+
+template<typename T>
+int64_t scalar_saturating_add(int64_t a, int64_t b) {
+    return saturate<T>(a + b);
+}
+
+template<typename T>
+int64_t scalar_saturating_sub(int64_t a, int64_t b) {
+    return saturate<T>(a - b);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Buffer<uint8_t> a_u8, b_u8;
+    Buffer<int8_t> a_i8, b_i8;
+    Buffer<uint16_t> a_u16, b_u16;
+    Buffer<int16_t> a_i16, b_i16;
+    Buffer<uint32_t> a_u32, b_u32;
+    Buffer<int32_t> a_i32, b_i32;
+    make_inputs(a_u8, b_u8);
+    make_inputs(a_i8, b_i8);
+    make_inputs(a_u16, b_u16);
+    make_inputs(a_i16, b_i16);
+    make_inputs(a_u32, b_u32);
+    make_inputs(a_i32, b_i32);
+
+    Outputs<uint8_t> saturating_add_u8, saturating_sub_u8, absd_u8;
+    Outputs<uint16_t> widening_mul_u8;
+    Outputs<int8_t> saturating_add_i8, saturating_sub_i8;
+    Outputs<int16_t> widening_mul_i8;
+    Outputs<uint8_t> absd_i8;
+    Outputs<uint16_t> saturating_add_u16, saturating_sub_u16, absd_u16;
+    Outputs<uint32_t> widening_mul_u16;
+    Outputs<int16_t> saturating_add_i16, saturating_sub_i16;
+    Outputs<int32_t> widening_mul_i16;
+    Outputs<uint16_t> absd_i16;
+    Outputs<uint32_t> absd_u32, absd_i32;
+
+    vector_ops_native(a_u8, b_u8, a_i8, b_i8, a_u16, b_u16, a_i16, b_i16, a_u32, b_u32, a_i32, b_i32,
+                      saturating_add_u8.native, saturating_sub_u8.native, widening_mul_u8.native, absd_u8.native,
+                      saturating_add_i8.native, saturating_sub_i8.native, widening_mul_i8.native, absd_i8.native,
+                      saturating_add_u16.native, saturating_sub_u16.native, widening_mul_u16.native, absd_u16.native,
+                      saturating_add_i16.native, saturating_sub_i16.native, widening_mul_i16.native, absd_i16.native,
+                      absd_u32.native, absd_i32.native);
+
+    vector_ops_c(a_u8, b_u8, a_i8, b_i8, a_u16, b_u16, a_i16, b_i16, a_u32, b_u32, a_i32, b_i32,
+                 saturating_add_u8.c, saturating_sub_u8.c, widening_mul_u8.c, absd_u8.c,
+                 saturating_add_i8.c, saturating_sub_i8.c, widening_mul_i8.c, absd_i8.c,
+                 saturating_add_u16.c, saturating_sub_u16.c, widening_mul_u16.c, absd_u16.c,
+                 saturating_add_i16.c, saturating_sub_i16.c, widening_mul_i16.c, absd_i16.c,
+                 absd_u32.c, absd_i32.c);
+
+    bool ok = true;
+    ok &= check("saturating_add_u8", saturating_add_u8, a_u8, b_u8, scalar_saturating_add<uint8_t>);
+    ok &= check("saturating_sub_u8", saturating_sub_u8, a_u8, b_u8, scalar_saturating_sub<uint8_t>);
+    ok &= check("widening_mul_u8", widening_mul_u8, a_u8, b_u8, scalar_mul);
+    ok &= check("absd_u8", absd_u8, a_u8, b_u8, scalar_absd);
+    ok &= check("saturating_add_i8", saturating_add_i8, a_i8, b_i8, scalar_saturating_add<int8_t>);
+    ok &= check("saturating_sub_i8", saturating_sub_i8, a_i8, b_i8, scalar_saturating_sub<int8_t>);
+    ok &= check("widening_mul_i8", widening_mul_i8, a_i8, b_i8, scalar_mul);
+    ok &= check("absd_i8", absd_i8, a_i8, b_i8, scalar_absd);
+    ok &= check("saturating_add_u16", saturating_add_u16, a_u16, b_u16, scalar_saturating_add<uint16_t>);
+    ok &= check("saturating_sub_u16", saturating_sub_u16, a_u16, b_u16, scalar_saturating_sub<uint16_t>);
+    ok &= check("widening_mul_u16", widening_mul_u16, a_u16, b_u16, scalar_mul);
+    ok &= check("absd_u16", absd_u16, a_u16, b_u16, scalar_absd);
+    ok &= check("saturating_add_i16", saturating_add_i16, a_i16, b_i16, scalar_saturating_add<int16_t>);
+    ok &= check("saturating_sub_i16", saturating_sub_i16, a_i16, b_i16, scalar_saturating_sub<int16_t>);
+    ok &= check("widening_mul_i16", widening_mul_i16, a_i16, b_i16, scalar_mul);
+    ok &= check("absd_i16", absd_i16, a_i16, b_i16, scalar_absd);
+    ok &= check("absd_u32", absd_u32, a_u32, b_u32, scalar_absd);
+    ok &= check("absd_i32", absd_i32, a_i32, b_i32, scalar_absd);
+    if (!ok) {
+        return 1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include "Halide.h"
+
+namespace {
+
+using namespace Halide::ConciseCasts;
+
+// Compile the vector ops that the C backend lowers specially (saturating
+// add/sub, widening multiply and absd) to an object and to C code. Each
+// output row y computes the same expression vectorized at lane_counts[y],
+// to cover both the generic vector ops and the intrinsic specializations.
+class VectorOps : public Halide::Generator<VectorOps> {
+public:
+    Input<Buffer<uint8_t>> a_u8{"a_u8", 1};
+    Input<Buffer<uint8_t>> b_u8{"b_u8", 1};
+    Input<Buffer<int8_t>> a_i8{"a_i8", 1};
+    Input<Buffer<int8_t>> b_i8{"b_i8", 1};
+    Input<Buffer<uint16_t>> a_u16{"a_u16", 1};
+    Input<Buffer<uint16_t>> b_u16{"b_u16", 1};
+    Input<Buffer<int16_t>> a_i16{"a_i16", 1};
+    Input<Buffer<int16_t>> b_i16{"b_i16", 1};
+    Input<Buffer<uint32_t>> a_u32{"a_u32", 1};
+    Input<Buffer<uint32_t>> b_u32{"b_u32", 1};
+    Input<Buffer<int32_t>> a_i32{"a_i32", 1};
+    Input<Buffer<int32_t>> b_i32{"b_i32", 1};
+
+    Output<Buffer<uint8_t>> saturating_add_u8{"saturating_add_u8", 2};
+    Output<Buffer<uint8_t>> saturating_sub_u8{"saturating_sub_u8", 2};
+    Output<Buffer<uint16_t>> widening_mul_u8{"widening_mul_u8", 2};
+    Output<Buffer<uint8_t>> absd_u8{"absd_u8", 2};
+
+    Output<Buffer<int8_t>> saturating_add_i8{"saturating_add_i8", 2};
+    Output<Buffer<int8_t>> saturating_sub_i8{"saturating_sub_i8", 2};
+    Output<Buffer<int16_t>> widening_mul_i8{"widening_mul_i8", 2};
+    Output<Buffer<uint8_t>> absd_i8{"absd_i8", 2};
+
+    Output<Buffer<uint16_t>> saturating_add_u16{"saturating_add_u16", 2};
+    Output<Buffer<uint16_t>> saturating_sub_u16{"saturating_sub_u16", 2};
+    Output<Buffer<uint32_t>> widening_mul_u16{"widening_mul_u16", 2};
+    Output<Buffer<uint16_t>> absd_u16{"absd_u16", 2};
+
+    Output<Buffer<int16_t>> saturating_add_i16{"saturating_add_i16", 2};
+    Output<Buffer<int16_t>> saturating_sub_i16{"saturating_sub_i16", 2};
+    Output<Buffer<int32_t>> widening_mul_i16{"widening_mul_i16", 2};
+    Output<Buffer<uint16_t>> absd_i16{"absd_i16", 2};
+
+    Output<Buffer<uint32_t>> absd_u32{"absd_u32", 2};
+    Output<Buffer<uint32_t>> absd_i32{"absd_i32", 2};
+
+    void generate() {
+        Expr au8 = a_u8(x), bu8 = b_u8(x);
+        define_at_lane_counts(saturating_add_u8, u8_sat(u16(au8) + u16(bu8)));
+        define_at_lane_counts(saturating_sub_u8, u8(max(i16(au8) - i16(bu8), 0)));
+        define_at_lane_counts(widening_mul_u8, u16(au8) * u16(bu8));
+        define_at_lane_counts(absd_u8, absd(au8, bu8));
+
+        Expr ai8 = a_i8(x), bi8 = b_i8(x);
+        define_at_lane_counts(saturating_add_i8, i8_sat(i16(ai8) + i16(bi8)));
+        define_at_lane_counts(saturating_sub_i8, i8_sat(i16(ai8) - i16(bi8)));
+        define_at_lane_counts(widening_mul_i8, i16(ai8) * i16(bi8));
+        define_at_lane_counts(absd_i8, absd(ai8, bi8));
+
+        Expr au16 = a_u16(x), bu16 = b_u16(x);
+        define_at_lane_counts(saturating_add_u16, u16_sat(u32(au16) + u32(bu16)));
+        define_at_lane_counts(saturating_sub_u16, u16(max(i32(au16) - i32(bu16), 0)));
+        define_at_lane_counts(widening_mul_u16, u32(au16) * u32(bu16));
+        define_at_lane_counts(absd_u16, absd(au16, bu16));
+
+        Expr ai16 = a_i16(x), bi16 = b_i16(x);
+        define_at_lane_counts(saturating_add_i16, i16_sat(i32(ai16) + i32(bi16)));
+        define_at_lane_counts(saturating_sub_i16, i16_sat(i32(ai16) - i32(bi16)));
+        define_at_lane_counts(widening_mul_i16, i32(ai16) * i32(bi16));
+        define_at_lane_counts(absd_i16, absd(ai16, bi16));
+
+        define_at_lane_counts(absd_u32, absd(a_u32(x), b_u32(x)));
+        define_at_lane_counts(absd_i32, absd(a_i32(x), b_i32(x)));
+    }
+
+private:
+    Var x{"x"}, y{"y"};
+
+    template<typename T>
+    void define_at_lane_counts(Output<Buffer<T>> &output, const Expr &e) {
+        // 3 lanes exercises the non-power-of-two fallback, 8 to 32 lanes
+        // cover the SSE2, AVX2 and NEON specializations.
+        const int lane_counts[] = {3, 8, 16, 32};
+        const int n = sizeof(lane_counts) / sizeof(lane_counts[0]);
+
+        Expr result;
+        for (int i = n - 1; i >= 0; i--) {
+            Func f(output.name() + "_" + std::to_string(lane_counts[i]));
+            f(x) = e;
+            f.compute_root().vectorize(x, lane_counts[i]);
+            result = result.defined() ? select(y == i, f(x), result) : f(x);
+        }
+        output(x, y) = result;
+        output.bound(y, 0, n);
+    }
+};
+
+}  // namespace
+
+HALIDE_REGISTER_GENERATOR(VectorOps, vector_ops)
@@ -7,8 +7,10 @@
 #include <cassert>
 #include <cmath>
 #include <cstddef>
+#include <functional>
 #include <limits>
 #include <map>
+#include <mutex>
 #include <ostream>
 #include <string>
 
@@ -476,6 +478,15 @@ std::pair<FuncType, FuncType> tiled_transpose(FuncType f, int max_tile_size,
     return {fT, f_tiledT};
 }
 
+// Choose the number of rows of a batched 1D FFT of size N to compute
+// together. fft_dim1 vectorizes across these rows. Small FFTs are computed in
+// larger blocks, to amortize the transposes into and out of the FFT over more
+// work. Large FFTs use one vector of rows, to keep the block in cache.
+int batch_width(int N, Type t, const Target &target) {
+    const int natural_vector_size = target.natural_vector_size(t);
+    return natural_vector_size * std::max(1, std::min(64 / N, 4));
+}
+
 }  // namespace
 
 ComplexFunc fft2d_c2c(ComplexFunc x,
@@ -1061,10 +1072,288 @@ Func fft2d_c2r(ComplexFunc c,
     return unzipped;
 }
 
+ComplexFunc fft1d_c2c(ComplexFunc x,
+                      const vector<int> &R,
+                      int sign,
+                      const Target &target,
+                      const Fft2dDesc &desc) {
+    string prefix = desc.name.empty() ? "c2c1d_" : desc.name + "_";
+
+    int N = product(R);
+
+    vector<Var> args = x.args();
+    Var n0(args[0]), n1(args[1]);
+    args.erase(args.begin());
+    args.erase(args.begin());
+
+    // The rows are transformed in blocks of this many rows.
+    const int batch = batch_width(N, x.output_types()[0], target);
+
+    // The tiled transposes need whole tiles along the transformed dimension.
+    const bool tile = N % std::min(batch, target.natural_vector_size(x.output_types()[0])) == 0;
+
+    // Cache of twiddle factors for this FFT.
+    TwiddleFactorSet twiddle_cache;
+
+    // transpose the input, so the rows of the batch become columns, which
+    // fft_dim1 transforms vectorized across the batch.
+    ComplexFunc xT, x_tiled;
+    std::tie(xT, x_tiled) = tiled_transpose(x, batch, target, prefix, tile);
+
+    ComplexFunc dftT = fft_dim1(xT,
+                                R,
+                                sign,
+                                batch,  // extent of dim 0
+                                desc.gain,
+                                false,  // We parallelize the blocks below instead.
+                                prefix,
+                                target,
+                                &twiddle_cache);
+
+    // transpose back.
+    ComplexFunc dft, dft_tiled;
+    std::tie(dft, dft_tiled) = tiled_transpose(dftT, batch, target, prefix, tile);
+
+    // Schedule.
+    Var block(n1.name() + "o");
+    dft.split(n1, block, n1, batch, TailStrategy::GuardWithIf)
+        .vectorize(n0, gcd(target.natural_vector_size(dft.output_types()[0]), N));
+    if (desc.parallel) {
+        dft.parallel(block);
+    }
+
+    dftT.compute_at(dft, block);
+    if (dft_tiled.defined()) {
+        dft_tiled.compute_at(dft, block);
+    }
+    if (x_tiled.defined()) {
+        x_tiled.compute_at(dftT, group);
+    }
+
+    // Schedule the input, if requested.
+    if (desc.schedule_input) {
+        x.compute_at(dftT, group);
+    }
+
+    dft.bound(n0, 0, N);
+
+    return dft;
+}
+
+// The batched real FFTs below zip pairs of rows together, as described in the
+// large comment above fft2d_r2c. Because each row is a separate 1D DFT, there
+// is no DC and Nyquist bin row to deal with, so the unzipping is simpler than
+// in the 2D case.
+
+ComplexFunc fft1d_r2c(Func r,
+                      const vector<int> &R,
+                      const Target &target,
+                      const Fft2dDesc &desc) {
+    string prefix = desc.name.empty() ? "r2c1d_" : desc.name + "_";
+
+    int N = product(R);
+
+    vector<Var> args(r.args());
+    Var n0(args[0]), n1(args[1]);
+    args.erase(args.begin());
+    args.erase(args.begin());
+
+    // Combine pairs of real rows x, y into complex rows z = x + j y. This
+    // allows us to compute two real DFTs using one complex FFT.
+    ComplexFunc zipped(prefix + "zipped");
+    zipped(A({n0, n1}, args)) =
+        ComplexExpr(r(A({n0, 2 * n1}, args)),
+                    r(A({n0, 2 * n1 + 1}, args)));
+
+    // Rather than divide the unzipped DFTs below by 2, adjust the gain instead.
+    Fft2dDesc zipped_desc = desc;
+    zipped_desc.name = prefix + "z";
+    zipped_desc.gain = desc.gain / 2;
+    zipped_desc.parallel = false;
+    zipped_desc.schedule_input = false;
+    ComplexFunc Z = fft1d_c2c(zipped, R, -1, target, zipped_desc);
+
+    // Unzip the DFTs with equations (3) and (4). Row 2 m of the result is X,
+    // row 2 m + 1 is Y. Only the bins [0, N / 2] are computed, so the
+    // conjugate symmetric bins N - k are in [N / 2, N) for k > 0, and can be
+    // loaded with dense vectors. The DC bin uses Z_N = Z_0.
+    ComplexFunc unzipped(prefix + "unzipped");
+    unzipped(A({n0, n1}, args)) = undef_z(Z.output_types()[0]);
+    {
+        // Update 0: Unzip the DC bin.
+        ComplexExpr Z0 = Z(A({0, n1 / 2}, args));
+        unzipped(A({0, n1}, args)) =
+            select(n1 % 2 == 0, Z0 + conj(Z0), -j * (Z0 - conj(Z0)));
+    }
+    RDom k(1, N / 2);
+    {
+        // Update 1: Unzip the rest of the bins.
+        ComplexExpr Zk = Z(A({k, n1 / 2}, args));
+        ComplexExpr conjsymZ = conj(Z(A({N - k, n1 / 2}, args)));
+        unzipped(A({k, n1}, args)) =
+            select(n1 % 2 == 0, Zk + conjsymZ, -j * (Zk - conjsymZ));
+    }
+
+    ComplexFunc dft(prefix + "r2c");
+    dft(A({n0, n1}, args)) = unzipped(A({n0, n1}, args));
+
+    // Schedule. Each block of the result covers one block of rows of Z.
+    const int batch = batch_width(N, Z.output_types()[0], target);
+    const int vector_size = target.natural_vector_size(dft.output_types()[0]);
+
+    Var block(n1.name() + "o");
+    dft.split(n1, block, n1, batch * 2, TailStrategy::GuardWithIf)
+        .vectorize(n0, vector_size, TailStrategy::GuardWithIf);
+    if (desc.parallel) {
+        dft.parallel(block);
+    }
+
+    Z.compute_at(dft, block);
+    unzipped.compute_at(dft, block);
+    unzipped.update(1).vectorize(k, vector_size);
+
+    // Schedule the input, if requested.
+    if (desc.schedule_input) {
+        r.compute_at(dft, block);
+    }
+
+    // Our result is undefined outside these bounds.
+    dft.bound(n0, 0, N / 2 + 1);
+
+    return dft;
+}
+
+Func fft1d_c2r(ComplexFunc c,
+               const vector<int> &R,
+               const Target &target,
+               const Fft2dDesc &desc) {
+    string prefix = desc.name.empty() ? "c2r1d_" : desc.name + "_";
+
+    int N = product(R);
+
+    vector<Var> args = c.args();
+    Var n0(args[0]), n1(args[1]);
+    args.erase(args.begin());
+    args.erase(args.begin());
+
+    // Add a boundary condition to prevent the conjugate symmetric loads below
+    // from reaching out of the bins we promise to define in forward FFTs.
+    c = ComplexFunc(repeat_edge((Func)c, {{Expr(0), Expr(N / 2 + 1)}, {Expr(), Expr()}}));
+
+    // Reconstruct the whole DFT domain of pairs of rows X, Y via conjugate
+    // symmetry, and zip them into one complex DFT Z = X + j Y. The inverse DFT
+    // of Z is then x + j y.
+    ComplexFunc zipped(prefix + "zipped");
+    {
+        Expr n0_sym = N - n0;
+        ComplexExpr X = select(n0 <= N / 2,
+                               c(A({n0, 2 * n1}, args)),
+                               conj(c(A({n0_sym, 2 * n1}, args))));
+        ComplexExpr Y = select(n0 <= N / 2,
+                               c(A({n0, 2 * n1 + 1}, args)),
+                               conj(c(A({n0_sym, 2 * n1 + 1}, args))));
+        zipped(A({n0, n1}, args)) = X + j * Y;
+    }
+
+    Fft2dDesc zipped_desc = desc;
+    zipped_desc.name = prefix + "z";
+    zipped_desc.parallel = false;
+    zipped_desc.schedule_input = false;
+    ComplexFunc z = fft1d_c2c(zipped, R, 1, target, zipped_desc);
+
+    // Extract the real inverse DFTs.
+    Func unzipped(prefix + "c2r");
+    unzipped(A({n0, n1}, args)) =
+        select(n1 % 2 == 0,
+               re(z(A({n0, n1 / 2}, args))),
+               im(z(A({n0, n1 / 2}, args))));
+
+    // Schedule. Each block of the result covers one block of rows of z.
+    const int batch = batch_width(N, z.output_types()[0], target);
+
+    Var block(n1.name() + "o");
+    unzipped.split(n1, block, n1, batch * 2, TailStrategy::GuardWithIf)
+        .vectorize(n0, gcd(target.natural_vector_size<float>(), N));
+    if (desc.parallel) {
+        unzipped.parallel(block);
+    }
+
+    z.compute_at(unzipped, block);
+
+    // Schedule the input, if requested.
+    if (desc.schedule_input) {
+        c.compute_at(unzipped, block);
+    }
+
+    unzipped.bound(n0, 0, N);
+
+    return unzipped;
+}
+
 namespace {
 
-// Compute a factorization of N suitable for use in the FFT.
+// The approximate cost of one pass of radix R of the FFT, in real floating
+// point operations per point, not including the twiddle factors.
+float radix_cost(int R) {
+    switch (R) {
+    case 2:
+        return 2.0f;
+    case 4:
+        return 4.0f;
+    case 6:
+        return 16.0f;
+    case 8:
+        return 7.5f;
+    default:
+        // dftN computes the DFT directly.
+        return 8.0f * (R - 1);
+    }
+}
+
+// The cost of the memory traffic of one pass of the FFT, and of applying the
+// twiddle factors between passes, in the same units as radix_cost.
+const float pass_cost = 8.0f;
+const float twiddle_cost = 6.0f;
+
+// Find the cheapest factorization of N according to the costs above.
+float plan_radices(int N, vector<int> &R, std::map<int, std::pair<float, vector<int>>> &memo) {
+    auto i = memo.find(N);
+    if (i != memo.end()) {
+        R = i->second.second;
+        return i->second.first;
+    }
+
+    float best_cost = std::numeric_limits<float>::infinity();
+    vector<int> best;
+    for (int r = 2; r <= N; r++) {
+        if (N % r != 0) {
+            continue;
+        }
+        vector<int> rest;
+        float cost = radix_cost(r) + pass_cost;
+        if (N / r > 1) {
+            cost += plan_radices(N / r, rest, memo) + twiddle_cost;
+        }
+        if (cost < best_cost) {
+            best_cost = cost;
+            best = rest;
+            best.push_back(r);
+        }
+    }
+
+    // Compute the large radices first.
+    std::sort(best.begin(), best.end(), std::greater<int>());
+
+    memo[N] = {best_cost, best};
+    R = best;
+    return best_cost;
+}
+
+// Compute a factorization of N suitable for use in the FFT. Plans are
+// remembered, because the search is repeated for every FFT of the same size.
 vector<int> radix_factor(int N) {
+    _halide_user_assert(N > 1) << "FFT size must be greater than 1, not " << N << "\n";
+
     // Some special cases to optimize.
     switch (N) {
     case 16:
@@ -1079,21 +1368,15 @@ vector<int> radix_factor(int N) {
         return {8, 8, 4};
     }
 
-    // Factor N into factors found in the 'radices' set.
-    static const int radices[] = {8, 6, 4, 2};
-    vector<int> R;
-    for (int r : radices) {
-        while (N % r == 0) {
-            R.push_back(r);
-            N /= r;
-        }
-    }
+    static std::mutex plans_lock;
+    static std::map<int, vector<int>> plans;
 
-    // If there are still factors left over, just include them as a radix.
-    if (N != 1 || R.empty()) {
-        R.push_back(N);
+    std::lock_guard<std::mutex> lock(plans_lock);
+    vector<int> &R = plans[N];
+    if (R.empty()) {
+        std::map<int, std::pair<float, vector<int>>> memo;
+        plan_radices(N, R, memo);
     }
-
     return R;
 }
 
@@ -1120,3 +1403,25 @@ Func fft2d_c2r(ComplexFunc c,
                const Fft2dDesc &desc) {
     return fft2d_c2r(c, radix_factor(N0), radix_factor(N1), target, desc);
 }
+
+ComplexFunc fft1d_c2c(ComplexFunc x,
+                      int N,
+                      int sign,
+                      const Target &target,
+                      const Fft2dDesc &desc) {
+    return fft1d_c2c(x, radix_factor(N), sign, target, desc);
+}
+
+ComplexFunc fft1d_r2c(Func r,
+                      int N,
+                      const Target &target,
+                      const Fft2dDesc &desc) {
+    return fft1d_r2c(r, radix_factor(N), target, desc);
+}
+
+Func fft1d_c2r(ComplexFunc c,
+               int N,
+               const Target &target,
+               const Fft2dDesc &desc) {
+    return fft1d_c2r(c, radix_factor(N), target, desc);
+}
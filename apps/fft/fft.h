@@ -66,4 +66,33 @@ Halide::Func fft2d_c2r(ComplexFunc c, int N0, int N1,
                        const Halide::Target &target,
                        const Fft2dDesc &desc = Fft2dDesc());
 
+// Compute the N point complex DFT of dimension 0 of x, for every row (dimension
+// 1) of x. Dimension 0 of x should be defined on at least [0, N). Rows are
+// transformed in blocks, so x may be evaluated on rows past the last row of
+// the requested region, up to the end of the block containing it. sign = -1
+// indicates a forward FFT, sign = 1 indicates an inverse FFT. There is no
+// normalization of the FFT in either direction.
+ComplexFunc fft1d_c2c(ComplexFunc x, int N, int sign,
+                      const Halide::Target &target,
+                      const Fft2dDesc &desc = Fft2dDesc());
+
+// Compute the N point complex DFT of dimension 0 of a real valued function r,
+// for every row (dimension 1) of r. Note that the transform domain has
+// dimensions N / 2 + 1 x rows due to the conjugate symmetry of real DFTs. Rows
+// are transformed in pairs, so r may be evaluated on one row past the requested
+// region, and on rows past the end of the block containing it as for
+// fft1d_c2c. There is no normalization.
+ComplexFunc fft1d_r2c(Halide::Func r, int N,
+                      const Halide::Target &target,
+                      const Fft2dDesc &desc = Fft2dDesc());
+
+// Compute the real valued N point inverse DFT of dimension 0 of c, for every
+// row (dimension 1) of c. Note that the transform domain has dimensions
+// N / 2 + 1 x rows due to the conjugate symmetry of real DFTs. The same
+// remarks about the rows evaluated apply as for fft1d_r2c. There is no
+// normalization.
+Halide::Func fft1d_c2r(ComplexFunc c, int N,
+                       const Halide::Target &target,
+                       const Fft2dDesc &desc = Fft2dDesc());
+
 #endif
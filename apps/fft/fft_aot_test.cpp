@@ -1,15 +1,26 @@
 #include <cmath>
+#include <complex>
 #include <cstdlib>
 #include <iomanip>
 #include <iostream>
 #include <string.h>
+#include <vector>
 
 #include "HalideBuffer.h"
 
 #include "fft_forward_c2c.h"
 #include "fft_forward_r2c.h"
+#include "fft_forward_c2c_1d_16.h"
+#include "fft_forward_c2c_1d_24.h"
+#include "fft_forward_c2c_1d_60.h"
+#include "fft_forward_r2c_1d_16.h"
+#include "fft_forward_r2c_1d_24.h"
+#include "fft_forward_r2c_1d_60.h"
 #include "fft_inverse_c2c.h"
 #include "fft_inverse_c2r.h"
+#include "fft_inverse_c2r_1d_16.h"
+#include "fft_inverse_c2r_1d_24.h"
+#include "fft_inverse_c2r_1d_60.h"
 
 namespace {
 const float kPi = 3.14159265358979310000f;
@@ -43,6 +54,145 @@ float im(const Buffer<float, 3> &b, int x, int y) {
     return b(x, y, 1);
 }
 
+// The unnormalized batched 1D FFTs of one size.
+struct Fft1d {
+    int size;
+    int (*forward_c2c)(halide_buffer_t *input, halide_buffer_t *output);
+    int (*forward_r2c)(halide_buffer_t *input, halide_buffer_t *output);
+    int (*inverse_c2r)(halide_buffer_t *input, halide_buffer_t *output);
+};
+
+const Fft1d kFft1d[] = {
+    {16, fft_forward_c2c_1d_16, fft_forward_r2c_1d_16, fft_inverse_c2r_1d_16},
+    {24, fft_forward_c2c_1d_24, fft_forward_r2c_1d_24, fft_inverse_c2r_1d_24},
+    {60, fft_forward_c2c_1d_60, fft_forward_r2c_1d_60, fft_inverse_c2r_1d_60},
+};
+
+typedef std::complex<double> Complex;
+
+// Compute the unnormalized DFT of x directly.
+std::vector<Complex> reference_dft(const std::vector<Complex> &x, int sign) {
+    const int n = (int)x.size();
+    std::vector<Complex> result(n);
+    for (int k = 0; k < n; k++) {
+        for (int i = 0; i < n; i++) {
+            // Reduce the index first to keep the angle accurate.
+            double angle = sign * 2 * kPi * ((i * k) % n) / (double)n;
+            result[k] += x[i] * Complex(cos(angle), sin(angle));
+        }
+    }
+    return result;
+}
+
+float random_sample() {
+    return (rand() % 2001 - 1000) / 1000.0f;
+}
+
+// The error allowed in a transform of size n of samples in [-1, 1].
+float tolerance(int n) {
+    return 1e-4f * n;
+}
+
+bool check_bin(const char *name, int size, int rows, int x, int y,
+               float re_actual, float im_actual, Complex expected) {
+    if (fabs(re_actual - expected.real()) > tolerance(size) ||
+        fabs(im_actual - expected.imag()) > tolerance(size)) {
+        std::cerr << name << " of size " << size << " with " << rows << " rows mismatch at (" << x << ", " << y << ") "
+                  << re_actual << " + " << im_actual << "j vs. " << expected.real() << " + " << expected.imag() << "j\n";
+        return false;
+    }
+    return true;
+}
+
+bool test_fft1d_c2c(const Fft1d &fft, int rows) {
+    const int n = fft.size;
+    auto in = Buffer<float, 3>::make_interleaved(n, rows, 2);
+    in.for_each_value([](float &v) { v = random_sample(); });
+    auto out = Buffer<float, 3>::make_interleaved(n, rows, 2);
+
+    int halide_result = fft.forward_c2c(in, out);
+    if (halide_result != 0) {
+        std::cerr << "fft_forward_c2c_1d_" << n << " failed returning " << halide_result << "\n";
+        return false;
+    }
+
+    for (int y = 0; y < rows; y++) {
+        std::vector<Complex> x(n);
+        for (int i = 0; i < n; i++) {
+            x[i] = Complex(re(in, i, y), im(in, i, y));
+        }
+        std::vector<Complex> expected = reference_dft(x, -1);
+        for (int k = 0; k < n; k++) {
+            if (!check_bin("fft_forward_c2c_1d", n, rows, k, y, re(out, k, y), im(out, k, y), expected[k])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool test_fft1d_r2c(const Fft1d &fft, int rows) {
+    const int n = fft.size;
+    auto in = Buffer<float, 3>::make_interleaved(n, rows, 1);
+    in.for_each_value([](float &v) { v = random_sample(); });
+    auto out = Buffer<float, 3>::make_interleaved(n / 2 + 1, rows, 2);
+
+    int halide_result = fft.forward_r2c(in, out);
+    if (halide_result != 0) {
+        std::cerr << "fft_forward_r2c_1d_" << n << " failed returning " << halide_result << "\n";
+        return false;
+    }
+
+    for (int y = 0; y < rows; y++) {
+        std::vector<Complex> x(n);
+        for (int i = 0; i < n; i++) {
+            x[i] = in(i, y, 0);
+        }
+        std::vector<Complex> expected = reference_dft(x, -1);
+        for (int k = 0; k <= n / 2; k++) {
+            if (!check_bin("fft_forward_r2c_1d", n, rows, k, y, re(out, k, y), im(out, k, y), expected[k])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool test_fft1d_c2r(const Fft1d &fft, int rows) {
+    const int n = fft.size;
+    // The input is the DFT of random real rows, which is conjugate symmetric.
+    std::vector<std::vector<Complex>> samples(rows);
+    auto in = Buffer<float, 3>::make_interleaved(n / 2 + 1, rows, 2);
+    for (int y = 0; y < rows; y++) {
+        samples[y].resize(n);
+        for (int i = 0; i < n; i++) {
+            samples[y][i] = random_sample();
+        }
+        std::vector<Complex> dft = reference_dft(samples[y], -1);
+        for (int k = 0; k <= n / 2; k++) {
+            re(in, k, y) = dft[k].real();
+            im(in, k, y) = dft[k].imag();
+        }
+    }
+    auto out = Buffer<float, 3>::make_interleaved(n, rows, 1);
+
+    int halide_result = fft.inverse_c2r(in, out);
+    if (halide_result != 0) {
+        std::cerr << "fft_inverse_c2r_1d_" << n << " failed returning " << halide_result << "\n";
+        return false;
+    }
+
+    for (int y = 0; y < rows; y++) {
+        for (int i = 0; i < n; i++) {
+            // The inverse is unnormalized, so it scales the samples by n.
+            if (!check_bin("fft_inverse_c2r_1d", n, rows, i, y, out(i, y, 0), 0, samples[y][i] * (double)n)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 int main(int argc, char **argv) {
     std::cout << std::fixed << std::setprecision(2);
 
@@ -292,6 +442,16 @@ int main(int argc, char **argv) {
         }
     }
 
+    // Batched 1D tests, against a DFT computed directly.
+    for (const Fft1d &fft : kFft1d) {
+        for (int rows : {1, 2, 9, 100}) {
+            std::cout << "Batched 1D tests of size " << fft.size << " with " << rows << " rows.\n";
+            if (!test_fft1d_c2c(fft, rows) || !test_fft1d_r2c(fft, rows) || !test_fft1d_c2r(fft, rows)) {
+                exit(1);
+            }
+        }
+    }
+
     std::cout << "Success!\n";
     exit(0);
 }
@@ -65,7 +65,8 @@ public:
 
     // Size of first dimension, required to be greater than zero.
     GeneratorParam<int32_t> size0{"size0", 1};
-    // Size of second dimension, may be zero for 1D FFT.
+    // Size of second dimension, may be zero for 1D FFT. In that case, the 1D
+    // FFT of size size0 is computed for every row of the input.
     GeneratorParam<int32_t> size1{"size1", 0};
     // TODO(zalman): Add support for 3D and maybe 4D FFTs
 
@@ -81,6 +82,8 @@ public:
     // Dim0: extent = size0, stride = 2
     // Dim1: extent = size1, stride = size0 * 2
     // Dim2: extent = 2, stride = 1 (real followed by imaginary components)
+    //
+    // For a 1D FFT, dim1 is the rows to transform, and may have any extent.
     Input<Buffer<float>> input{"input", 3};
     Output<Buffer<float>> output{"output", 3};
 
@@ -100,27 +103,49 @@ public:
 
         const int sign = (direction == FFTDirection::SamplesToFrequency) ? -1 : 1;
 
+        // The batched 1D FFTs transform the rows in blocks, and may read rows
+        // past the end of the input, so clamp the row index.
+        const bool batched_1d = (size1 == 0);
+        Expr row = y;
+        if (batched_1d) {
+            row = clamp(y, input.dim(1).min(), input.dim(1).max());
+        }
+
         if (input_number_type == FFTNumberType::Real) {
             if (direction == FFTDirection::SamplesToFrequency) {
                 // TODO: Not sure why this is necessary as ImageParam
                 // -> Func conversion should happen, It may not work
                 // with implicit dimension (use of _) logic in FFT.
                 Func in;
-                in(x, y) = input(x, y, 0);
+                in(x, y) = input(x, row, 0);
 
-                complex_result = fft2d_r2c(in, size0, size1, target, desc);
+                if (batched_1d) {
+                    complex_result = fft1d_r2c(in, size0, target, desc);
+                } else {
+                    complex_result = fft2d_r2c(in, size0, size1, target, desc);
+                }
             } else {
                 ComplexFunc in;
-                in(x, y) = ComplexExpr(input(x, y, 0), 0);
+                in(x, y) = ComplexExpr(input(x, row, 0), 0);
 
-                complex_result = fft2d_c2c(in, size0, size1, sign, target, desc);
+                if (batched_1d) {
+                    complex_result = fft1d_c2c(in, size0, sign, target, desc);
+                } else {
+                    complex_result = fft2d_c2c(in, size0, size1, sign, target, desc);
+                }
             }
         } else {
             ComplexFunc in;
-            in(x, y) = ComplexExpr(input(x, y, 0), input(x, y, 1));
+            in(x, y) = ComplexExpr(input(x, row, 0), input(x, row, 1));
             if (output_number_type == FFTNumberType::Real &&
                 direction == FFTDirection::FrequencyToSamples) {
-                real_result = fft2d_c2r(in, size0, size1, target, desc);
+                if (batched_1d) {
+                    real_result = fft1d_c2r(in, size0, target, desc);
+                } else {
+                    real_result = fft2d_c2r(in, size0, size1, target, desc);
+                }
+            } else if (batched_1d) {
+                complex_result = fft1d_c2c(in, size0, sign, target, desc);
             } else {
                 complex_result = fft2d_c2c(in, size0, size1, sign, target, desc);
             }
@@ -130,6 +130,49 @@ int main(int argc, char **argv) {
         }
     }
 
+    // Check the batched 1D FFTs by transforming each row of the input and
+    // back again. The batched FFTs may read rows past the end of the input.
+    Func in_rows = BoundaryConditions::repeat_edge(in);
+
+    Fft2dDesc inv_1d_desc;
+    inv_1d_desc.gain = 1.0f / W;
+
+    Func roundtrip_c2c;
+    {
+        ComplexFunc in_complex;
+        in_complex(x, y) = ComplexExpr(in_rows(x, y), 0.0f);
+        ComplexFunc dft = fft1d_c2c(in_complex, W, -1, target, fwd_desc);
+        dft.compute_root();
+        ComplexFunc idft = fft1d_c2c(dft, W, 1, target, inv_1d_desc);
+        idft.compute_root();
+        roundtrip_c2c(x, y) = re(idft(x, y));
+    }
+
+    Func roundtrip_r2c;
+    {
+        Func in_real;
+        in_real(x, y) = in_rows(x, y);
+        ComplexFunc dft = fft1d_r2c(in_real, W, target, fwd_desc);
+        dft.compute_root();
+        roundtrip_r2c = fft1d_c2r(dft, W, target, inv_1d_desc);
+    }
+
+    Buffer<float> result_1d_c2c = roundtrip_c2c.realize(W, H, target);
+    Buffer<float> result_1d_r2c = roundtrip_r2c.realize(W, H, target);
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            if (fabs(result_1d_c2c(x, y) - in(x, y)) > 1e-5f) {
+                printf("result_1d_c2c(%d, %d) = %f instead of %f\n", x, y, result_1d_c2c(x, y), in(x, y));
+                return -1;
+            }
+            if (fabs(result_1d_r2c(x, y) - in(x, y)) > 1e-5f) {
+                printf("result_1d_r2c(%d, %d) = %f instead of %f\n", x, y, result_1d_r2c(x, y), in(x, y));
+                return -1;
+            }
+        }
+    }
+
     // For a description of the methodology used here, see
     // http://www.fftw.org/speed/method.html
 
@@ -230,10 +273,100 @@ int main(int argc, char **argv) {
            2.5 * W * H * (log2(W) + log2(H)) / fftw_t,
            fftw_t / halide_t);
 
+    // Batched 1D FFTs of the H rows of size W, to compare with the 2D FFTs
+    // above. The batched FFTs may read rows past the end of the input.
+    Expr row = clamp(y, 0, H - 1);
+
+    ComplexFunc c2c_1d_in;
+    // All reps read from the same input. See notes on c2c_in.
+    c2c_1d_in(x, y, rep) = {re_in(x, row), im_in(x, row)};
+    Func bench_c2c_1d = fft1d_c2c(c2c_1d_in, W, -1, target, fwd_desc);
+    bench_c2c_1d.compile_to_lowered_stmt(output_dir + "c2c_1d.html", bench_c2c_1d.infer_arguments(), HTML);
+    Realization R_c2c_1d = bench_c2c_1d.realize(W, H, reps, target);
+    // Write all reps to the same place in memory. See notes on R_c2c.
+    R_c2c_1d[0].raw_buffer()->dim[2].stride = 0;
+    R_c2c_1d[1].raw_buffer()->dim[2].stride = 0;
+
+    halide_t = benchmark(samples, 1, [&]() { bench_c2c_1d.realize(R_c2c_1d); }) * 1e6 / reps;
+#ifdef WITH_FFTW
+    fftwf_plan c2c_1d_plan = fftwf_plan_many_dft(1, &W, H,
+                                                 (fftwf_complex *)&fftw_c1[0], nullptr, 1, W,
+                                                 (fftwf_complex *)&fftw_c2[0], nullptr, 1, W,
+                                                 FFTW_FORWARD, FFTW_EXHAUSTIVE);
+    fftw_t = benchmark(samples, reps, [&]() { fftwf_execute(c2c_1d_plan); }) * 1e6;
+#else
+    fftw_t = 0;
+#endif
+    printf("%12s %10.3f %10.2f %10.3f %10.2f %10.3g\n",
+           "c2c 1d",
+           halide_t,
+           5 * W * H * log2(W) / halide_t,
+           fftw_t,
+           5 * W * H * log2(W) / fftw_t,
+           fftw_t / halide_t);
+
+    Func r2c_1d_in;
+    // All reps read from the same input. See notes on c2c_in.
+    r2c_1d_in(x, y, rep) = re_in(x, row);
+    Func bench_r2c_1d = fft1d_r2c(r2c_1d_in, W, target, fwd_desc);
+    bench_r2c_1d.compile_to_lowered_stmt(output_dir + "r2c_1d.html", bench_r2c_1d.infer_arguments(), HTML);
+    Realization R_r2c_1d = bench_r2c_1d.realize(W / 2 + 1, H, reps, target);
+    // Write all reps to the same place in memory. See notes on R_c2c.
+    R_r2c_1d[0].raw_buffer()->dim[2].stride = 0;
+    R_r2c_1d[1].raw_buffer()->dim[2].stride = 0;
+
+    halide_t = benchmark(samples, 1, [&]() { bench_r2c_1d.realize(R_r2c_1d); }) * 1e6 / reps;
+#ifdef WITH_FFTW
+    fftwf_plan r2c_1d_plan = fftwf_plan_many_dft_r2c(1, &W, H,
+                                                     &fftw_r[0], nullptr, 1, W,
+                                                     (fftwf_complex *)&fftw_c1[0], nullptr, 1, W / 2 + 1,
+                                                     FFTW_EXHAUSTIVE);
+    fftw_t = benchmark(samples, reps, [&]() { fftwf_execute(r2c_1d_plan); }) * 1e6;
+#else
+    fftw_t = 0;
+#endif
+    printf("%12s %10.3f %10.2f %10.3f %10.2f %10.3g\n",
+           "r2c 1d",
+           halide_t,
+           2.5 * W * H * log2(W) / halide_t,
+           fftw_t,
+           2.5 * W * H * log2(W) / fftw_t,
+           fftw_t / halide_t);
+
+    ComplexFunc c2r_1d_in;
+    // All reps read from the same input. See notes on c2c_in.
+    c2r_1d_in(x, y, rep) = {re_in(x, row), im_in(x, row)};
+    Func bench_c2r_1d = fft1d_c2r(c2r_1d_in, W, target, inv_1d_desc);
+    bench_c2r_1d.compile_to_lowered_stmt(output_dir + "c2r_1d.html", bench_c2r_1d.infer_arguments(), HTML);
+    Realization R_c2r_1d = bench_c2r_1d.realize(W, H, reps, target);
+    // Write all reps to the same place in memory. See notes on R_c2c.
+    R_c2r_1d[0].raw_buffer()->dim[2].stride = 0;
+
+    halide_t = benchmark(samples, 1, [&]() { bench_c2r_1d.realize(R_c2r_1d); }) * 1e6 / reps;
+#ifdef WITH_FFTW
+    fftwf_plan c2r_1d_plan = fftwf_plan_many_dft_c2r(1, &W, H,
+                                                     (fftwf_complex *)&fftw_c1[0], nullptr, 1, W / 2 + 1,
+                                                     &fftw_r[0], nullptr, 1, W,
+                                                     FFTW_EXHAUSTIVE);
+    fftw_t = benchmark(samples, reps, [&]() { fftwf_execute(c2r_1d_plan); }) * 1e6;
+#else
+    fftw_t = 0;
+#endif
+    printf("%12s %10.3f %10.2f %10.3f %10.2f %10.3g\n",
+           "c2r 1d",
+           halide_t,
+           2.5 * W * H * log2(W) / halide_t,
+           fftw_t,
+           2.5 * W * H * log2(W) / fftw_t,
+           fftw_t / halide_t);
+
 #ifdef WITH_FFTW
     fftwf_destroy_plan(c2c_plan);
     fftwf_destroy_plan(r2c_plan);
     fftwf_destroy_plan(c2r_plan);
+    fftwf_destroy_plan(c2c_1d_plan);
+    fftwf_destroy_plan(r2c_1d_plan);
+    fftwf_destroy_plan(c2r_1d_plan);
 #endif
 
     return 0;
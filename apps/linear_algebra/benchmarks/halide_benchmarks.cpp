@@ -8,6 +8,10 @@
 //    L1: scal, copy, axpy, dot, nrm2
 //    L2: gemv_notrans, gemv_trans
 //    L3: gemm_notrans, gemm_trans_A, gemm_trans_B, gemm_trans_AB
+//    Batched: gemv_batch, gemm_batch, gemv_batch_loop, gemm_batch_loop
+//
+// The batched subroutines run many size x size problems per call. The
+// _loop variants make one call per problem instead, for comparison.
 //
 
 #include "HalideBuffer.h"
@@ -24,6 +28,7 @@ struct BenchmarksBase {
     typedef T Scalar;
     typedef Halide::Runtime::Buffer<T> Vector;
     typedef Halide::Runtime::Buffer<T> Matrix;
+    typedef Halide::Runtime::Buffer<T> Batch;
 
     std::random_device rand_dev;
     std::default_random_engine rand_eng{rand_dev()};
@@ -53,6 +58,24 @@ struct BenchmarksBase {
         return buff;
     }
 
+    Batch random_vector_batch(int N, int count) {
+        Batch buff(N, count);
+        Scalar *x = (Scalar *)buff.data();
+        for (int i = 0; i < N * count; ++i) {
+            x[i] = random_scalar();
+        }
+        return buff;
+    }
+
+    Batch random_matrix_batch(int N, int count) {
+        Batch buff(N, N, count);
+        Scalar *A = (Scalar *)buff.data();
+        for (int i = 0; i < N * N * count; ++i) {
+            A[i] = random_scalar();
+        }
+        return buff;
+    }
+
     BenchmarksBase(std::string n)
         : name(n) {
     }
@@ -82,6 +105,14 @@ struct BenchmarksBase {
             bench_gemm_transB(size);
         } else if (benchmark == "gemm_transAB") {
             bench_gemm_transAB(size);
+        } else if (benchmark == "gemv_batch") {
+            bench_gemv_batch(size);
+        } else if (benchmark == "gemv_batch_loop") {
+            bench_gemv_batch_loop(size);
+        } else if (benchmark == "gemm_batch") {
+            bench_gemm_batch(size);
+        } else if (benchmark == "gemm_batch_loop") {
+            bench_gemm_batch_loop(size);
         }
     }
 
@@ -97,6 +128,10 @@ struct BenchmarksBase {
     virtual void bench_gemm_transA(int N) = 0;
     virtual void bench_gemm_transB(int N) = 0;
     virtual void bench_gemm_transAB(int N) = 0;
+    virtual void bench_gemv_batch(int N) = 0;
+    virtual void bench_gemv_batch_loop(int N) = 0;
+    virtual void bench_gemm_batch(int N) = 0;
+    virtual void bench_gemm_batch_loop(int N) = 0;
 };
 
 struct BenchmarksFloat : public BenchmarksBase<float> {
@@ -126,6 +161,26 @@ struct BenchmarksFloat : public BenchmarksBase<float> {
     L3Benchmark(gemm_transB, "s", halide_sgemm(false, true, alpha, A.raw_buffer(), B.raw_buffer(), beta, C.raw_buffer()));
 
     L3Benchmark(gemm_transAB, "s", halide_sgemm(true, true, alpha, A.raw_buffer(), B.raw_buffer(), beta, C.raw_buffer()));
+
+    L2BatchBenchmark(gemv_batch, "s", halide_sgemv_batch(false, alpha, A.raw_buffer(), x.raw_buffer(), beta, y.raw_buffer()));
+
+    void sgemv_loop(Scalar alpha, Batch &A, Batch &x, Scalar beta, Batch &y) {
+        for (int i = 0; i < A.dim(2).extent(); i++) {
+            halide_sgemv(false, alpha, A.sliced(2, i).raw_buffer(), x.sliced(1, i).raw_buffer(), beta, y.sliced(1, i).raw_buffer());
+        }
+    }
+
+    L2BatchBenchmark(gemv_batch_loop, "s", sgemv_loop(alpha, A, x, beta, y));
+
+    L3BatchBenchmark(gemm_batch, "s", halide_sgemm_batch(false, false, alpha, A.raw_buffer(), B.raw_buffer(), beta, C.raw_buffer()));
+
+    void sgemm_loop(Scalar alpha, Batch &A, Batch &B, Scalar beta, Batch &C) {
+        for (int i = 0; i < A.dim(2).extent(); i++) {
+            halide_sgemm(false, false, alpha, A.sliced(2, i).raw_buffer(), B.sliced(2, i).raw_buffer(), beta, C.sliced(2, i).raw_buffer());
+        }
+    }
+
+    L3BatchBenchmark(gemm_batch_loop, "s", sgemm_loop(alpha, A, B, beta, C));
 };
 
 struct BenchmarksDouble : public BenchmarksBase<double> {
@@ -155,6 +210,26 @@ struct BenchmarksDouble : public BenchmarksBase<double> {
     L3Benchmark(gemm_transB, "d", halide_dgemm(false, true, alpha, A.raw_buffer(), B.raw_buffer(), beta, C.raw_buffer()));
 
     L3Benchmark(gemm_transAB, "d", halide_dgemm(true, true, alpha, A.raw_buffer(), B.raw_buffer(), beta, C.raw_buffer()));
+
+    L2BatchBenchmark(gemv_batch, "d", halide_dgemv_batch(false, alpha, A.raw_buffer(), x.raw_buffer(), beta, y.raw_buffer()));
+
+    void dgemv_loop(Scalar alpha, Batch &A, Batch &x, Scalar beta, Batch &y) {
+        for (int i = 0; i < A.dim(2).extent(); i++) {
+            halide_dgemv(false, alpha, A.sliced(2, i).raw_buffer(), x.sliced(1, i).raw_buffer(), beta, y.sliced(1, i).raw_buffer());
+        }
+    }
+
+    L2BatchBenchmark(gemv_batch_loop, "d", dgemv_loop(alpha, A, x, beta, y));
+
+    L3BatchBenchmark(gemm_batch, "d", halide_dgemm_batch(false, false, alpha, A.raw_buffer(), B.raw_buffer(), beta, C.raw_buffer()));
+
+    void dgemm_loop(Scalar alpha, Batch &A, Batch &B, Scalar beta, Batch &C) {
+        for (int i = 0; i < A.dim(2).extent(); i++) {
+            halide_dgemm(false, false, alpha, A.sliced(2, i).raw_buffer(), B.sliced(2, i).raw_buffer(), beta, C.sliced(2, i).raw_buffer());
+        }
+    }
+
+    L3BatchBenchmark(gemm_batch_loop, "d", dgemm_loop(alpha, A, B, beta, C));
 };
 
 int main(int argc, char *argv[]) {
@@ -121,3 +121,43 @@ inline void set_math_flags() {
             << std::setw(20) << L3GFLOPS(N)             \
             << "\n";                                    \
     }
+
+// The batched benchmarks run BATCH_COUNT problems of size N per call.
+#define BATCH_COUNT 1024
+#define L2BatchBenchmark(benchmark, type, code)                       \
+    virtual void bench_##benchmark(int N) override {                  \
+        Scalar alpha = random_scalar();                               \
+        Scalar beta = random_scalar();                                \
+        Batch x(random_vector_batch(N, BATCH_COUNT));                 \
+        Batch y(random_vector_batch(N, BATCH_COUNT));                 \
+        Batch A(random_matrix_batch(N, BATCH_COUNT));                 \
+                                                                      \
+        time_it(code)                                                 \
+                                                                      \
+                std::cout                                             \
+            << std::setw(8) << name                                   \
+            << std::setw(15) << type << #benchmark                    \
+            << std::setw(8) << std::to_string(N)                      \
+            << std::setw(20) << std::to_string(elapsed)               \
+            << std::setw(20) << BATCH_COUNT * L2GFLOPS(N)             \
+            << "\n";                                                  \
+    }
+
+#define L3BatchBenchmark(benchmark, type, code)                       \
+    virtual void bench_##benchmark(int N) override {                  \
+        Scalar alpha = random_scalar();                               \
+        Scalar beta = random_scalar();                                \
+        Batch A(random_matrix_batch(N, BATCH_COUNT));                 \
+        Batch B(random_matrix_batch(N, BATCH_COUNT));                 \
+        Batch C(random_matrix_batch(N, BATCH_COUNT));                 \
+                                                                      \
+        time_it(code)                                                 \
+                                                                      \
+                std::cout                                             \
+            << std::setw(8) << name                                   \
+            << std::setw(15) << type << #benchmark                    \
+            << std::setw(8) << std::to_string(N)                      \
+            << std::setw(20) << std::to_string(elapsed)               \
+            << std::setw(20) << BATCH_COUNT * L3GFLOPS(N)             \
+            << "\n";                                                  \
+    }
@@ -242,9 +242,87 @@ public:
     }
 };
 
+// Generator class for batched gemv operations on many small matrices. The
+// matrices are the slices of a three dimensional buffer, and the vectors
+// the columns of two dimensional buffers. Each product is computed in one
+// pass, and the batch is split into blocks that run in parallel.
+template<class T>
+class BatchedGEMVGenerator : public Generator<BatchedGEMVGenerator<T>> {
+public:
+    typedef Generator<BatchedGEMVGenerator<T>> Base;
+    using Base::get_target;
+    using Base::natural_vector_size;
+    using Base::target;
+    template<typename T2>
+    using Input = typename Base::template Input<T2>;
+    template<typename T2>
+    using Output = typename Base::template Output<T2>;
+
+    GeneratorParam<bool> transpose_ = {"transpose", false};
+    GeneratorParam<int> batch_block_ = {"batch_block", 8};
+
+    Input<T> a_ = {"a", 1};
+    Input<Buffer<T>> A_ = {"A", 3};
+    Input<Buffer<T>> x_ = {"x", 2};
+    Input<T> b_ = {"b", 1};
+    Input<Buffer<T>> y_ = {"y", 2};
+
+    Output<Buffer<T>> output_ = {"output", 2};
+
+    void generate() {
+        const int vec_size = natural_vector_size(type_of<T>());
+
+        const Expr size = transpose_ ? A_.dim(1).extent() : A_.dim(0).extent();
+        const Expr sum_size = transpose_ ? A_.dim(0).extent() : A_.dim(1).extent();
+        const Expr batch_size = A_.dim(2).extent();
+
+        Var i("i"), batch("batch"), bo("bo"), u("u");
+        RDom k(0, sum_size, "k");
+        Func Ax("Ax");
+        if (transpose_) {
+            Ax(i, batch) += A_(k, i, batch) * x_(k, batch);
+        } else {
+            Ax(i, batch) += A_(i, k, batch) * x_(k, batch);
+        }
+
+        output_(i, batch) = b_ * y_(i, batch) + a_ * Ax(i, batch);
+
+        output_.split(batch, bo, batch, batch_block_, TailStrategy::GuardWithIf)
+            .parallel(bo)
+            .vectorize(i, vec_size, TailStrategy::GuardWithIf);
+
+        Ax.compute_at(output_, batch)
+            .vectorize(i, vec_size, TailStrategy::GuardWithIf);
+        if (transpose_) {
+            // The columns of A are contiguous along the reduction, so
+            // vectorize it and sum the lanes at the end.
+            RVar ko("ko"), ki("ki");
+            Func partial = Ax.update()
+                               .split(k, ko, ki, vec_size, TailStrategy::GuardWithIf)
+                               .rfactor(ki, u);
+            partial.compute_at(output_, batch)
+                .vectorize(u)
+                .update()
+                .reorder(u, ko, i)
+                .vectorize(u);
+        } else {
+            Ax.update()
+                .reorder(i, k)
+                .vectorize(i, vec_size, TailStrategy::GuardWithIf);
+        }
+
+        A_.dim(0).set_min(0).dim(1).set_min(0).dim(2).set_min(0);
+        x_.dim(0).set_bounds(0, sum_size).dim(1).set_bounds(0, batch_size);
+        y_.dim(0).set_bounds(0, size).dim(1).set_bounds(0, batch_size);
+        output_.dim(0).set_bounds(0, size).dim(1).set_bounds(0, batch_size);
+    }
+};
+
 }  // namespace
 
 HALIDE_REGISTER_GENERATOR(GEMVGenerator<float>, sgemv)
 HALIDE_REGISTER_GENERATOR(GEMVGenerator<double>, dgemv)
+HALIDE_REGISTER_GENERATOR(BatchedGEMVGenerator<float>, sgemv_batch)
+HALIDE_REGISTER_GENERATOR(BatchedGEMVGenerator<double>, dgemv_batch)
 HALIDE_REGISTER_GENERATOR(GERGenerator<float>, sger)
 HALIDE_REGISTER_GENERATOR(GERGenerator<double>, dger)
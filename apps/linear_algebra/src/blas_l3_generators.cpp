@@ -172,7 +172,89 @@ public:
     }
 };
 
+// Generator class for batched gemm operations on many small matrices,
+// stored as the slices of three dimensional buffers. Each product is
+// small enough to be computed in one pass, so only the batch is
+// parallelized, in blocks that amortize the cost of a task over several
+// matrices.
+template<class T>
+class BatchedGEMMGenerator : public Generator<BatchedGEMMGenerator<T>> {
+public:
+    typedef Generator<BatchedGEMMGenerator<T>> Base;
+    using Base::get_target;
+    using Base::natural_vector_size;
+    using Base::target;
+    template<typename T2>
+    using Input = typename Base::template Input<T2>;
+    template<typename T2>
+    using Output = typename Base::template Output<T2>;
+
+    GeneratorParam<bool> transpose_A_ = {"transpose_A", false};
+    GeneratorParam<bool> transpose_B_ = {"transpose_B", false};
+    GeneratorParam<int> batch_block_ = {"batch_block", 8};
+
+    Input<T> a_ = {"a_", 1};
+    Input<Buffer<T>> A_ = {"A_", 3};
+    Input<Buffer<T>> B_ = {"B_", 3};
+    Input<T> b_ = {"b_", 1};
+    Input<Buffer<T>> C_ = {"C_", 3};
+
+    Output<Buffer<T>> result_ = {"result", 3};
+
+    void generate() {
+        const Expr num_rows = transpose_A_ ? A_.dim(1).extent() : A_.dim(0).extent();
+        const Expr num_cols = transpose_B_ ? B_.dim(0).extent() : B_.dim(1).extent();
+        const Expr sum_size = transpose_A_ ? A_.dim(0).extent() : A_.dim(1).extent();
+        const Expr batch_size = A_.dim(2).extent();
+
+        const int vec = natural_vector_size(a_.type());
+
+        Var i("i"), j("j"), batch("batch"), io("io"), ii("ii"), jo("jo"), ji("ji"), bo("bo");
+
+        Func A("A"), B("B");
+        if (transpose_A_) {
+            A(i, j, batch) = A_(j, i, batch);
+        } else {
+            A(i, j, batch) = A_(i, j, batch);
+        }
+        if (transpose_B_) {
+            B(i, j, batch) = B_(j, i, batch);
+        } else {
+            B(i, j, batch) = B_(i, j, batch);
+        }
+
+        RDom k(0, sum_size, "k");
+        Func AB("AB");
+        AB(i, j, batch) += A(i, k, batch) * B(k, j, batch);
+
+        result_(i, j, batch) = a_ * AB(i, j, batch) + b_ * C_(i, j, batch);
+
+        result_.split(batch, bo, batch, batch_block_, TailStrategy::GuardWithIf)
+            .parallel(bo)
+            .vectorize(i, vec, TailStrategy::GuardWithIf);
+
+        // Accumulate a column of vectors by four columns of the product in
+        // registers over the whole reduction.
+        AB.compute_at(result_, batch)
+            .vectorize(i, vec, TailStrategy::GuardWithIf)
+            .update()
+            .split(i, io, ii, vec, TailStrategy::GuardWithIf)
+            .split(j, jo, ji, 4, TailStrategy::GuardWithIf)
+            .reorder(ii, ji, k, io, jo)
+            .vectorize(ii)
+            .unroll(ji);
+
+        A_.dim(0).set_min(0).dim(1).set_min(0).dim(2).set_min(0);
+        B_.dim(0).set_min(0).dim(1).set_min(0).dim(2).set_bounds(0, batch_size);
+        B_.dim(transpose_B_ ? 1 : 0).set_extent(sum_size);
+        C_.dim(0).set_bounds(0, num_rows).dim(1).set_bounds(0, num_cols).dim(2).set_bounds(0, batch_size);
+        result_.dim(0).set_bounds(0, num_rows).dim(1).set_bounds(0, num_cols).dim(2).set_bounds(0, batch_size);
+    }
+};
+
 }  // namespace
 
 HALIDE_REGISTER_GENERATOR(GEMMGenerator<float>, sgemm)
 HALIDE_REGISTER_GENERATOR(GEMMGenerator<double>, dgemm)
+HALIDE_REGISTER_GENERATOR(BatchedGEMMGenerator<float>, sgemm_batch)
+HALIDE_REGISTER_GENERATOR(BatchedGEMMGenerator<double>, dgemm_batch)
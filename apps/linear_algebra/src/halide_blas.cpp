@@ -1,5 +1,6 @@
 #include "halide_blas.h"
 #include "HalideBuffer.h"
+#include <cstdlib>
 #include <iostream>
 #include <string.h>
 
@@ -29,6 +30,60 @@ Buffer<T> init_matrix_buffer(const int M, const int N, T *A, const int lda) {
     return Buffer<T>(A, 2, shape);
 }
 
+template<typename T>
+Buffer<T> init_vector_batch_buffer(const int N, T *x, const int incx,
+                                   const int stride, const int batch_count) {
+    halide_dimension_t shape[] = {{0, N, incx}, {0, batch_count, stride}};
+    return Buffer<T>(x, 2, shape);
+}
+
+template<typename T>
+Buffer<T> init_matrix_batch_buffer(const int M, const int N, T *A, const int lda,
+                                   const int stride, const int batch_count) {
+    halide_dimension_t shape[] = {{0, M, 1}, {0, N, lda}, {0, batch_count, stride}};
+    return Buffer<T>(A, 3, shape);
+}
+
+// Returns true if the pointers of a batch are evenly spaced, setting
+// stride to their spacing in elements. Such batches can be passed to the
+// strided kernels as a single buffer.
+template<typename T>
+bool batch_stride(T *const *ptrs, const int batch_count, int *stride) {
+    intptr_t bytes = batch_count > 1 ? (intptr_t)ptrs[1] - (intptr_t)ptrs[0] : 0;
+    if (bytes % (intptr_t)sizeof(T) != 0) {
+        return false;
+    }
+    intptr_t elems = bytes / (intptr_t)sizeof(T);
+    if (elems != (int)elems) {
+        return false;
+    }
+    for (int i = 2; i < batch_count; i++) {
+        if ((intptr_t)ptrs[i] - (intptr_t)ptrs[0] != bytes * i) {
+            return false;
+        }
+    }
+    *stride = (int)elems;
+    return true;
+}
+
+// Returns true if the outputs of a batch laid out stride elements apart
+// do not overlap, given that each output spans extent elements. Batches
+// whose outputs overlap must be run one problem at a time.
+bool batch_outputs_disjoint(const int stride, const int64_t extent, const int batch_count) {
+    return batch_count == 1 || std::abs((int64_t)stride) >= extent;
+}
+
+// The number of elements spanned by a vector of length N with increment inc.
+int64_t vector_extent(const int N, const int inc) {
+    return N > 0 ? (int64_t)(N - 1) * std::abs(inc) + 1 : 0;
+}
+
+// The number of elements spanned by an M x N column-major matrix with
+// leading dimension ld.
+int64_t matrix_extent(const int M, const int N, const int ld) {
+    return M > 0 && N > 0 ? (int64_t)(N - 1) * ld + M : 0;
+}
+
 }  // namespace
 
 #ifdef __cplusplus
@@ -195,6 +250,80 @@ void hblas_dgemv(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE trans,
     assert_no_error(halide_dgemv(t, a, buff_A, buff_x, b, buff_y));
 }
 
+void hblas_sgemv_strided_batch(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE trans,
+                               const int M, const int N, const float a, const float *A, const int lda,
+                               const int strideA, const float *x, const int incx, const int stridex,
+                               const float b, float *y, const int incy, const int stridey,
+                               const int batch_count) {
+    bool t = trans != HblasNoTrans;
+
+    auto buff_A = init_matrix_batch_buffer(M, N, const_cast<float *>(A), lda, strideA, batch_count);
+    auto buff_x = init_vector_batch_buffer(t ? M : N, const_cast<float *>(x), incx, stridex, batch_count);
+    auto buff_y = init_vector_batch_buffer(t ? N : M, y, incy, stridey, batch_count);
+
+    assert_no_error(halide_sgemv_batch(t, a, buff_A, buff_x, b, buff_y));
+}
+
+void hblas_sgemv_batch(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE trans,
+                       const int M, const int N, const float a, const float **A, const int lda,
+                       const float **x, const int incx, const float b, float **y, const int incy,
+                       const int batch_count) {
+    if (batch_count <= 0) {
+        return;
+    }
+
+    // The outputs must not alias for the batch to run in parallel.
+    int strideA, stridex, stridey;
+    if (batch_stride(A, batch_count, &strideA) &&
+        batch_stride(x, batch_count, &stridex) &&
+        batch_stride(y, batch_count, &stridey) &&
+        batch_outputs_disjoint(stridey, vector_extent(trans != HblasNoTrans ? N : M, incy), batch_count)) {
+        hblas_sgemv_strided_batch(Order, trans, M, N, a, A[0], lda, strideA,
+                                  x[0], incx, stridex, b, y[0], incy, stridey, batch_count);
+    } else {
+        for (int i = 0; i < batch_count; i++) {
+            hblas_sgemv(Order, trans, M, N, a, A[i], lda, x[i], incx, b, y[i], incy);
+        }
+    }
+}
+
+void hblas_dgemv_strided_batch(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE trans,
+                               const int M, const int N, const double a, const double *A, const int lda,
+                               const int strideA, const double *x, const int incx, const int stridex,
+                               const double b, double *y, const int incy, const int stridey,
+                               const int batch_count) {
+    bool t = trans != HblasNoTrans;
+
+    auto buff_A = init_matrix_batch_buffer(M, N, const_cast<double *>(A), lda, strideA, batch_count);
+    auto buff_x = init_vector_batch_buffer(t ? M : N, const_cast<double *>(x), incx, stridex, batch_count);
+    auto buff_y = init_vector_batch_buffer(t ? N : M, y, incy, stridey, batch_count);
+
+    assert_no_error(halide_dgemv_batch(t, a, buff_A, buff_x, b, buff_y));
+}
+
+void hblas_dgemv_batch(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE trans,
+                       const int M, const int N, const double a, const double **A, const int lda,
+                       const double **x, const int incx, const double b, double **y, const int incy,
+                       const int batch_count) {
+    if (batch_count <= 0) {
+        return;
+    }
+
+    // The outputs must not alias for the batch to run in parallel.
+    int strideA, stridex, stridey;
+    if (batch_stride(A, batch_count, &strideA) &&
+        batch_stride(x, batch_count, &stridex) &&
+        batch_stride(y, batch_count, &stridey) &&
+        batch_outputs_disjoint(stridey, vector_extent(trans != HblasNoTrans ? N : M, incy), batch_count)) {
+        hblas_dgemv_strided_batch(Order, trans, M, N, a, A[0], lda, strideA,
+                                  x[0], incx, stridex, b, y[0], incy, stridey, batch_count);
+    } else {
+        for (int i = 0; i < batch_count; i++) {
+            hblas_dgemv(Order, trans, M, N, a, A[i], lda, x[i], incx, b, y[i], incy);
+        }
+    }
+}
+
 //////////
 // ger  //
 //////////
@@ -289,6 +418,86 @@ void hblas_dgemm(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA
     assert_no_error(halide_dgemm(tA, tB, alpha, buff_A, buff_B, beta, buff_C));
 }
 
+void hblas_sgemm_strided_batch(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                               const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                               const int K, const float alpha, const float *A,
+                               const int lda, const int strideA, const float *B, const int ldb,
+                               const int strideB, const float beta, float *C, const int ldc,
+                               const int strideC, const int batch_count) {
+    bool tA = TransA != HblasNoTrans;
+    bool tB = TransB != HblasNoTrans;
+
+    auto buff_A = init_matrix_batch_buffer(tA ? K : M, tA ? M : K, const_cast<float *>(A), lda, strideA, batch_count);
+    auto buff_B = init_matrix_batch_buffer(tB ? N : K, tB ? K : N, const_cast<float *>(B), ldb, strideB, batch_count);
+    auto buff_C = init_matrix_batch_buffer(M, N, C, ldc, strideC, batch_count);
+
+    assert_no_error(halide_sgemm_batch(tA, tB, alpha, buff_A, buff_B, beta, buff_C));
+}
+
+void hblas_sgemm_batch(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                       const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                       const int K, const float alpha, const float **A,
+                       const int lda, const float **B, const int ldb,
+                       const float beta, float **C, const int ldc, const int batch_count) {
+    if (batch_count <= 0) {
+        return;
+    }
+
+    // The outputs must not alias for the batch to run in parallel.
+    int strideA, strideB, strideC;
+    if (batch_stride(A, batch_count, &strideA) &&
+        batch_stride(B, batch_count, &strideB) &&
+        batch_stride(C, batch_count, &strideC) &&
+        batch_outputs_disjoint(strideC, matrix_extent(M, N, ldc), batch_count)) {
+        hblas_sgemm_strided_batch(Order, TransA, TransB, M, N, K, alpha, A[0], lda, strideA,
+                                  B[0], ldb, strideB, beta, C[0], ldc, strideC, batch_count);
+    } else {
+        for (int i = 0; i < batch_count; i++) {
+            hblas_sgemm(Order, TransA, TransB, M, N, K, alpha, A[i], lda, B[i], ldb, beta, C[i], ldc);
+        }
+    }
+}
+
+void hblas_dgemm_strided_batch(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                               const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                               const int K, const double alpha, const double *A,
+                               const int lda, const int strideA, const double *B, const int ldb,
+                               const int strideB, const double beta, double *C, const int ldc,
+                               const int strideC, const int batch_count) {
+    bool tA = TransA != HblasNoTrans;
+    bool tB = TransB != HblasNoTrans;
+
+    auto buff_A = init_matrix_batch_buffer(tA ? K : M, tA ? M : K, const_cast<double *>(A), lda, strideA, batch_count);
+    auto buff_B = init_matrix_batch_buffer(tB ? N : K, tB ? K : N, const_cast<double *>(B), ldb, strideB, batch_count);
+    auto buff_C = init_matrix_batch_buffer(M, N, C, ldc, strideC, batch_count);
+
+    assert_no_error(halide_dgemm_batch(tA, tB, alpha, buff_A, buff_B, beta, buff_C));
+}
+
+void hblas_dgemm_batch(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                       const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                       const int K, const double alpha, const double **A,
+                       const int lda, const double **B, const int ldb,
+                       const double beta, double **C, const int ldc, const int batch_count) {
+    if (batch_count <= 0) {
+        return;
+    }
+
+    // The outputs must not alias for the batch to run in parallel.
+    int strideA, strideB, strideC;
+    if (batch_stride(A, batch_count, &strideA) &&
+        batch_stride(B, batch_count, &strideB) &&
+        batch_stride(C, batch_count, &strideC) &&
+        batch_outputs_disjoint(strideC, matrix_extent(M, N, ldc), batch_count)) {
+        hblas_dgemm_strided_batch(Order, TransA, TransB, M, N, K, alpha, A[0], lda, strideA,
+                                  B[0], ldb, strideB, beta, C[0], ldc, strideC, batch_count);
+    } else {
+        for (int i = 0; i < batch_count; i++) {
+            hblas_dgemm(Order, TransA, TransB, M, N, K, alpha, A[i], lda, B[i], ldb, beta, C[i], ldc);
+        }
+    }
+}
+
 #ifdef __cplusplus
 }
 #endif
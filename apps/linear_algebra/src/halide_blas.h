@@ -8,10 +8,16 @@
 #include "halide_daxpy_impl.h"
 #include "halide_dcopy_impl.h"
 #include "halide_ddot.h"
+#include "halide_dgemm_batch_notrans.h"
+#include "halide_dgemm_batch_transA.h"
+#include "halide_dgemm_batch_transAB.h"
+#include "halide_dgemm_batch_transB.h"
 #include "halide_dgemm_notrans.h"
 #include "halide_dgemm_transA.h"
 #include "halide_dgemm_transAB.h"
 #include "halide_dgemm_transB.h"
+#include "halide_dgemv_batch_notrans.h"
+#include "halide_dgemv_batch_trans.h"
 #include "halide_dgemv_notrans.h"
 #include "halide_dgemv_trans.h"
 #include "halide_dger_impl.h"
@@ -20,10 +26,16 @@
 #include "halide_saxpy_impl.h"
 #include "halide_scopy_impl.h"
 #include "halide_sdot.h"
+#include "halide_sgemm_batch_notrans.h"
+#include "halide_sgemm_batch_transA.h"
+#include "halide_sgemm_batch_transAB.h"
+#include "halide_sgemm_batch_transB.h"
 #include "halide_sgemm_notrans.h"
 #include "halide_sgemm_transA.h"
 #include "halide_sgemm_transAB.h"
 #include "halide_sgemm_transB.h"
+#include "halide_sgemv_batch_notrans.h"
+#include "halide_sgemv_batch_trans.h"
 #include "halide_sgemv_notrans.h"
 #include "halide_sgemv_trans.h"
 #include "halide_sger_impl.h"
@@ -69,6 +81,22 @@ inline int halide_dgemv(bool trans, double a, halide_buffer_t *A, halide_buffer_
     }
 }
 
+inline int halide_sgemv_batch(bool trans, float a, halide_buffer_t *A, halide_buffer_t *x, float b, halide_buffer_t *y) {
+    if (trans) {
+        return halide_sgemv_batch_trans(a, A, x, b, y, y);
+    } else {
+        return halide_sgemv_batch_notrans(a, A, x, b, y, y);
+    }
+}
+
+inline int halide_dgemv_batch(bool trans, double a, halide_buffer_t *A, halide_buffer_t *x, double b, halide_buffer_t *y) {
+    if (trans) {
+        return halide_dgemv_batch_trans(a, A, x, b, y, y);
+    } else {
+        return halide_dgemv_batch_notrans(a, A, x, b, y, y);
+    }
+}
+
 inline int halide_sger(float a, halide_buffer_t *x, halide_buffer_t *y, halide_buffer_t *A) {
     return halide_sger_impl(a, x, y, A);
 }
@@ -103,6 +131,32 @@ inline int halide_dgemm(bool transA, bool transB, double a, halide_buffer_t *A,
     return -1;
 }
 
+inline int halide_sgemm_batch(bool transA, bool transB, float a, halide_buffer_t *A, halide_buffer_t *B, float b, halide_buffer_t *C) {
+    if (transA && transB) {
+        return halide_sgemm_batch_transAB(a, A, B, b, C, C);
+    } else if (transA) {
+        return halide_sgemm_batch_transA(a, A, B, b, C, C);
+    } else if (transB) {
+        return halide_sgemm_batch_transB(a, A, B, b, C, C);
+    } else {
+        return halide_sgemm_batch_notrans(a, A, B, b, C, C);
+    }
+    return -1;
+}
+
+inline int halide_dgemm_batch(bool transA, bool transB, double a, halide_buffer_t *A, halide_buffer_t *B, double b, halide_buffer_t *C) {
+    if (transA && transB) {
+        return halide_dgemm_batch_transAB(a, A, B, b, C, C);
+    } else if (transA) {
+        return halide_dgemm_batch_transA(a, A, B, b, C, C);
+    } else if (transB) {
+        return halide_dgemm_batch_transB(a, A, B, b, C, C);
+    } else {
+        return halide_dgemm_batch_notrans(a, A, B, b, C, C);
+    }
+    return -1;
+}
+
 enum HBLAS_ORDER { HblasRowMajor = 101,
                    HblasColMajor = 102 };
 enum HBLAS_TRANSPOSE { HblasNoTrans = 111,
@@ -225,6 +279,36 @@ void hblas_dger(const enum HBLAS_ORDER order, const int M, const int N,
                 const double alpha, const double *X, const int incX,
                 const double *Y, const int incY, double *A, const int lda);
 
+/*
+ * Batched gemv on batch_count problems of the same shape. The strided
+ * variants take each operand as one array holding the i-th matrix or
+ * vector at an offset of i times its stride. The others take an array of
+ * pointers to each operand.
+ */
+void hblas_sgemv_strided_batch(const enum HBLAS_ORDER order,
+                               const enum HBLAS_TRANSPOSE TransA, const int M, const int N,
+                               const float alpha, const float *A, const int lda, const int strideA,
+                               const float *X, const int incX, const int strideX, const float beta,
+                               float *Y, const int incY, const int strideY, const int batch_count);
+
+void hblas_sgemv_batch(const enum HBLAS_ORDER order,
+                       const enum HBLAS_TRANSPOSE TransA, const int M, const int N,
+                       const float alpha, const float **A, const int lda,
+                       const float **X, const int incX, const float beta,
+                       float **Y, const int incY, const int batch_count);
+
+void hblas_dgemv_strided_batch(const enum HBLAS_ORDER order,
+                               const enum HBLAS_TRANSPOSE TransA, const int M, const int N,
+                               const double alpha, const double *A, const int lda, const int strideA,
+                               const double *X, const int incX, const int strideX, const double beta,
+                               double *Y, const int incY, const int strideY, const int batch_count);
+
+void hblas_dgemv_batch(const enum HBLAS_ORDER order,
+                       const enum HBLAS_TRANSPOSE TransA, const int M, const int N,
+                       const double alpha, const double **A, const int lda,
+                       const double **X, const int incX, const double beta,
+                       double **Y, const int incY, const int batch_count);
+
 /*
  * ===========================================================================
  * Prototypes for level 3 BLAS
@@ -246,6 +330,36 @@ void hblas_dgemm(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA
                  const int lda, const double *B, const int ldb,
                  const double beta, double *C, const int ldc);
 
+/*
+ * Batched gemm on batch_count problems of the same shape, taking the
+ * operands either as strided arrays or as arrays of pointers, as for gemv.
+ */
+void hblas_sgemm_strided_batch(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                               const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                               const int K, const float alpha, const float *A,
+                               const int lda, const int strideA, const float *B, const int ldb,
+                               const int strideB, const float beta, float *C, const int ldc,
+                               const int strideC, const int batch_count);
+
+void hblas_sgemm_batch(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                       const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                       const int K, const float alpha, const float **A,
+                       const int lda, const float **B, const int ldb,
+                       const float beta, float **C, const int ldc, const int batch_count);
+
+void hblas_dgemm_strided_batch(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                               const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                               const int K, const double alpha, const double *A,
+                               const int lda, const int strideA, const double *B, const int ldb,
+                               const int strideB, const double beta, double *C, const int ldc,
+                               const int strideC, const int batch_count);
+
+void hblas_dgemm_batch(const enum HBLAS_ORDER Order, const enum HBLAS_TRANSPOSE TransA,
+                       const enum HBLAS_TRANSPOSE TransB, const int M, const int N,
+                       const int K, const double alpha, const double **A,
+                       const int lda, const double **B, const int ldb,
+                       const double beta, double **C, const int ldc, const int batch_count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -113,6 +113,62 @@
         return compareMatrices(N, eC, aC);      \
     }
 
+// The batched tests run many small problems of an awkward size, and
+// compare against one cblas call per problem.
+#define L2_BATCH_TEST(method, cblas_code, hblas_code)    \
+    bool test_##method(int) {                            \
+        const int N = 19, count = 64;                    \
+        Scalar alpha = random_scalar();                  \
+        Scalar beta = random_scalar();                   \
+        Vector eA(random_vector(N * N * count));         \
+        Vector ex(random_vector(N * count));             \
+        Vector ey(random_vector(N * count));             \
+        Vector ay(ey);                                   \
+                                                         \
+        for (int i = 0; i < count; i++) {                \
+            Scalar *A = &(eA[i * N * N]);                \
+            Scalar *x = &(ex[i * N]);                    \
+            Scalar *y = &(ey[i * N]);                    \
+            cblas_code;                                  \
+        }                                                \
+                                                         \
+        {                                                \
+            Scalar *A = &(eA[0]);                        \
+            Scalar *x = &(ex[0]);                        \
+            Scalar *y = &(ay[0]);                        \
+            hblas_code;                                  \
+        }                                                \
+                                                         \
+        return compareVectors(N * count, ey, ay);        \
+    }
+
+#define L3_BATCH_TEST(method, cblas_code, hblas_code)    \
+    bool test_##method(int) {                            \
+        const int N = 19, count = 64;                    \
+        Scalar alpha = random_scalar();                  \
+        Scalar beta = random_scalar();                   \
+        Vector eA(random_vector(N * N * count));         \
+        Vector eB(random_vector(N * N * count));         \
+        Vector eC(random_vector(N * N * count));         \
+        Vector aC(eC);                                   \
+                                                         \
+        for (int i = 0; i < count; i++) {                \
+            Scalar *A = &(eA[i * N * N]);                \
+            Scalar *B = &(eB[i * N * N]);                \
+            Scalar *C = &(eC[i * N * N]);                \
+            cblas_code;                                  \
+        }                                                \
+                                                         \
+        {                                                \
+            Scalar *A = &(eA[0]);                        \
+            Scalar *B = &(eB[0]);                        \
+            Scalar *C = &(aC[0]);                        \
+            hblas_code;                                  \
+        }                                                \
+                                                         \
+        return compareVectors(N * N * count, eC, aC);    \
+    }
+
 template<class T>
 struct BLASTestBase {
     typedef T Scalar;
@@ -209,10 +265,18 @@ struct BLASFloatTests : public BLASTestBase<float> {
         RUN_TEST(sgemv_notrans);
         RUN_TEST(sgemv_trans);
         RUN_TEST(sger);
+        RUN_TEST(sgemv_batch_notrans);
+        RUN_TEST(sgemv_batch_trans);
         RUN_TEST(sgemm_notrans);
         RUN_TEST(sgemm_transA);
         RUN_TEST(sgemm_transB);
         RUN_TEST(sgemm_transAB);
+        RUN_TEST(sgemm_batch_notrans);
+        RUN_TEST(sgemm_batch_transA);
+        RUN_TEST(sgemm_batch_transB);
+        RUN_TEST(sgemm_batch_transAB);
+        RUN_TEST(sgemm_batch_pointers);
+        RUN_TEST(sgemm_batch_overlapping);
     }
 
     L1_VECTOR_TEST(scopy, scopy(N, x, 1, y, 1))
@@ -232,6 +296,13 @@ struct BLASFloatTests : public BLASTestBase<float> {
             cblas_sger(CblasColMajor, N, N, alpha, x, 1, y, 1, A, N),
             hblas_sger(HblasColMajor, N, N, alpha, x, 1, y, 1, A, N));
 
+    L2_BATCH_TEST(sgemv_batch_notrans,
+                  cblas_sgemv(CblasColMajor, CblasNoTrans, N, N, alpha, A, N, x, 1, beta, y, 1),
+                  hblas_sgemv_strided_batch(HblasColMajor, HblasNoTrans, N, N, alpha, A, N, N * N, x, 1, N, beta, y, 1, N, count));
+    L2_BATCH_TEST(sgemv_batch_trans,
+                  cblas_sgemv(CblasColMajor, CblasTrans, N, N, alpha, A, N, x, 1, beta, y, 1),
+                  hblas_sgemv_strided_batch(HblasColMajor, HblasTrans, N, N, alpha, A, N, N * N, x, 1, N, beta, y, 1, N, count));
+
     L3_TEST(sgemm_notrans,
             cblas_sgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
             hblas_sgemm(HblasColMajor, HblasNoTrans, HblasNoTrans, N, N, N, alpha, A, N, B, N, beta, C, N));
@@ -244,6 +315,62 @@ struct BLASFloatTests : public BLASTestBase<float> {
     L3_TEST(sgemm_transAB,
             cblas_sgemm(CblasColMajor, CblasTrans, CblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
             hblas_sgemm(HblasColMajor, HblasTrans, HblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N));
+
+    L3_BATCH_TEST(sgemm_batch_notrans,
+                  cblas_sgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
+                  hblas_sgemm_strided_batch(HblasColMajor, HblasNoTrans, HblasNoTrans, N, N, N, alpha, A, N, N * N, B, N, N * N, beta, C, N, N * N, count));
+    L3_BATCH_TEST(sgemm_batch_transA,
+                  cblas_sgemm(CblasColMajor, CblasTrans, CblasNoTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
+                  hblas_sgemm_strided_batch(HblasColMajor, HblasTrans, HblasNoTrans, N, N, N, alpha, A, N, N * N, B, N, N * N, beta, C, N, N * N, count));
+    L3_BATCH_TEST(sgemm_batch_transB,
+                  cblas_sgemm(CblasColMajor, CblasNoTrans, CblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
+                  hblas_sgemm_strided_batch(HblasColMajor, HblasNoTrans, HblasTrans, N, N, N, alpha, A, N, N * N, B, N, N * N, beta, C, N, N * N, count));
+    L3_BATCH_TEST(sgemm_batch_transAB,
+                  cblas_sgemm(CblasColMajor, CblasTrans, CblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
+                  hblas_sgemm_strided_batch(HblasColMajor, HblasTrans, HblasTrans, N, N, N, alpha, A, N, N * N, B, N, N * N, beta, C, N, N * N, count));
+
+    // Pass the batch as arrays of pointers, in reverse order.
+    void sgemm_batch_reversed(int N, int count, Scalar alpha, const Scalar *A, const Scalar *B,
+                              Scalar beta, Scalar *C) {
+        std::vector<const Scalar *> As(count), Bs(count);
+        std::vector<Scalar *> Cs(count);
+        for (int i = 0; i < count; i++) {
+            As[i] = A + (count - 1 - i) * N * N;
+            Bs[i] = B + (count - 1 - i) * N * N;
+            Cs[i] = C + (count - 1 - i) * N * N;
+        }
+        hblas_sgemm_batch(HblasColMajor, HblasNoTrans, HblasNoTrans, N, N, N, alpha,
+                          As.data(), N, Bs.data(), N, beta, Cs.data(), N, count);
+    }
+    L3_BATCH_TEST(sgemm_batch_pointers,
+                  cblas_sgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
+                  sgemm_batch_reversed(N, count, alpha, A, B, beta, C));
+
+    // Outputs that overlap are evenly spaced, but must still be computed
+    // one problem at a time, in order.
+    bool test_sgemm_batch_overlapping(int) {
+        const int N = 19, count = 8;
+        Scalar alpha = random_scalar();
+        Scalar beta = random_scalar();
+        Vector A(random_vector(N * N * count));
+        Vector B(random_vector(N * N * count));
+        Vector eC(random_vector(N * N + N * (count - 1)));
+        Vector aC(eC);
+
+        std::vector<const Scalar *> As(count), Bs(count);
+        std::vector<Scalar *> Cs(count);
+        for (int i = 0; i < count; i++) {
+            cblas_sgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, N, N, N, alpha,
+                        &A[i * N * N], N, &B[i * N * N], N, beta, &eC[i * N], N);
+            As[i] = &A[i * N * N];
+            Bs[i] = &B[i * N * N];
+            Cs[i] = &aC[i * N];
+        }
+        hblas_sgemm_batch(HblasColMajor, HblasNoTrans, HblasNoTrans, N, N, N, alpha,
+                          As.data(), N, Bs.data(), N, beta, Cs.data(), N, count);
+
+        return compareVectors((int)eC.size(), eC, aC);
+    }
 };
 
 struct BLASDoubleTests : public BLASTestBase<double> {
@@ -256,10 +383,16 @@ struct BLASDoubleTests : public BLASTestBase<double> {
         RUN_TEST(dgemv_notrans);
         RUN_TEST(dgemv_trans);
         RUN_TEST(dger);
+        RUN_TEST(dgemv_batch_notrans);
+        RUN_TEST(dgemv_batch_trans);
         RUN_TEST(dgemm_notrans);
         RUN_TEST(dgemm_transA);
         RUN_TEST(dgemm_transB);
         RUN_TEST(dgemm_transAB);
+        RUN_TEST(dgemm_batch_notrans);
+        RUN_TEST(dgemm_batch_transA);
+        RUN_TEST(dgemm_batch_transB);
+        RUN_TEST(dgemm_batch_transAB);
     }
 
     L1_VECTOR_TEST(dcopy, dcopy(N, x, 1, y, 1))
@@ -279,6 +412,13 @@ struct BLASDoubleTests : public BLASTestBase<double> {
             cblas_dger(CblasColMajor, N, N, alpha, x, 1, y, 1, A, N),
             hblas_dger(HblasColMajor, N, N, alpha, x, 1, y, 1, A, N));
 
+    L2_BATCH_TEST(dgemv_batch_notrans,
+                  cblas_dgemv(CblasColMajor, CblasNoTrans, N, N, alpha, A, N, x, 1, beta, y, 1),
+                  hblas_dgemv_strided_batch(HblasColMajor, HblasNoTrans, N, N, alpha, A, N, N * N, x, 1, N, beta, y, 1, N, count));
+    L2_BATCH_TEST(dgemv_batch_trans,
+                  cblas_dgemv(CblasColMajor, CblasTrans, N, N, alpha, A, N, x, 1, beta, y, 1),
+                  hblas_dgemv_strided_batch(HblasColMajor, HblasTrans, N, N, alpha, A, N, N * N, x, 1, N, beta, y, 1, N, count));
+
     L3_TEST(dgemm_notrans,
             cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
             hblas_dgemm(HblasColMajor, HblasNoTrans, HblasNoTrans, N, N, N, alpha, A, N, B, N, beta, C, N));
@@ -291,6 +431,19 @@ struct BLASDoubleTests : public BLASTestBase<double> {
     L3_TEST(dgemm_transAB,
             cblas_dgemm(CblasColMajor, CblasTrans, CblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
             hblas_dgemm(HblasColMajor, HblasTrans, HblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N));
+
+    L3_BATCH_TEST(dgemm_batch_notrans,
+                  cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
+                  hblas_dgemm_strided_batch(HblasColMajor, HblasNoTrans, HblasNoTrans, N, N, N, alpha, A, N, N * N, B, N, N * N, beta, C, N, N * N, count));
+    L3_BATCH_TEST(dgemm_batch_transA,
+                  cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
+                  hblas_dgemm_strided_batch(HblasColMajor, HblasTrans, HblasNoTrans, N, N, N, alpha, A, N, N * N, B, N, N * N, beta, C, N, N * N, count));
+    L3_BATCH_TEST(dgemm_batch_transB,
+                  cblas_dgemm(CblasColMajor, CblasNoTrans, CblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
+                  hblas_dgemm_strided_batch(HblasColMajor, HblasNoTrans, HblasTrans, N, N, N, alpha, A, N, N * N, B, N, N * N, beta, C, N, N * N, count));
+    L3_BATCH_TEST(dgemm_batch_transAB,
+                  cblas_dgemm(CblasColMajor, CblasTrans, CblasTrans, N, N, N, alpha, A, N, B, N, beta, C, N),
+                  hblas_dgemm_strided_batch(HblasColMajor, HblasTrans, HblasTrans, N, N, N, alpha, A, N, N * N, B, N, N * N, beta, C, N, N * N, count));
 };
 
 int main(int argc, char *argv[]) {
@@ -4,9 +4,20 @@
 #include "Halide.h"
 #include "onnx_converter.h"
 
+// A model compiled ahead of time and loaded from a shared library.
+struct CompiledModel {
+    void *lib_handle = nullptr;
+    int (*argv_fn)(void **args) = nullptr;
+
+    ~CompiledModel();
+};
+
 struct HalideModel {
     std::shared_ptr<Model> model;
     std::shared_ptr<Halide::Pipeline> rep;
+    // Set once the model has been loaded from a shared library, in which case
+    // it is used instead of JIT compiling the pipeline.
+    std::shared_ptr<CompiledModel> compiled;
     std::vector<std::string> input_names;
     std::unordered_map<std::string, int> input_types;
     std::vector<std::string> output_names;
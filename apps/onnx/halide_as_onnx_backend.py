@@ -8,6 +8,7 @@ import signal
 import base64
 import hashlib
 import datetime
+import os
 
 
 class HalideBackend(BackendBase):
@@ -34,6 +35,13 @@ class HalideBackend(BackendBase):
         Builds and returns an internal representation of the model (which
         includes the actual Halide pipeline).
 
+        If a cache directory is given with the cache_dir argument or the
+        HL_ONNX_CACHE_DIR environment variable, the model is compiled ahead of
+        time into a shared library stored there, and later calls load that
+        library instead of scheduling and JIT compiling the model again. The
+        model is still converted, including the JIT compilation of its
+        constant subgraphs.
+
         :param model: The ONNX model to be converted.
         :param device: The device to execute this model on (Ignored for now).
         :returns: An internal object that can be used to run the model with
@@ -43,10 +51,19 @@ class HalideBackend(BackendBase):
 
         prepared = halide_model.Model()
         prepared.BuildFromOnnxModel(model)
+
         # Optimize the schedule of nontrivial models to make sure they
         # complete in a reasonable amount of time
-        if len(model.graph.node) > 10:
+        schedule = 'auto' if len(model.graph.node) > 10 else 'default'
+
+        cache_dir = kwargs.get('cache_dir', os.environ.get('HL_ONNX_CACHE_DIR'))
+        if cache_dir and prepared.LoadFromCache(cache_dir, device, schedule):
+            return prepared
+
+        if schedule == 'auto':
             prepared.OptimizeSchedule()
+        if cache_dir:
+            prepared.CompileToCache(cache_dir, device)
         return prepared
 
     @classmethod
@@ -37,10 +37,6 @@ exclude_test_patterns = (
      '|test_cast_STRING_to_FLOAT.*'  # not supported yet
      '|test_.*scatter.*'  # not supported yet
      '|test_.*upsample.*'  # not supported yet
-     '|test_.*qlinear.*'  # skip quantized op test
-     '|test_.*quantize.*'  # skip quantized op test
-     '|test_.*matmulinteger.*'  # skip quantized op test
-     '|test_.*convinteger.*'  # skip quantized op test
      '|test_mod_.*'  # not supported yet
      '|test_cumsum_.*'  # not supported yet
      '|test_bitshift_.*'  # not supported yet
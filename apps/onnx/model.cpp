@@ -6,13 +6,26 @@
 #include "common_types.h"
 #include "denormal_disabler.h"
 #include "onnx_converter.h"
+#include <cerrno>
+#include <cstdio>
+#include <dlfcn.h>
 #include <fstream>
 #include <random>
+#include <sstream>
+#include <sys/stat.h>
 #include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
 #include <unordered_set>
 
 namespace py = pybind11;
 
+CompiledModel::~CompiledModel() {
+    if (lib_handle) {
+        dlclose(lib_handle);
+    }
+}
+
 namespace {
 
 HalideModel convert_onnx_model(
@@ -44,7 +57,7 @@ HalideModel convert_onnx_model(
     }
 
     result.model = std::make_shared<Model>(
-        convert_model(onnx_model, expected_dim_sizes, layout));
+        convert_model(&onnx_model, expected_dim_sizes, layout));
 
     std::vector<Halide::Func> funcs;
     for (const auto &output : onnx_model.graph().output()) {
@@ -300,6 +313,46 @@ Halide::Type onnx_type_to_halide_type(int t) {
     }
 }
 
+Halide::Target model_target(const std::string &device) {
+    Halide::Target tgt = Halide::get_host_target();
+    // Don't allow LLVM to mess with the code.
+    tgt.set_feature(Halide::Target::DisableLLVMLoopOpt, true);
+    // Don't create buffers larger than 2GB since we use 32bit signed indices to
+    // index the data stored in them.
+    tgt.set_feature(Halide::Target::LargeBuffers, false);
+    if (device == "CUDA") {
+        tgt.set_feature(Halide::Target::CUDA, true);
+    }
+    return tgt;
+}
+
+void realize_outputs(
+    const HalideModel &pipeline,
+    Halide::Realization &real,
+    const Halide::Target &tgt) {
+    if (!pipeline.compiled) {
+        pipeline.rep->realize(real, tgt);
+        return;
+    }
+
+    // The arguments of the compiled model are the inputs followed by the
+    // outputs, in the order used by compile_to_cache.
+    std::vector<void *> args;
+    for (const std::string &input_name : pipeline.input_names) {
+        Halide::Buffer<> input = pipeline.model->inputs.at(input_name).get();
+        args.push_back(input.raw_buffer());
+    }
+    for (size_t i = 0; i < real.size(); ++i) {
+        Halide::Buffer<> &output = real[i];
+        args.push_back(output.raw_buffer());
+    }
+    int result = pipeline.compiled->argv_fn(args.data());
+    if (result != 0) {
+        throw std::runtime_error(
+            "Compiled model failed with error code " + std::to_string(result));
+    }
+}
+
 std::vector<py::array> run(
     const HalideModel &pipeline,
     const std::vector<py::array> &inputs,
@@ -343,17 +396,7 @@ std::vector<py::array> run(
         outputs[i].transpose(dims);
     }
     Halide::Realization real(outputs);
-    Halide::Target tgt = Halide::get_host_target();
-    // Don't allow LLVM to mess with the code.
-    tgt.set_feature(Halide::Target::DisableLLVMLoopOpt, true);
-    // Don't create buffers larger than 2GB since we use 32bit signed indices to
-    // index the data stored in them.
-    tgt.set_feature(Halide::Target::LargeBuffers, false);
-    if (device == "CUDA") {
-        tgt.set_feature(Halide::Target::CUDA, true);
-    }
-
-    pipeline.rep->realize(real, tgt);
+    realize_outputs(pipeline, real, model_target(device));
 
     std::vector<py::array> results;
 
@@ -460,16 +503,8 @@ double benchmark(
     }
 
     Halide::Realization real(outputs);
-    Halide::Target tgt = Halide::get_host_target();
-    // Don't allow LLVM to mess with the code.
-    tgt.set_feature(Halide::Target::DisableLLVMLoopOpt, true);
-    // Don't create buffers larger than 2GB since we use 32bit signed indices to
-    // index the data stored in them.
-    tgt.set_feature(Halide::Target::LargeBuffers, false);
-    if (device == "CUDA") {
-        tgt.set_feature(Halide::Target::CUDA, true);
-    }
-    pipeline.rep->realize(real, tgt);
+    const Halide::Target tgt = model_target(device);
+    realize_outputs(pipeline, real, tgt);
 
     // Now benchmark by computing the value of the outputs num_iter times
     struct timespec start;
@@ -479,7 +514,7 @@ double benchmark(
         // Increment the coefficients store in the cache evictor: this ensures that
         // all the data left in caches from the previous iteration is flushed out.
         cache_evictor.flush_caches();
-        pipeline.rep->realize(real, tgt);
+        realize_outputs(pipeline, real, tgt);
     }
     clock_gettime(CLOCK_REALTIME, &end);
 
@@ -527,6 +562,144 @@ void compile(
         std::string("/tmp/") + lib_name + ".h", inputs, func_name, tgt);
 }
 
+std::string target_string(const std::string &device) {
+    return model_target(device).to_string();
+}
+
+bool file_exists(const std::string &path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0;
+}
+
+// Describes the build of the library that contains the given symbol (its
+// path, size and modification time), so that libraries compiled by a
+// different build of Halide or of the converter aren't picked up from the
+// cache.
+std::string library_build_id(const void *symbol) {
+    Dl_info info;
+    struct stat st;
+    if (!dladdr(symbol, &info) || !info.dli_fname ||
+        stat(info.dli_fname, &st) != 0) {
+        return "unknown";
+    }
+    return std::string(info.dli_fname) + ":" + std::to_string(st.st_size) +
+           ":" + std::to_string(st.st_mtime);
+}
+
+std::string halide_build_id() {
+    const std::string halide_id =
+        library_build_id(reinterpret_cast<const void *>(&Halide::get_host_target));
+    const std::string converter_id =
+        library_build_id(reinterpret_cast<const void *>(&convert_model));
+    if (halide_id == converter_id) {
+        return halide_id;
+    }
+    return halide_id + ";" + converter_id;
+}
+
+// Run a command without going through the shell, so that paths containing
+// spaces or shell metacharacters are passed through unchanged. Returns true
+// if it exited successfully.
+bool run_command(const std::vector<std::string> &args) {
+    std::vector<char *> argv;
+    for (const std::string &arg : args) {
+        argv.push_back(const_cast<char *>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    const pid_t pid = fork();
+    if (pid < 0) {
+        return false;
+    }
+    if (pid == 0) {
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// Compile the model ahead of time into cache_dir/key.so, unless that library
+// already exists. Returns the path of the library.
+std::string compile_to_cache(
+    const HalideModel &pipeline,
+    const std::string &cache_dir,
+    const std::string &key,
+    const std::string &device) {
+    const std::string lib_path = cache_dir + "/" + key + ".so";
+    if (file_exists(lib_path)) {
+        return lib_path;
+    }
+
+    std::vector<Halide::Argument> inputs;
+    for (const std::string &input_name : pipeline.input_names) {
+        inputs.push_back(pipeline.model->inputs.at(input_name));
+    }
+    // Build in temporary files and rename the result, so that concurrent
+    // compilations of the same model never load a partially written library.
+    const std::string tmp_path =
+        lib_path + ".tmp" + std::to_string(static_cast<long>(getpid()));
+    const std::string obj_path = tmp_path + ".o";
+    pipeline.rep->compile_to_object(
+        obj_path, inputs, "onnx_model", model_target(device));
+
+    // $CXX may hold a compiler with extra words (e.g. "ccache c++"), which
+    // are split on whitespace. The paths are passed as separate arguments.
+    const char *cxx = getenv("CXX");
+    std::vector<std::string> args;
+    std::istringstream cxx_words(cxx ? cxx : "c++");
+    for (std::string word; cxx_words >> word;) {
+        args.push_back(word);
+    }
+    if (args.empty()) {
+        args.push_back("c++");
+    }
+    for (const std::string &arg : {std::string("-shared"), std::string("-o"), tmp_path,
+                                   obj_path, std::string("-ldl"), std::string("-lpthread")}) {
+        args.push_back(arg);
+    }
+    const bool built = run_command(args);
+    std::remove(obj_path.c_str());
+    if (!built || std::rename(tmp_path.c_str(), lib_path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        std::string cmd;
+        for (const std::string &arg : args) {
+            cmd += (cmd.empty() ? "" : " ") + arg;
+        }
+        throw std::runtime_error("Failed to build " + lib_path + " with: " + cmd);
+    }
+    return lib_path;
+}
+
+// Load a model previously compiled by compile_to_cache. Returns false if
+// there is no library for the given key.
+bool load_from_cache(
+    HalideModel &pipeline,
+    const std::string &cache_dir,
+    const std::string &key) {
+    const std::string lib_path = cache_dir + "/" + key + ".so";
+    if (!file_exists(lib_path)) {
+        return false;
+    }
+    auto compiled = std::make_shared<CompiledModel>();
+    compiled->lib_handle = dlopen(lib_path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!compiled->lib_handle) {
+        throw std::runtime_error("Failed to load " + lib_path + ": " + dlerror());
+    }
+    compiled->argv_fn = reinterpret_cast<int (*)(void **)>(
+        dlsym(compiled->lib_handle, "onnx_model_argv"));
+    if (!compiled->argv_fn) {
+        throw std::runtime_error("No model entry point in " + lib_path);
+    }
+    pipeline.compiled = compiled;
+    return true;
+}
+
 void print_loop_nest(const HalideModel &pipeline) {
     pipeline.rep->print_loop_nest();
 }
@@ -563,6 +736,22 @@ PYBIND11_MODULE(model_cpp, m) {
     m.def("Run", &run, "A function to JIT compile and run HalideModel.");
     m.def("Benchmark", &benchmark, "A function to benchmark the model");
     m.def("Compile", &compile, "Compile the pipeline");
+    m.def(
+        "TargetString",
+        &target_string,
+        "The target the model is compiled for on the given device");
+    m.def(
+        "HalideBuildId",
+        &halide_build_id,
+        "Identifies the builds of Halide and of this module, for cache keys");
+    m.def(
+        "CompileToCache",
+        &compile_to_cache,
+        "Compile the model ahead of time into a shared library in the cache");
+    m.def(
+        "LoadFromCache",
+        &load_from_cache,
+        "Load a model previously compiled with CompileToCache");
     m.def(
         "PrintLoopNest",
         &print_loop_nest,
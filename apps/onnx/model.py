@@ -1,9 +1,16 @@
+import hashlib
+import os
+
 import model_cpp
 
 
 class Model():
     def __init__(self):
         self.pipeline = None
+        self.model_hash = None
+        # How the pipeline is scheduled: 'default' until OptimizeSchedule
+        # runs the autoscheduler, 'auto' after.
+        self.schedule = 'default'
 
     def BuildFromOnnxModel(self, onnx_model, expected_dim_sizes=None,
                            layout=model_cpp.Layout.NumPy):
@@ -12,22 +19,67 @@ class Model():
             expected_dim_sizes = {}
 
         if type(onnx_model) is str:
-            onnx_model = onnx_model.encode()
-            self.pipeline = model_cpp.ConvertOnnxModel(onnx_model,
-                expected_dim_sizes, layout)
+            model_str = onnx_model.encode()
         elif type(onnx_model) is bytes:
-            self.pipeline = model_cpp.ConvertOnnxModel(onnx_model,
-                expected_dim_sizes, layout)
+            model_str = onnx_model
         else:
             # protobuf don't support swig, so we have to convert them to string.
             model_str = onnx_model.SerializeToString()
-            self.pipeline = model_cpp.ConvertOnnxModel(model_str,
-                expected_dim_sizes, layout)
+        self.pipeline = model_cpp.ConvertOnnxModel(model_str,
+            expected_dim_sizes, layout)
+        self.schedule = 'default'
+
+        h = hashlib.sha256(model_str)
+        h.update(repr(sorted(expected_dim_sizes.items())).encode())
+        h.update(str(layout).encode())
+        self.model_hash = h.hexdigest()
+
+    def CacheKey(self, device='', schedule=None):
+        """Name of the compiled model in a cache directory. It depends on the
+        model, the expected input shapes, the layout, the schedule, the target
+        and the builds of Halide and of the converter. The schedule defaults
+        to the current one of the model ('default' or 'auto'); the
+        autoscheduler is deterministic for a given model, target and build,
+        so its name identifies the schedule it produces."""
+        if not self.pipeline:
+            raise Exception("model not initialized, call BuildFromOnnxModel first")
+        h = hashlib.sha256(self.model_hash.encode())
+        h.update((schedule or self.schedule).encode())
+        h.update(model_cpp.TargetString(device).encode())
+        h.update(model_cpp.HalideBuildId().encode())
+        return h.hexdigest()
+
+    def LoadFromCache(self, cache_dir, device='', schedule=None):
+        """Load the model from a library previously built by CompileToCache,
+        which makes the pipeline run without being JIT compiled. Returns False
+        if the cache has no library for this model.
+
+        Passing schedule='auto' looks for a library compiled after
+        OptimizeSchedule, so that a hit also skips the autoscheduler; the
+        model then counts as scheduled. A hit doesn't skip the conversion
+        done by BuildFromOnnxModel, which still JIT compiles the constant
+        subgraphs of the model to fold them."""
+        schedule = schedule or self.schedule
+        if not model_cpp.LoadFromCache(self.pipeline, cache_dir,
+                                       self.CacheKey(device, schedule)):
+            return False
+        self.schedule = schedule
+        return True
+
+    def CompileToCache(self, cache_dir, device=''):
+        """Compile the model, with its current schedule, into a shared library
+        in cache_dir and load it."""
+        os.makedirs(cache_dir, exist_ok=True)
+        key = self.CacheKey(device)
+        model_cpp.CompileToCache(self.pipeline, cache_dir, key, device)
+        return model_cpp.LoadFromCache(self.pipeline, cache_dir, key)
 
     def OptimizeSchedule(self):
         if not self.pipeline:
             raise Exception("model not initialized, call BuildFromOnnxModel first")
-        return model_cpp.AutoSchedule(self.pipeline)
+        schedule = model_cpp.AutoSchedule(self.pipeline)
+        self.schedule = 'auto'
+        return schedule
 
     def run(self, inputs, device=''):
         if not self.pipeline:
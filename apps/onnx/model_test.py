@@ -1,3 +1,5 @@
+import os
+import tempfile
 import unittest
 from model import Model
 from onnx import helper
@@ -117,3 +119,52 @@ class ModelTest(unittest.TestCase):
         outputs = model.run([input_data])
         self.assertEqual(6, outputs[0])
         self.assertAlmostEqual(3.14, outputs[1])
+
+    def test_compiled_model_cache(self):
+        X = helper.make_tensor_value_info('X', TensorProto.FLOAT, [4, 3])
+        Y = helper.make_tensor_value_info('Y', TensorProto.FLOAT, [4, 3])
+        node_def = helper.make_node('Relu', ['X'], ['Y'])
+        graph_def = helper.make_graph([node_def], "cache-model", [X], [Y])
+        onnx_model = helper.make_model(graph_def,
+                                       producer_name='onnx-example')
+
+        with tempfile.TemporaryDirectory() as cache_dir:
+            model = Model()
+            model.BuildFromOnnxModel(onnx_model)
+            self.assertFalse(model.LoadFromCache(cache_dir))
+            self.assertTrue(model.CompileToCache(cache_dir))
+
+            # A new instance of the same model is loaded from the cache.
+            cached = Model()
+            cached.BuildFromOnnxModel(onnx_model)
+            self.assertTrue(cached.LoadFromCache(cache_dir))
+
+            input_data = np.random.rand(4, 3).astype(np.float32) - 0.5
+            outputs = cached.run([input_data])
+            np.testing.assert_allclose(np.maximum(input_data, 0), outputs[0])
+
+            # Changing the expected input shapes changes the cache key.
+            other = Model()
+            other.BuildFromOnnxModel(onnx_model, {'X': 4})
+            self.assertFalse(other.LoadFromCache(cache_dir))
+
+            # So does autoscheduling the model.
+            scheduled = Model()
+            scheduled.BuildFromOnnxModel(onnx_model)
+            self.assertFalse(scheduled.LoadFromCache(cache_dir, schedule='auto'))
+            scheduled.OptimizeSchedule()
+            self.assertNotEqual(model.CacheKey(), scheduled.CacheKey())
+            self.assertTrue(scheduled.CompileToCache(cache_dir))
+            rescheduled = Model()
+            rescheduled.BuildFromOnnxModel(onnx_model)
+            self.assertTrue(rescheduled.LoadFromCache(cache_dir, schedule='auto'))
+            self.assertEqual(scheduled.CacheKey(), rescheduled.CacheKey())
+
+        # The cache directory is passed to the linker verbatim, so paths that
+        # a shell would split or expand work too.
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            cache_dir = os.path.join(tmp_dir, "model cache 'q' $(x);")
+            model = Model()
+            model.BuildFromOnnxModel(onnx_model)
+            self.assertTrue(model.CompileToCache(cache_dir))
+            self.assertEqual(1, len(os.listdir(cache_dir)))
@@ -1,5 +1,7 @@
 #include "onnx_converter.h"
 #include <climits>
+#include <cmath>
+#include <cstring>
 #include <exception>
 #include <math.h>
 #include <unordered_set>
@@ -88,31 +90,150 @@ Halide::Func func_for_node_output(const onnx::NodeProto &node, int output_id) {
     return Halide::Func(sanitize_name(node.output(output_id)));
 }
 
-static void convert_subgraph(
-    const onnx::GraphProto &graph,
+// Returns true if the outputs of the node can be computed once at conversion
+// time, i.e. if the node is deterministic and all its inputs are constants.
+static bool is_foldable_node(
+    const onnx::NodeProto &node,
+    const std::unordered_set<std::string> &constants) {
+    if (node.input_size() == 0 || node.op_type() == "Multinomial" ||
+        node.op_type().compare(0, 6, "Random") == 0) {
+        return false;
+    }
+    for (const std::string &input_name : node.input()) {
+        if (!input_name.empty() && constants.count(input_name) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Returns the sizes of a tensor, or false if its shape isn't constant.
+static bool get_constant_sizes(const Tensor &t, std::vector<int> *sizes) {
+    for (const Halide::Expr &dim : t.shape) {
+        const int64_t *dim_value = Halide::Internal::as_const_int(dim);
+        if (!dim_value) {
+            return false;
+        }
+        sizes->push_back(static_cast<int>(*dim_value));
+    }
+    return true;
+}
+
+static void convert_graph_node(
+    const onnx::NodeProto &node,
     std::unordered_map<std::string, Tensor> &reps,
-    std::vector<Halide::Expr> &requirements) {
-    // The nodes are always stored in topological order in the ONNX model.
-    for (const onnx::NodeProto &node : graph.node()) {
-        std::vector<Tensor> inputs;
-        for (const std::string &input_name : node.input()) {
-            if (input_name.empty()) {
-                inputs.push_back(Tensor());
-            } else {
-                inputs.push_back(reps.at(input_name));
+    std::vector<Halide::Expr> &requirements,
+    std::vector<std::string> *outputs = nullptr) {
+    std::vector<Tensor> inputs;
+    for (const std::string &input_name : node.input()) {
+        if (input_name.empty()) {
+            inputs.push_back(Tensor());
+        } else {
+            inputs.push_back(reps.at(input_name));
+        }
+    }
+    Node n = convert_node(node, inputs);
+    for (int i = 0; i < node.output_size(); ++i) {
+        const std::string &output_name = node.output(i);
+        if (!output_name.empty()) {
+            reps[output_name] = n.outputs[i];
+            if (outputs) {
+                outputs->push_back(output_name);
             }
         }
-        Node n = convert_node(node, inputs);
+    }
+    for (int i = 0; i < n.requirements.size(); ++i) {
+        requirements.push_back(n.requirements[i]);
+    }
+}
 
-        for (int i = 0; i < node.output_size(); ++i) {
-            const std::string &output_name = node.output(i);
-            if (!output_name.empty()) {
-                const Tensor &output_val = n.outputs[i];
-                reps[output_name] = output_val;
+// Nodes that only depend on constants (typically reshapes or transpositions
+// of weights) are evaluated once here instead of being recomputed every time
+// the model runs. Their outputs that are used by the rest of the graph are
+// realized together by a single pipeline, so folding costs one compilation
+// no matter how many nodes are folded, and replaced by the resulting
+// buffers. Marks the nodes that were converted in converted.
+static void fold_constant_nodes(
+    const onnx::GraphProto &graph,
+    std::unordered_map<std::string, Tensor> &reps,
+    std::vector<Halide::Expr> &requirements,
+    std::unordered_set<std::string> &constants,
+    std::vector<bool> *converted) {
+    std::vector<std::string> folded_outputs;
+    for (int i = 0; i < graph.node_size(); ++i) {
+        const onnx::NodeProto &node = graph.node(i);
+        const bool is_constant = node.op_type() == "Constant";
+        if (!is_constant && !is_foldable_node(node, constants)) {
+            continue;
+        }
+        std::vector<std::string> outputs;
+        convert_graph_node(node, reps, requirements, &outputs);
+        for (const std::string &output_name : outputs) {
+            std::vector<int> sizes;
+            if (is_constant) {
+                constants.insert(output_name);
+            } else if (get_constant_sizes(reps.at(output_name), &sizes)) {
+                constants.insert(output_name);
+                folded_outputs.push_back(output_name);
             }
         }
-        for (int i = 0; i < n.requirements.size(); ++i) {
-            requirements.push_back(n.requirements[i]);
+        (*converted)[i] = true;
+    }
+
+    // Only the folded tensors that are used outside of the constant subgraph
+    // need to be realized, the others are computed once along the way.
+    for (const std::string &name : folded_outputs) {
+        reps.at(name).rep.compute_root();
+    }
+    std::unordered_set<std::string> used;
+    for (int i = 0; i < graph.node_size(); ++i) {
+        if (!(*converted)[i]) {
+            used.insert(graph.node(i).input().begin(), graph.node(i).input().end());
+        }
+    }
+    for (const auto &output : graph.output()) {
+        used.insert(output.name());
+    }
+
+    std::vector<std::string> names;
+    std::vector<Halide::Func> funcs;
+    std::vector<Halide::Buffer<>> buffers;
+    for (const std::string &name : folded_outputs) {
+        if (used.count(name) == 0) {
+            continue;
+        }
+        const Tensor &t = reps.at(name);
+        std::vector<int> sizes;
+        get_constant_sizes(t, &sizes);
+        names.push_back(name);
+        funcs.push_back(t.rep);
+        buffers.emplace_back(t.rep.output_types()[0], sizes);
+    }
+    if (funcs.empty()) {
+        return;
+    }
+    Halide::Pipeline(funcs).realize(Halide::Realization(buffers));
+    for (size_t i = 0; i < names.size(); ++i) {
+        Tensor &t = reps.at(names[i]);
+        Halide::Func folded(t.rep.name() + "_folded");
+        folded(Halide::_) = buffers[i](Halide::_);
+        t.rep = folded;
+    }
+}
+
+static void convert_subgraph(
+    const onnx::GraphProto &graph,
+    std::unordered_map<std::string, Tensor> &reps,
+    std::vector<Halide::Expr> &requirements,
+    std::unordered_set<std::string> *constants = nullptr) {
+    std::vector<bool> converted(graph.node_size(), false);
+    if (constants) {
+        fold_constant_nodes(graph, reps, requirements, *constants, &converted);
+    }
+    // The nodes are always stored in topological order in the ONNX model.
+    for (int i = 0; i < graph.node_size(); ++i) {
+        if (!converted[i]) {
+            convert_graph_node(graph.node(i), reps, requirements);
         }
     }
 }
@@ -1085,7 +1206,8 @@ Node convert_conv_node(
     bool can_use_winograd = false;
     bool needs_extra_padding = false;
     int m[2] = {2, 2};
-    if (groups == 1 && rank == 4) {
+    // The winograd transforms aren't exact in integer arithmetic.
+    if (groups == 1 && rank == 4 && get_halide_type(X).is_float()) {
         bool supported_shape = true;
         for (int i = 2; i < rank; ++i) {
             const Halide::Expr w_shape_expr = Halide::Internal::simplify(W.shape[i]);
@@ -1168,6 +1290,337 @@ Node convert_conv_node(
     return result;
 }
 
+// Returns the value of a quantization parameter (scale or zero point) of a
+// tensor. Parameters are either scalars, or 1D tensors that hold one value per
+// index along a given axis of the quantized tensor.
+static Halide::Expr quantization_param(const Tensor &param, Halide::Expr index) {
+    if (param.shape.empty()) {
+        return param.rep();
+    }
+    return param.rep(index);
+}
+
+static bool has_optional_input(const std::vector<Tensor> &inputs, int i) {
+    return inputs.size() > i && inputs[i].rep.defined();
+}
+
+// Subtract the zero point from a quantized tensor, widening the result to
+// 32 bit so that the products and sums computed from it can't overflow.
+static Tensor dequantize_to_int32(
+    const Tensor &t,
+    const std::vector<Tensor> &inputs,
+    int zero_point_input,
+    int axis,
+    const std::string &name) {
+    Tensor result;
+    result.name = name;
+    result.type = onnx::TensorProto_DataType_INT32;
+    result.shape = t.shape;
+    result.rep = Halide::Func(name);
+
+    std::vector<Halide::Var> vars(t.shape.size());
+    Halide::Expr value = Halide::cast<int32_t>(t.rep(vars));
+    if (has_optional_input(inputs, zero_point_input)) {
+        const Tensor &zero_point = inputs[zero_point_input];
+        Halide::Expr index = axis < vars.size() ? Halide::Expr(vars[axis]) : Halide::Expr(0);
+        value -= Halide::cast<int32_t>(quantization_param(zero_point, index));
+    }
+    result.rep(vars) = value;
+    return result;
+}
+
+// Compute round(value * multiplier) + zero_point, saturated to the range of
+// the given type, with ties rounded to even. When the multiplier is a constant (i.e. the scales are
+// per-tensor initializers) the multiplication is done in fixed point on the
+// 32 bit accumulator, which avoids the conversions to and from float.
+static Halide::Expr requantize(
+    Halide::Expr value,
+    Halide::Expr multiplier,
+    Halide::Expr zero_point,
+    Halide::Type type) {
+    multiplier = Halide::Internal::simplify(inline_func_call(multiplier));
+    const double *m = Halide::Internal::as_const_float(multiplier);
+    int exponent = 0;
+    const double mantissa = m ? std::frexp(*m, &exponent) : 0.0;
+    Halide::Expr scaled;
+    if (m && *m > 0 && exponent <= 0 && exponent > -31) {
+        // multiplier = mantissa * 2^exponent, with mantissa in [0.5, 1)
+        // represented as a Q31 fixed point value.
+        int64_t q = static_cast<int64_t>(std::round(mantissa * (1ll << 31)));
+        if (q == (1ll << 31)) {
+            q /= 2;
+            exponent += 1;
+        }
+        const int shift = 31 - exponent;
+        // Round to nearest with ties to even, like the float path: add
+        // just under one half, plus one more when the truncated quotient
+        // is odd, so that only ties with an odd quotient round up.
+        Halide::Expr product = Halide::cast<int64_t>(value) * Halide::Expr(q);
+        Halide::Expr odd = (product >> shift) & Halide::Expr(int64_t(1));
+        Halide::Expr bias = (Halide::Expr(int64_t(1)) << (shift - 1)) - Halide::Expr(int64_t(1)) + odd;
+        scaled = Halide::cast<int32_t>((product + bias) >> shift);
+    } else {
+        scaled = Halide::cast<int32_t>(
+            Halide::round(Halide::cast<float>(value) * Halide::cast<float>(multiplier)));
+    }
+    scaled += Halide::cast<int32_t>(zero_point);
+    return Halide::saturating_cast(type, scaled);
+}
+
+Node convert_quantize_linear_node(
+    const onnx::NodeProto &node,
+    const std::vector<Tensor> &inputs) {
+    if (inputs.size() < 2 || inputs.size() > 3) {
+        throw std::invalid_argument(
+            "QuantizeLinear requires 2 or 3 inputs, but node " + node.name() +
+            " has " + std::to_string(inputs.size()));
+    }
+    const Tensor &x = inputs[0];
+    const Tensor &scale = inputs[1];
+    const bool has_zero_point = has_optional_input(inputs, 2);
+
+    int axis = 1;
+    for (const auto &attr : node.attribute()) {
+        if (attr.name() == "axis") {
+            axis = attr.i();
+        }
+    }
+    const int rank = x.shape.size();
+    if (axis < 0) {
+        axis += rank;
+    }
+
+    Node result;
+    result.inputs = inputs;
+    result.outputs.resize(1);
+    Tensor &out = result.outputs[0];
+    out.shape = x.shape;
+    out.type = has_zero_point ? inputs[2].type : onnx::TensorProto_DataType_UINT8;
+    out.rep = func_for_node_output(node, 0);
+
+    std::vector<Halide::Var> vars(rank);
+    Halide::Expr index = axis < rank ? Halide::Expr(vars[axis]) : Halide::Expr(0);
+    Halide::Expr scaled = Halide::round(
+        Halide::cast<float>(x.rep(vars)) / quantization_param(scale, index));
+    if (has_zero_point) {
+        scaled += Halide::cast<float>(quantization_param(inputs[2], index));
+    }
+    out.rep(vars) = Halide::saturating_cast(get_halide_type(out), scaled);
+    return result;
+}
+
+Node convert_dequantize_linear_node(
+    const onnx::NodeProto &node,
+    const std::vector<Tensor> &inputs) {
+    if (inputs.size() < 2 || inputs.size() > 3) {
+        throw std::invalid_argument(
+            "DequantizeLinear requires 2 or 3 inputs, but node " + node.name() +
+            " has " + std::to_string(inputs.size()));
+    }
+    const Tensor &x = inputs[0];
+    const Tensor &scale = inputs[1];
+
+    int axis = 1;
+    for (const auto &attr : node.attribute()) {
+        if (attr.name() == "axis") {
+            axis = attr.i();
+        }
+    }
+    const int rank = x.shape.size();
+    if (axis < 0) {
+        axis += rank;
+    }
+
+    Node result;
+    result.inputs = inputs;
+    result.outputs.resize(1);
+    Tensor &out = result.outputs[0];
+    out.shape = x.shape;
+    out.type = onnx::TensorProto_DataType_FLOAT;
+    out.rep = func_for_node_output(node, 0);
+
+    const Tensor x_int = dequantize_to_int32(
+        x, inputs, 2, axis, out.rep.name() + "_int");
+    std::vector<Halide::Var> vars(rank);
+    Halide::Expr index = axis < rank ? Halide::Expr(vars[axis]) : Halide::Expr(0);
+    out.rep(vars) = Halide::cast<float>(x_int.rep(vars)) *
+                    quantization_param(scale, index);
+    return result;
+}
+
+// Convert a ConvInteger or QLinearConv node into a convolution of the int32
+// inputs, with their zero points already subtracted.
+static Node convert_integer_conv(
+    const onnx::NodeProto &node,
+    const Tensor &x,
+    const Tensor &w,
+    const std::vector<Tensor> &inputs,
+    int x_zero_point,
+    int w_zero_point,
+    const Tensor *bias) {
+    onnx::NodeProto conv_node = node;
+    conv_node.set_op_type("Conv");
+    conv_node.clear_input();
+    conv_node.clear_output();
+    conv_node.add_output(node.output(0) + "_acc");
+
+    const std::string name = name_for_node(node, "");
+    std::vector<Tensor> conv_inputs;
+    conv_inputs.push_back(dequantize_to_int32(
+        x, inputs, x_zero_point, 0, name + "_x_int"));
+    conv_inputs.push_back(dequantize_to_int32(
+        w, inputs, w_zero_point, 0, name + "_w_int"));
+    if (bias) {
+        conv_inputs.push_back(*bias);
+    }
+    return convert_conv_node(conv_node, conv_inputs);
+}
+
+Node convert_conv_integer_node(
+    const onnx::NodeProto &node,
+    const std::vector<Tensor> &inputs) {
+    if (inputs.size() < 2 || inputs.size() > 4) {
+        throw std::invalid_argument(
+            "ConvInteger requires 2 to 4 inputs, but node " + node.name() +
+            " has " + std::to_string(inputs.size()));
+    }
+    Node conv = convert_integer_conv(node, inputs[0], inputs[1], inputs, 2, 3, nullptr);
+
+    Node result;
+    result.inputs = inputs;
+    result.requirements = conv.requirements;
+    result.outputs.resize(1);
+    Tensor &out = result.outputs[0];
+    out.shape = conv.outputs[0].shape;
+    out.type = onnx::TensorProto_DataType_INT32;
+    out.rep = func_for_node_output(node, 0);
+    out.rep(Halide::_) = conv.outputs[0].rep(Halide::_);
+    return result;
+}
+
+Node convert_qlinear_conv_node(
+    const onnx::NodeProto &node,
+    const std::vector<Tensor> &inputs) {
+    if (inputs.size() < 8 || inputs.size() > 9) {
+        throw std::invalid_argument(
+            "QLinearConv requires 8 or 9 inputs, but node " + node.name() +
+            " has " + std::to_string(inputs.size()));
+    }
+    const Tensor &x_scale = inputs[1];
+    const Tensor &w_scale = inputs[4];
+    const Tensor &y_scale = inputs[6];
+    const Tensor &y_zero_point = inputs[7];
+    const Tensor *bias = has_optional_input(inputs, 8) ? &inputs[8] : nullptr;
+    Node conv = convert_integer_conv(node, inputs[0], inputs[3], inputs, 2, 5, bias);
+
+    Node result;
+    result.inputs = inputs;
+    result.requirements = conv.requirements;
+    result.outputs.resize(1);
+    Tensor &out = result.outputs[0];
+    out.shape = conv.outputs[0].shape;
+    out.type = y_zero_point.type;
+    out.rep = func_for_node_output(node, 0);
+
+    // The weights may be quantized per output channel.
+    std::vector<Halide::Var> vars(out.shape.size());
+    Halide::Expr multiplier = quantization_param(x_scale, 0) *
+                              quantization_param(w_scale, vars[1]) /
+                              quantization_param(y_scale, 0);
+    out.rep(vars) = requantize(
+        conv.outputs[0].rep(vars), multiplier,
+        quantization_param(y_zero_point, 0), get_halide_type(out));
+    return result;
+}
+
+// Convert a MatMulInteger or QLinearMatMul node into a matrix multiplication
+// of the int32 inputs, with their zero points already subtracted.
+static Node convert_integer_matmul(
+    const onnx::NodeProto &node,
+    const Tensor &a,
+    const Tensor &b,
+    const std::vector<Tensor> &inputs,
+    int a_zero_point,
+    int b_zero_point) {
+    onnx::NodeProto matmul_node = node;
+    matmul_node.set_op_type("MatMul");
+    matmul_node.clear_input();
+    matmul_node.clear_output();
+    matmul_node.add_output(node.output(0) + "_acc");
+
+    // The zero point of A may be specified per row, and the one of B per
+    // column.
+    const std::string name = name_for_node(node, "");
+    const int a_rank = a.shape.size();
+    const int b_rank = b.shape.size();
+    std::vector<Tensor> matmul_inputs;
+    matmul_inputs.push_back(dequantize_to_int32(
+        a, inputs, a_zero_point, std::max(a_rank - 2, 0), name + "_a_int"));
+    matmul_inputs.push_back(dequantize_to_int32(
+        b, inputs, b_zero_point, b_rank - 1, name + "_b_int"));
+    return convert_matmul_node(matmul_node, matmul_inputs);
+}
+
+Node convert_matmul_integer_node(
+    const onnx::NodeProto &node,
+    const std::vector<Tensor> &inputs) {
+    if (inputs.size() < 2 || inputs.size() > 4) {
+        throw std::invalid_argument(
+            "MatMulInteger requires 2 to 4 inputs, but node " + node.name() +
+            " has " + std::to_string(inputs.size()));
+    }
+    Node matmul = convert_integer_matmul(node, inputs[0], inputs[1], inputs, 2, 3);
+
+    Node result;
+    result.inputs = inputs;
+    result.requirements = matmul.requirements;
+    result.outputs.resize(1);
+    Tensor &out = result.outputs[0];
+    out.shape = matmul.outputs[0].shape;
+    out.type = onnx::TensorProto_DataType_INT32;
+    out.rep = func_for_node_output(node, 0);
+    out.rep(Halide::_) = matmul.outputs[0].rep(Halide::_);
+    return result;
+}
+
+Node convert_qlinear_matmul_node(
+    const onnx::NodeProto &node,
+    const std::vector<Tensor> &inputs) {
+    if (inputs.size() != 8) {
+        throw std::invalid_argument(
+            "QLinearMatMul requires 8 inputs, but node " + node.name() +
+            " has " + std::to_string(inputs.size()));
+    }
+    const Tensor &a_scale = inputs[1];
+    const Tensor &b_scale = inputs[4];
+    const Tensor &y_scale = inputs[6];
+    const Tensor &y_zero_point = inputs[7];
+    Node matmul = convert_integer_matmul(node, inputs[0], inputs[3], inputs, 2, 5);
+
+    Node result;
+    result.inputs = inputs;
+    result.requirements = matmul.requirements;
+    result.outputs.resize(1);
+    Tensor &out = result.outputs[0];
+    out.shape = matmul.outputs[0].shape;
+    out.type = y_zero_point.type;
+    out.rep = func_for_node_output(node, 0);
+
+    // The scales follow the same per row and per column layout as the zero
+    // points.
+    const int rank = out.shape.size();
+    std::vector<Halide::Var> vars(rank);
+    Halide::Expr row = rank >= 2 ? Halide::Expr(vars[rank - 2]) : Halide::Expr(0);
+    Halide::Expr col = rank >= 1 ? Halide::Expr(vars[rank - 1]) : Halide::Expr(0);
+    Halide::Expr multiplier = quantization_param(a_scale, row) *
+                              quantization_param(b_scale, col) /
+                              quantization_param(y_scale, 0);
+    out.rep(vars) = requantize(
+        matmul.outputs[0].rep(vars), multiplier,
+        quantization_param(y_zero_point, 0), get_halide_type(out));
+    return result;
+}
+
 Node convert_reduction_node(
     const onnx::NodeProto &node,
     const std::vector<Tensor> &inputs) {
@@ -4351,6 +4804,24 @@ Node convert_node(
     if (node.op_type() == "Conv") {
         return convert_conv_node(node, inputs);
     }
+    if (node.op_type() == "QuantizeLinear") {
+        return convert_quantize_linear_node(node, inputs);
+    }
+    if (node.op_type() == "DequantizeLinear") {
+        return convert_dequantize_linear_node(node, inputs);
+    }
+    if (node.op_type() == "ConvInteger") {
+        return convert_conv_integer_node(node, inputs);
+    }
+    if (node.op_type() == "QLinearConv") {
+        return convert_qlinear_conv_node(node, inputs);
+    }
+    if (node.op_type() == "MatMulInteger") {
+        return convert_matmul_integer_node(node, inputs);
+    }
+    if (node.op_type() == "QLinearMatMul") {
+        return convert_qlinear_matmul_node(node, inputs);
+    }
     if (node.op_type().find("Reduce") == 0) {
         return convert_reduction_node(node, inputs);
     }
@@ -4635,23 +5106,338 @@ std::vector<Halide::Expr> finalize_type_info(
     return result;
 }
 
+namespace {
+
+// Graph level rewrites applied before the conversion to Halide. They fold
+// affine layers whose parameters are all initializers into the weights of the
+// preceding Conv or Gemm node, so that the converted pipeline doesn't
+// evaluate them (and store the intermediate results) at runtime. Elementwise
+// nodes such as Relu don't need any special handling since the Funcs they're
+// converted into are inlined into their consumers by default.
+class GraphOptimizer {
+public:
+    explicit GraphOptimizer(onnx::GraphProto *graph)
+        : graph_(graph) {
+        for (int i = 0; i < graph_->initializer_size(); ++i) {
+            initializers_[graph_->initializer(i).name()] = i;
+        }
+        for (const auto &output : graph_->output()) {
+            ++num_uses_[output.name()];
+        }
+        count_uses(*graph_);
+    }
+
+    void run() {
+        std::vector<bool> removed(graph_->node_size(), false);
+        for (int i = 0; i < graph_->node_size(); ++i) {
+            onnx::NodeProto *node = graph_->mutable_node(i);
+            if (removed[i] || node->output_size() != 1) {
+                continue;
+            }
+            const int consumer = find_single_consumer(i);
+            if (consumer < 0) {
+                continue;
+            }
+            const onnx::NodeProto &next = graph_->node(consumer);
+            bool folded = false;
+            if (node->op_type() == "Conv" && next.op_type() == "BatchNormalization") {
+                folded = fold_batchnorm_into_conv(node, next);
+            } else if (node->op_type() == "Gemm" && next.op_type() == "Add") {
+                folded = fold_add_into_gemm(node, next);
+            }
+            if (folded) {
+                for (const auto &input_name : next.input()) {
+                    release_use(input_name);
+                }
+                node->set_output(0, next.output(0));
+                removed[consumer] = true;
+                // The node may now be fusable with its new consumer.
+                --i;
+            }
+        }
+
+        google::protobuf::RepeatedPtrField<onnx::NodeProto> nodes;
+        nodes.Swap(graph_->mutable_node());
+        for (int i = 0; i < nodes.size(); ++i) {
+            if (!removed[i]) {
+                graph_->add_node()->Swap(nodes.Mutable(i));
+            }
+        }
+
+        remove_dead_initializers();
+    }
+
+private:
+    // Count the uses of every value by the nodes of a graph, including the
+    // nodes of its subgraphs, which may refer to values of the outer graph.
+    void count_uses(const onnx::GraphProto &graph) {
+        for (const auto &node : graph.node()) {
+            for (const auto &input_name : node.input()) {
+                ++num_uses_[input_name];
+            }
+            for (const auto &attr : node.attribute()) {
+                if (attr.has_g()) {
+                    count_uses(attr.g());
+                }
+                for (const auto &g : attr.graphs()) {
+                    count_uses(g);
+                }
+            }
+        }
+    }
+
+    // Record that one use of the named value went away. If it was the last
+    // use of an initializer, that initializer is dropped at the end of run().
+    void release_use(const std::string &name) {
+        auto it = num_uses_.find(name);
+        if (it != num_uses_.end() && --it->second == 0 && initializers_.count(name)) {
+            dead_initializers_.insert(name);
+        }
+    }
+
+    // Replace input i of a node, keeping the use counts up to date.
+    void set_input(onnx::NodeProto *node, int i, const std::string &name) {
+        release_use(node->input(i));
+        node->set_input(i, name);
+    }
+
+    // Remove the initializers (and any graph inputs naming them) whose uses
+    // were all folded away, so that the converter doesn't embed both the
+    // original and the folded weights.
+    void remove_dead_initializers() {
+        if (dead_initializers_.empty()) {
+            return;
+        }
+        google::protobuf::RepeatedPtrField<onnx::TensorProto> initializers;
+        initializers.Swap(graph_->mutable_initializer());
+        for (int i = 0; i < initializers.size(); ++i) {
+            if (!dead_initializers_.count(initializers.Get(i).name())) {
+                graph_->add_initializer()->Swap(initializers.Mutable(i));
+            }
+        }
+        google::protobuf::RepeatedPtrField<onnx::ValueInfoProto> inputs;
+        inputs.Swap(graph_->mutable_input());
+        for (int i = 0; i < inputs.size(); ++i) {
+            if (!dead_initializers_.count(inputs.Get(i).name())) {
+                graph_->add_input()->Swap(inputs.Mutable(i));
+            }
+        }
+        initializers_.clear();
+        for (int i = 0; i < graph_->initializer_size(); ++i) {
+            initializers_[graph_->initializer(i).name()] = i;
+        }
+        dead_initializers_.clear();
+    }
+
+    // Returns the index of the only node that uses the output of the node at
+    // index i, or -1 if there isn't exactly one such node, or if the output is
+    // also an output of the graph.
+    int find_single_consumer(int i) const {
+        const std::string &output_name = graph_->node(i).output(0);
+        auto it = num_uses_.find(output_name);
+        if (it == num_uses_.end() || it->second != 1) {
+            return -1;
+        }
+        for (int j = i + 1; j < graph_->node_size(); ++j) {
+            for (const auto &input_name : graph_->node(j).input()) {
+                if (input_name == output_name) {
+                    return j;
+                }
+            }
+        }
+        return -1;
+    }
+
+    const onnx::TensorProto *find_initializer(const std::string &name) const {
+        auto it = initializers_.find(name);
+        if (it == initializers_.end()) {
+            return nullptr;
+        }
+        return &graph_->initializer(it->second);
+    }
+
+    // Extract the values of a float initializer. Returns false if the
+    // initializer doesn't exist or isn't a float tensor.
+    bool get_float_values(const std::string &name, std::vector<float> *vals) const {
+        const onnx::TensorProto *t = find_initializer(name);
+        if (!t || t->data_type() != onnx::TensorProto_DataType_FLOAT) {
+            return false;
+        }
+        int64_t num_elements = 1;
+        for (int64_t dim : t->dims()) {
+            num_elements *= dim;
+        }
+        if (t->float_data_size() > 0) {
+            vals->assign(t->float_data().begin(), t->float_data().end());
+        } else {
+            vals->resize(t->raw_data().size() / sizeof(float));
+            memcpy(vals->data(), t->raw_data().data(), vals->size() * sizeof(float));
+        }
+        return static_cast<int64_t>(vals->size()) == num_elements;
+    }
+
+    std::string add_float_initializer(
+        const std::string &name,
+        const std::vector<int64_t> &dims,
+        const std::vector<float> &vals) {
+        std::string unique_name = name;
+        for (int i = 0; initializers_.count(unique_name) || num_uses_.count(unique_name); ++i) {
+            unique_name = name + "_" + std::to_string(i);
+        }
+        onnx::TensorProto *t = graph_->add_initializer();
+        t->set_name(unique_name);
+        t->set_data_type(onnx::TensorProto_DataType_FLOAT);
+        for (int64_t dim : dims) {
+            t->add_dims(dim);
+        }
+        for (float v : vals) {
+            t->add_float_data(v);
+        }
+        initializers_[unique_name] = graph_->initializer_size() - 1;
+        num_uses_[unique_name] = 1;
+        return unique_name;
+    }
+
+    // BatchNormalization(Conv(X, W, B)) = Conv(X, W * s, (B - mean) * s + shift)
+    // where s = scale / sqrt(variance + epsilon), applied per output channel.
+    bool fold_batchnorm_into_conv(onnx::NodeProto *conv, const onnx::NodeProto &bn) {
+        if (bn.input_size() != 5 || bn.output_size() != 1 || conv->input_size() < 2) {
+            return false;
+        }
+        float epsilon = 1e-5f;
+        for (const auto &attr : bn.attribute()) {
+            if (attr.name() == "spatial" && !attr.i()) {
+                return false;
+            }
+            if (attr.name() == "epsilon") {
+                epsilon = attr.f();
+            }
+        }
+
+        std::vector<float> weights, scale, shift, mean, variance;
+        if (!get_float_values(conv->input(1), &weights) ||
+            !get_float_values(bn.input(1), &scale) ||
+            !get_float_values(bn.input(2), &shift) ||
+            !get_float_values(bn.input(3), &mean) ||
+            !get_float_values(bn.input(4), &variance)) {
+            return false;
+        }
+        const onnx::TensorProto *w = find_initializer(conv->input(1));
+        const size_t num_channels = w->dims_size() > 0 ? w->dims(0) : 0;
+        if (num_channels == 0 || scale.size() != num_channels ||
+            shift.size() != num_channels || mean.size() != num_channels ||
+            variance.size() != num_channels) {
+            return false;
+        }
+        std::vector<float> bias(num_channels, 0.0f);
+        if (conv->input_size() > 2 && !conv->input(2).empty()) {
+            if (!get_float_values(conv->input(2), &bias) ||
+                bias.size() != num_channels) {
+                return false;
+            }
+        }
+
+        const size_t channel_size = weights.size() / num_channels;
+        for (size_t c = 0; c < num_channels; ++c) {
+            const float s = scale[c] / std::sqrt(variance[c] + epsilon);
+            for (size_t i = 0; i < channel_size; ++i) {
+                weights[c * channel_size + i] *= s;
+            }
+            bias[c] = (bias[c] - mean[c]) * s + shift[c];
+        }
+
+        std::vector<int64_t> weight_dims(w->dims().begin(), w->dims().end());
+        const std::string weight_name =
+            add_float_initializer(conv->input(1) + "_bn_folded", weight_dims, weights);
+        const std::string bias_name =
+            add_float_initializer(bn.output(0) + "_bias", {static_cast<int64_t>(num_channels)}, bias);
+        set_input(conv, 1, weight_name);
+        if (conv->input_size() > 2) {
+            set_input(conv, 2, bias_name);
+        } else {
+            conv->add_input(bias_name);
+        }
+        return true;
+    }
+
+    // Add(Gemm(A, B), C) = Gemm(A, B, C) when C is a constant row vector (or
+    // scalar), so that adding it doesn't change the shape of the result.
+    bool fold_add_into_gemm(onnx::NodeProto *gemm, const onnx::NodeProto &add) {
+        if (gemm->input_size() != 2 || add.input_size() != 2) {
+            return false;
+        }
+        const std::string &bias_name =
+            add.input(0) == gemm->output(0) ? add.input(1) : add.input(0);
+        const onnx::TensorProto *bias = find_initializer(bias_name);
+        const onnx::TensorProto *b = find_initializer(gemm->input(1));
+        if (!bias || !b || bias_name == gemm->output(0) ||
+            bias->dims_size() > 2 || b->dims_size() != 2) {
+            return false;
+        }
+        bool transposeB = false;
+        for (const auto &attr : gemm->attribute()) {
+            if (attr.name() == "transB") {
+                transposeB = attr.i();
+            }
+        }
+        const int64_t num_cols = transposeB ? b->dims(0) : b->dims(1);
+        const int rank = bias->dims_size();
+        if ((rank == 2 && bias->dims(0) != 1) ||
+            (rank > 0 && bias->dims(rank - 1) != 1 && bias->dims(rank - 1) != num_cols)) {
+            return false;
+        }
+
+        // The bias must be scaled by beta, which may have been set even though
+        // the node didn't have a bias to begin with.
+        for (int i = 0; i < gemm->attribute_size(); ++i) {
+            if (gemm->attribute(i).name() == "beta") {
+                gemm->mutable_attribute()->DeleteSubrange(i, 1);
+                break;
+            }
+        }
+        gemm->add_input(bias_name);
+        ++num_uses_[bias_name];
+        return true;
+    }
+
+    onnx::GraphProto *graph_;
+    std::unordered_map<std::string, int> initializers_;
+    std::unordered_map<std::string, int> num_uses_;
+    std::unordered_set<std::string> dead_initializers_;
+};
+
+}  // namespace
+
 Model convert_model(
     const onnx::ModelProto &model,
     const std::unordered_map<std::string, int> &expected_dim_sizes,
     IOLayout layout) {
+    onnx::ModelProto copy = model;
+    return convert_model(&copy, expected_dim_sizes, layout);
+}
+
+Model convert_model(
+    onnx::ModelProto *model,
+    const std::unordered_map<std::string, int> &expected_dim_sizes,
+    IOLayout layout) {
     Model result;
     std::unordered_map<std::string, Tensor> &reps = result.tensors;
     std::unordered_map<std::string, Halide::Internal::Dimension> symbolic_dims;
 
+    onnx::GraphProto &graph = *model->mutable_graph();
+    GraphOptimizer(&graph).run();
+
     // Encode the constants inputs.
-    for (const auto &constant : model.graph().initializer()) {
+    std::unordered_set<std::string> constants;
+    for (const auto &constant : graph.initializer()) {
         Tensor t = build_from_constant(constant, sanitize_name(constant.name()));
         reps[constant.name()] = t;
+        constants.insert(constant.name());
     }
 
     // Encode the variable inputs as Halide ImageParam. Note that constant inputs
     // can be listed here as well, so we need to filter them out.
-    for (const auto &input : model.graph().input()) {
+    for (const auto &input : graph.input()) {
         if (reps.find(input.name()) != reps.end()) {
             continue;
         }
@@ -4671,14 +5457,14 @@ Model convert_model(
                                     p};
     }
 
-    convert_subgraph(model.graph(), reps, result.requirements);
+    convert_subgraph(graph, reps, result.requirements, &constants);
 
     // Check if output tensors are also used as inputs to other nodes.
     std::unordered_map<std::string, bool> output_types;
-    for (const auto &output : model.graph().output()) {
+    for (const auto &output : graph.output()) {
         output_types.emplace(output.name(), false);
     }
-    for (const auto &node : model.graph().node()) {
+    for (const auto &node : graph.node()) {
         for (const auto &input_name : node.input()) {
             if (output_types.find(input_name) != output_types.end()) {
                 output_types[input_name] = true;
@@ -4687,7 +5473,7 @@ Model convert_model(
     }
 
     // Last but not least, extract the model outputs.
-    for (const auto &output : model.graph().output()) {
+    for (const auto &output : graph.output()) {
         if (reps.find(output.name()) == reps.end()) {
             throw std::invalid_argument(
                 "Output " + output.name() +
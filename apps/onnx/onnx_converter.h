@@ -39,6 +39,9 @@ enum IOLayout {
     NumPy = 1,
 };
 Model convert_model(const onnx::ModelProto &model, const std::unordered_map<std::string, int> &expected_dim_sizes, IOLayout layout);
+// Same as above, but rewrites the graph of the model in place (folding
+// affine layers into their producers) rather than working on a copy.
+Model convert_model(onnx::ModelProto *model, const std::unordered_map<std::string, int> &expected_dim_sizes, IOLayout layout);
 
 Halide::Type get_halide_type(const Tensor &tensor);
 
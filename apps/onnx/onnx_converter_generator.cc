@@ -25,7 +25,7 @@ public:
         }
 
         std::unordered_map<std::string, int> expected_dim_sizes;
-        converted_model_ = convert_model(onnx_model, expected_dim_sizes, IOLayout::Native);
+        converted_model_ = convert_model(&onnx_model, expected_dim_sizes, IOLayout::Native);
         for (const auto &input : converted_model_.inputs) {
             model_inputs_[input.first] = add_input<Buffer<>>(
                 input.first,
@@ -263,6 +263,103 @@ static void test_conv() {
     }
 }
 
+static void test_qlinear_matmul() {
+    onnx::NodeProto matmul_node;
+    matmul_node.set_name("qlinear_matmul_node");
+    matmul_node.set_op_type("QLinearMatMul");
+    for (const char *input : {"a", "a_scale", "a_zero_point", "b", "b_scale",
+                              "b_zero_point", "y_scale", "y_zero_point"}) {
+        matmul_node.add_input(input);
+    }
+    matmul_node.add_output("y");
+
+    std::vector<Tensor> node_inputs;
+    node_inputs.resize(8);
+    node_inputs[0].shape = {4, 16};
+    node_inputs[0].type = onnx::TensorProto_DataType_UINT8;
+    node_inputs[3].shape = {16, 8};
+    node_inputs[3].type = onnx::TensorProto_DataType_UINT8;
+    node_inputs[7].type = onnx::TensorProto_DataType_UINT8;
+
+    std::uniform_int_distribution<int> dis(0, 255);
+    std::mt19937 rnd;
+    Halide::Buffer<uint8_t> a(4, 16);
+    a.for_each_value([&](uint8_t &v) { v = dis(rnd); });
+    Halide::Buffer<uint8_t> b(16, 8);
+    b.for_each_value([&](uint8_t &v) { v = dis(rnd); });
+    Halide::Var i1, j1;
+    node_inputs[0].rep(i1, j1) = a(i1, j1);
+    Halide::Var i2, j2;
+    node_inputs[3].rep(i2, j2) = b(i2, j2);
+    node_inputs[1].rep() = 0.02f;
+    node_inputs[2].rep() = Halide::cast<uint8_t>(128);
+    node_inputs[4].rep() = 0.05f;
+    node_inputs[5].rep() = Halide::cast<uint8_t>(100);
+    node_inputs[6].rep() = 0.5f;
+    node_inputs[7].rep() = Halide::cast<uint8_t>(10);
+
+    Node converted = convert_node(matmul_node, node_inputs);
+
+    GOOGLE_CHECK_EQ(1, converted.outputs.size());
+    Halide::Buffer<uint8_t> output = converted.outputs[0].rep.realize(4, 8);
+
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            int acc = 0;
+            for (int k = 0; k < 16; ++k) {
+                acc += (a(i, k) - 128) * (b(k, j) - 100);
+            }
+            float expected = std::round(acc * 0.02f * 0.05f / 0.5f) + 10;
+            expected = std::min(std::max(expected, 0.0f), 255.0f);
+            // The requantization is done in fixed point, so allow for
+            // rounding differences.
+            EXPECT_NEAR(output(i, j), expected, 1.0f);
+        }
+    }
+}
+
+static void test_qlinear_matmul_ties() {
+    onnx::NodeProto matmul_node;
+    matmul_node.set_name("qlinear_matmul_node");
+    matmul_node.set_op_type("QLinearMatMul");
+    for (const char *input : {"a", "a_scale", "a_zero_point", "b", "b_scale",
+                              "b_zero_point", "y_scale", "y_zero_point"}) {
+        matmul_node.add_input(input);
+    }
+    matmul_node.add_output("y");
+
+    std::vector<Tensor> node_inputs;
+    node_inputs.resize(8);
+    node_inputs[0].shape = {1, 1};
+    node_inputs[0].type = onnx::TensorProto_DataType_UINT8;
+    node_inputs[3].shape = {1, 8};
+    node_inputs[3].type = onnx::TensorProto_DataType_UINT8;
+    node_inputs[7].type = onnx::TensorProto_DataType_UINT8;
+
+    // The accumulators are -4 to 3, and the combined scale is 0.5, so every
+    // other output is a tie.
+    Halide::Var i1, j1;
+    node_inputs[0].rep(i1, j1) = Halide::cast<uint8_t>(129);
+    Halide::Var i2, j2;
+    node_inputs[3].rep(i2, j2) = Halide::cast<uint8_t>(96 + j2);
+    node_inputs[1].rep() = 1.0f;
+    node_inputs[2].rep() = Halide::cast<uint8_t>(128);
+    node_inputs[4].rep() = 1.0f;
+    node_inputs[5].rep() = Halide::cast<uint8_t>(100);
+    node_inputs[6].rep() = 2.0f;
+    node_inputs[7].rep() = Halide::cast<uint8_t>(10);
+
+    Node converted = convert_node(matmul_node, node_inputs);
+
+    GOOGLE_CHECK_EQ(1, converted.outputs.size());
+    Halide::Buffer<uint8_t> output = converted.outputs[0].rep.realize(1, 8);
+
+    const int expected[8] = {8, 8, 9, 10, 10, 10, 11, 12};
+    for (int j = 0; j < 8; ++j) {
+        EXPECT_EQ(expected[j], output(0, j));
+    }
+}
+
 static void test_sum() {
     onnx::NodeProto sum_node;
     sum_node.set_name("sum_node");
@@ -498,6 +595,240 @@ static void test_model() {
     EXPECT_EQ(7, output_shape(1));
 }
 
+static void add_float_initializer(
+    onnx::GraphProto *graph,
+    const std::string &name,
+    const std::vector<int64_t> &dims,
+    const std::vector<float> &vals) {
+    onnx::TensorProto *t = graph->add_initializer();
+    t->set_name(name);
+    t->set_data_type(onnx::TensorProto_DataType_FLOAT);
+    for (int64_t dim : dims) {
+        t->add_dims(dim);
+    }
+    for (float v : vals) {
+        t->add_float_data(v);
+    }
+}
+
+static void test_conv_batchnorm_folding() {
+    onnx::ModelProto model;
+    onnx::GraphProto *graph = model.mutable_graph();
+    onnx::ValueInfoProto *input_def = graph->add_input();
+    input_def->set_name("x");
+    input_def->mutable_type()->mutable_tensor_type()->set_elem_type(
+        onnx::TensorProto_DataType_FLOAT);
+    for (int dim : {1, 2, 3, 3}) {
+        input_def->mutable_type()
+            ->mutable_tensor_type()
+            ->mutable_shape()
+            ->add_dim()
+            ->set_dim_value(dim);
+    }
+    graph->add_output()->set_name("y");
+
+    // 1x1 convolution from 2 to 2 channels followed by a batch normalization.
+    const float weights[2][2] = {{1.0f, -2.0f}, {0.5f, 3.0f}};
+    const float bias[2] = {0.25f, -1.0f};
+    const float scale[2] = {2.0f, 0.5f};
+    const float shift[2] = {1.0f, -0.5f};
+    const float mean[2] = {0.1f, -0.3f};
+    const float variance[2] = {4.0f, 0.25f};
+    add_float_initializer(graph, "W", {2, 2, 1, 1}, {weights[0][0], weights[0][1], weights[1][0], weights[1][1]});
+    add_float_initializer(graph, "B", {2}, {bias[0], bias[1]});
+    add_float_initializer(graph, "scale", {2}, {scale[0], scale[1]});
+    add_float_initializer(graph, "shift", {2}, {shift[0], shift[1]});
+    add_float_initializer(graph, "mean", {2}, {mean[0], mean[1]});
+    add_float_initializer(graph, "variance", {2}, {variance[0], variance[1]});
+
+    onnx::NodeProto *conv_node = graph->add_node();
+    conv_node->set_name("conv");
+    conv_node->set_op_type("Conv");
+    conv_node->add_input("x");
+    conv_node->add_input("W");
+    conv_node->add_input("B");
+    conv_node->add_output("conv_out");
+
+    onnx::NodeProto *bn_node = graph->add_node();
+    bn_node->set_name("bn");
+    bn_node->set_op_type("BatchNormalization");
+    for (const char *input : {"conv_out", "scale", "shift", "mean", "variance"}) {
+        bn_node->add_input(input);
+    }
+    bn_node->add_output("y");
+
+    std::unordered_map<std::string, int> dummy;
+    Model converted = convert_model(&model, dummy, IOLayout::Native);
+
+    // The batch normalization should have been folded into the convolution,
+    // and the initializers it replaced dropped, leaving only the folded
+    // weights and bias.
+    EXPECT_EQ(0, converted.tensors.count("conv_out"));
+    EXPECT_EQ(2, model.graph().initializer_size());
+    for (const char *name : {"W", "B", "scale", "shift", "mean", "variance"}) {
+        EXPECT_EQ(0, converted.tensors.count(name));
+    }
+
+    Halide::Buffer<float> input_values(1, 2, 3, 3);
+    std::uniform_real_distribution<float> dis(-1.0, 1.0);
+    std::mt19937 rnd;
+    input_values.for_each_value([&](float &f) { f = dis(rnd); });
+
+    Halide::ImageParam &input = converted.inputs.at("x");
+    input.set(input_values);
+    Tensor node = converted.outputs.at("y");
+    Halide::Buffer<float> output_values = node.rep.realize({1, 2, 3, 3});
+
+    for (int c = 0; c < 2; ++c) {
+        for (int h = 0; h < 3; ++h) {
+            for (int w = 0; w < 3; ++w) {
+                float conv = bias[c];
+                for (int i = 0; i < 2; ++i) {
+                    conv += weights[c][i] * input_values(0, i, h, w);
+                }
+                float expected = scale[c] * (conv - mean[c]) /
+                                     std::sqrt(variance[c] + 1e-5f) +
+                                 shift[c];
+                EXPECT_NEAR(output_values(0, c, h, w), expected, 1e-5f);
+            }
+        }
+    }
+}
+
+static void add_float_input(
+    onnx::GraphProto *graph,
+    const std::string &name,
+    const std::vector<int> &dims) {
+    onnx::ValueInfoProto *input_def = graph->add_input();
+    input_def->set_name(name);
+    input_def->mutable_type()->mutable_tensor_type()->set_elem_type(
+        onnx::TensorProto_DataType_FLOAT);
+    for (int dim : dims) {
+        input_def->mutable_type()
+            ->mutable_tensor_type()
+            ->mutable_shape()
+            ->add_dim()
+            ->set_dim_value(dim);
+    }
+}
+
+static void test_gemm_add_folding() {
+    onnx::ModelProto model;
+    onnx::GraphProto *graph = model.mutable_graph();
+    add_float_input(graph, "x", {2, 3});
+    graph->add_output()->set_name("y");
+
+    const float b[3][4] = {{1.0f, 2.0f, -1.0f, 0.5f},
+                           {0.0f, -3.0f, 2.0f, 1.0f},
+                           {4.0f, 1.0f, 0.25f, -2.0f}};
+    const float c[4] = {0.5f, -1.0f, 2.0f, 3.0f};
+    add_float_initializer(graph, "B", {3, 4}, {b[0][0], b[0][1], b[0][2], b[0][3], b[1][0], b[1][1], b[1][2], b[1][3], b[2][0], b[2][1], b[2][2], b[2][3]});
+    add_float_initializer(graph, "C", {4}, {c[0], c[1], c[2], c[3]});
+
+    onnx::NodeProto *gemm_node = graph->add_node();
+    gemm_node->set_name("gemm");
+    gemm_node->set_op_type("Gemm");
+    gemm_node->add_input("x");
+    gemm_node->add_input("B");
+    gemm_node->add_output("gemm_out");
+
+    onnx::NodeProto *add_node = graph->add_node();
+    add_node->set_name("add");
+    add_node->set_op_type("Add");
+    add_node->add_input("gemm_out");
+    add_node->add_input("C");
+    add_node->add_output("y");
+
+    std::unordered_map<std::string, int> dummy;
+    Model converted = convert_model(model, dummy, IOLayout::Native);
+
+    // The addition should have been folded into the bias of the Gemm.
+    EXPECT_EQ(0, converted.tensors.count("gemm_out"));
+
+    Halide::Buffer<float> input_values(2, 3);
+    std::uniform_real_distribution<float> dis(-1.0, 1.0);
+    std::mt19937 rnd;
+    input_values.for_each_value([&](float &f) { f = dis(rnd); });
+
+    converted.inputs.at("x").set(input_values);
+    Halide::Buffer<float> output_values = converted.outputs.at("y").rep.realize({2, 4});
+
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            float expected = c[j];
+            for (int k = 0; k < 3; ++k) {
+                expected += input_values(i, k) * b[k][j];
+            }
+            EXPECT_NEAR(output_values(i, j), expected, 1e-5f);
+        }
+    }
+}
+
+static void test_constant_folding() {
+    onnx::ModelProto model;
+    onnx::GraphProto *graph = model.mutable_graph();
+    add_float_input(graph, "x", {2, 3});
+    graph->add_output()->set_name("y");
+
+    std::vector<float> w;
+    for (int i = 0; i < 12; ++i) {
+        w.push_back(0.5f * i - 2.0f);
+    }
+    add_float_initializer(graph, "W", {4, 3}, w);
+
+    // W_t = -transpose(W) only depends on constants, so it's evaluated
+    // when converting the model.
+    onnx::NodeProto *transpose_node = graph->add_node();
+    transpose_node->set_name("transpose");
+    transpose_node->set_op_type("Transpose");
+    transpose_node->add_input("W");
+    transpose_node->add_output("W_t");
+
+    onnx::NodeProto *neg_node = graph->add_node();
+    neg_node->set_name("neg");
+    neg_node->set_op_type("Neg");
+    neg_node->add_input("W_t");
+    neg_node->add_output("W_neg");
+
+    onnx::NodeProto *matmul_node = graph->add_node();
+    matmul_node->set_name("matmul");
+    matmul_node->set_op_type("MatMul");
+    matmul_node->add_input("x");
+    matmul_node->add_input("W_neg");
+    matmul_node->add_output("y");
+
+    std::unordered_map<std::string, int> dummy;
+    Model converted = convert_model(model, dummy, IOLayout::Native);
+
+    // Only the constant used by the rest of the graph is replaced by a buffer,
+    // the intermediate one is computed along the way.
+    const std::string folded_suffix = "_folded";
+    const std::string neg_name = converted.tensors.at("W_neg").rep.name();
+    const std::string transpose_name = converted.tensors.at("W_t").rep.name();
+    EXPECT_EQ(true, neg_name.size() > folded_suffix.size() &&
+                        neg_name.compare(neg_name.size() - folded_suffix.size(),
+                                         folded_suffix.size(), folded_suffix) == 0);
+    EXPECT_EQ(std::string::npos, transpose_name.find(folded_suffix));
+
+    Halide::Buffer<float> input_values(2, 3);
+    std::uniform_real_distribution<float> dis(-1.0, 1.0);
+    std::mt19937 rnd;
+    input_values.for_each_value([&](float &f) { f = dis(rnd); });
+
+    converted.inputs.at("x").set(input_values);
+    Halide::Buffer<float> output_values = converted.outputs.at("y").rep.realize({2, 4});
+
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            float expected = 0.0f;
+            for (int k = 0; k < 3; ++k) {
+                expected -= input_values(i, k) * w[j * 3 + k];
+            }
+            EXPECT_NEAR(output_values(i, j), expected, 1e-5f);
+        }
+    }
+}
+
 int main() {
     test_abs();
     test_activation_function();
@@ -506,11 +837,16 @@ int main() {
     test_constant();
     test_gemm();
     test_conv();
+    test_qlinear_matmul();
+    test_qlinear_matmul_ties();
     test_sum();
     test_where_broadcast();
     test_concat();
     test_constant_fill();
     test_model();
+    test_conv_batchnorm_folding();
+    test_gemm_add_folding();
+    test_constant_folding();
     printf("Success!\n");
     return 0;
 }
@@ -5,7 +5,20 @@ import numpy
 ERROR_THRESHOLD = 0.0001
 
 
-def test():
+class DLPackOnly:
+    """Exposes an array only through DLPack, like a PyTorch tensor."""
+
+    def __init__(self, array):
+        self.array = array
+
+    def __dlpack__(self, stream=None):
+        return self.array.__dlpack__()
+
+    def __dlpack_device__(self):
+        return self.array.__dlpack_device__()
+
+
+def test(wrap=lambda array: array):
     constant_u1 = True
     constant_u8 = 3
     constant_u16 = 49153
@@ -49,12 +62,14 @@ def test():
         constant_u8, constant_u16, constant_u32, constant_u64,
         constant_i8, constant_i16, constant_i32, constant_i64,
         constant_float, constant_double,
-        input_u8, input_u16, input_u32, input_u64,
-        input_i8, input_i16, input_i32, input_i64,
-        input_float, input_double, input_2d, input_3d,
-        output_u8, output_u16, output_u32, output_u64,
-        output_i8, output_i16, output_i32, output_i64,
-        output_float, output_double, output_2d, output_3d,
+        *map(wrap, [
+            input_u8, input_u16, input_u32, input_u64,
+            input_i8, input_i16, input_i32, input_i64,
+            input_float, input_double, input_2d, input_3d,
+            output_u8, output_u16, output_u32, output_u64,
+            output_i8, output_i16, output_i32, output_i64,
+            output_float, output_double, output_2d, output_3d,
+        ])
     )
 
     combinations = [
@@ -86,3 +101,7 @@ def test():
 
 if __name__ == "__main__":
   test()
+  # The extension also takes objects that only support DLPack, without
+  # copying them, and lays them out the same way as the arrays themselves.
+  if hasattr(numpy.ndarray, "__dlpack__"):
+    test(DLPackOnly)
@@ -258,6 +258,74 @@ def test_buffer_to_str():
     b = hl.Buffer(hl.Int(32), [128, 256])
     assert str(b) == '<halide.Buffer of type int32 shape:[[0,128,1],[0,256,128]]>'
 
+def test_dlpack():
+    buf = hl.Buffer(hl.Float(32), [4, 6])
+    buf.fill(0)
+    buf[1, 2] = 42
+
+    # Round-tripping through DLPack shares storage.
+    shared = hl.Buffer.from_dlpack(buf)
+    assert shared.type() == hl.Float(32)
+    assert shared.dim(0).extent() == 4
+    assert shared.dim(1).extent() == 6
+    assert shared.dim(0).stride() == buf.dim(0).stride()
+    assert shared[1, 2] == 42
+    shared[3, 5] = 7
+    assert buf[3, 5] == 7
+
+    # The imported Buffer keeps the data alive.
+    del buf
+    gc.collect()
+    assert shared[1, 2] == 42
+
+    # So does a strided ndarray, if the consumer supports DLPack.
+    if hasattr(np, "from_dlpack"):
+        a = np.arange(24, dtype=np.int32).reshape(4, 6)[:, ::2]
+        b = hl.Buffer.from_dlpack(a)
+        assert b.dim(1).stride() == 2
+        assert b[2, 1] == a[2, 1]
+        c = np.from_dlpack(b)
+        assert c.shape == a.shape
+        c[0, 0] = 99
+        assert a[0, 0] == 99
+
+    try:
+        hl.Buffer.from_dlpack(42)
+    except ValueError as e:
+        assert 'does not support DLPack' in str(e)
+    else:
+        assert False, 'Did not see expected exception!'
+
+def test_realize_into_ndarray():
+    x, y = hl.Var("x"), hl.Var("y")
+    f = hl.Func("f")
+    f[x, y] = x + y * 10
+
+    # Outputs can be written directly into a (strided) ndarray.
+    a = np.zeros((8, 6), dtype=np.int32)
+    view = a[::2, :]
+    f.realize(view)
+    assert a[2, 3] == 1 + 3 * 10
+    assert a[1, 3] == 0
+
+    # So can the outputs of a Tuple-valued Func.
+    g = hl.Func("g")
+    g[x, y] = (x, y)
+    b0 = np.zeros((4, 3), dtype=np.int32)
+    b1 = np.zeros((4, 3), dtype=np.int32)
+    g.realize([b0, b1])
+    assert b0[2, 1] == 2
+    assert b1[2, 1] == 1
+
+    # Elsewhere, an ndarray has to be wrapped in a Buffer explicitly, since
+    # the Buffer keeps the ndarray alive.
+    try:
+        hl.Func(a)
+    except TypeError:
+        pass
+    else:
+        assert False, 'Did not see expected exception!'
+
 if __name__ == "__main__":
     test_make_interleaved()
     test_interleaved_ndarray()
@@ -271,3 +339,5 @@ if __name__ == "__main__":
     test_reorder()
     test_overflow()
     test_buffer_to_str()
+    test_dlpack()
+    test_realize_into_ndarray()
@@ -0,0 +1,67 @@
+import halide as hl
+import threading
+
+def make_pipeline(k):
+    x, y = hl.Var('x'), hl.Var('y')
+    f = hl.Func('f')
+    f[x, y] = x * k + y
+    return f
+
+def check(b, k):
+    assert b.dim(0).extent() == 100
+    assert b.dim(1).extent() == 50
+    for x, y in [(0, 0), (3, 7), (99, 49)]:
+        assert b[x, y] == x * k + y
+
+def test_realize_from_threads():
+    # realize() releases the GIL, so these can run concurrently.
+    funcs = [make_pipeline(k) for k in range(8)]
+    results = [None] * len(funcs)
+
+    def run(i):
+        results[i] = funcs[i].realize([100, 50])
+
+    threads = [threading.Thread(target=run, args=(i,)) for i in range(len(funcs))]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    for k, b in enumerate(results):
+        check(b, k)
+
+def test_realize_async():
+    f = make_pipeline(3)
+    p = hl.Pipeline(f)
+    # Compile first, so that the same Pipeline can be realized concurrently.
+    p.compile_jit()
+    futures = [p.realize_async([100, 50]) for i in range(8)]
+    for future in futures:
+        check(future.result(), 3)
+
+    # realize_async() compiles the Pipeline itself before returning, so the
+    # calls can run concurrently without compile_jit().
+    q = hl.Pipeline(make_pipeline(5))
+    futures = [q.realize_async([100, 50]) for i in range(8)]
+    for future in futures:
+        check(future.result(), 5)
+    futures = [q.realize_async([100, 50], hl.get_jit_target_from_environment()) for i in range(8)]
+    for future in futures:
+        check(future.result(), 5)
+
+    # Realizing into an existing buffer.
+    out = hl.Buffer(hl.Int(32), [100, 50])
+    f.realize_async(out).result()
+    check(out, 3)
+
+    # Errors are reported through the future.
+    g = hl.Func('g')
+    try:
+        g.realize_async([10]).result()
+    except RuntimeError as e:
+        assert "undefined Func" in str(e)
+    else:
+        assert False, 'Did not see expected exception!'
+
+if __name__ == "__main__":
+    test_realize_from_threads()
+    test_realize_async()
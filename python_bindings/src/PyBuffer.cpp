@@ -1,5 +1,6 @@
 #include "PyBuffer.h"
 
+#include <memory>
 #include <utility>
 
 #include "PyFunc.h"
@@ -230,24 +231,127 @@ py::object buffer_setitem_operator(Buffer<> &buf, const std::vector<int> &pos, c
     return py::object();
 }
 
+// The subset of the DLPack ABI (https://github.com/dmlc/dlpack) needed to
+// exchange host tensors with other frameworks. The DLPack type codes for
+// int, uint, float and bfloat match halide_type_code_t.
+constexpr int32_t kDLCPU = 1;
+constexpr int32_t kDLCUDAHost = 3;
+constexpr uint8_t kDLBool = 6;
+
+struct DLDevice {
+    int32_t device_type;
+    int32_t device_id;
+};
+
+struct DLDataType {
+    uint8_t code;
+    uint8_t bits;
+    uint16_t lanes;
+};
+
+struct DLTensor {
+    void *data;
+    DLDevice device;
+    int32_t ndim;
+    DLDataType dtype;
+    int64_t *shape;
+    int64_t *strides;  // In elements. Null means compact, row-major.
+    uint64_t byte_offset;
+};
+
+struct DLManagedTensor {
+    DLTensor dl_tensor;
+    void *manager_ctx;
+    void (*deleter)(DLManagedTensor *self);
+};
+
+// The state behind a DLManagedTensor we export. Holding a reference to the
+// Buffer<> keeps its allocation alive until the consumer is done with it.
+struct DLPackExport {
+    Buffer<> buffer;
+    std::vector<int64_t> shape, strides;
+    DLManagedTensor tensor;
+};
+
+void dlpack_capsule_destructor(PyObject *capsule) {
+    // A consumer that takes ownership of the tensor renames the capsule
+    // and becomes responsible for calling the deleter.
+    if (PyCapsule_IsValid(capsule, "dltensor")) {
+        DLManagedTensor *tensor = (DLManagedTensor *)PyCapsule_GetPointer(capsule, "dltensor");
+        tensor->deleter(tensor);
+    }
+}
+
+py::capsule buffer_to_dlpack(Buffer<> &b) {
+    if (b.data() == nullptr) {
+        throw py::value_error("Cannot export a Buffer<> with null host ptr to DLPack.");
+    }
+    if (b.device_dirty() && b.copy_to_host() != 0) {
+        throw py::value_error("Failed to copy Buffer<> to host for DLPack export.");
+    }
+    // The consumer may write to the host memory, so the device copy can no
+    // longer be trusted.
+    if (b.has_device_allocation()) {
+        b.set_host_dirty();
+    }
+
+    DLPackExport *e = new DLPackExport;
+    e->buffer = b;
+    for (int i = 0; i < b.dimensions(); i++) {
+        e->shape.push_back(b.raw_buffer()->dim[i].extent);
+        e->strides.push_back(b.raw_buffer()->dim[i].stride);
+    }
+
+    DLTensor &t = e->tensor.dl_tensor;
+    t.data = b.data();
+    t.device = {kDLCPU, 0};
+    t.ndim = b.dimensions();
+    if (b.type().is_bool()) {
+        t.dtype = {kDLBool, 8, 1};
+    } else {
+        t.dtype = {(uint8_t)b.type().code(), (uint8_t)b.type().bits(), 1};
+    }
+    t.shape = e->shape.data();
+    t.strides = e->strides.data();
+    t.byte_offset = 0;
+    e->tensor.manager_ctx = e;
+    e->tensor.deleter = [](DLManagedTensor *self) {
+        delete (DLPackExport *)self->manager_ctx;
+    };
+
+    PyObject *capsule = PyCapsule_New(&e->tensor, "dltensor", dlpack_capsule_destructor);
+    if (capsule == nullptr) {
+        delete e;
+        throw py::error_already_set();
+    }
+    return py::reinterpret_steal<py::capsule>(capsule);
+}
+
+std::vector<halide_dimension_t> make_dim_vec(const py::buffer_info &info) {
+    const Type t = format_descriptor_to_type(info.format);
+    std::vector<halide_dimension_t> dims;
+    dims.reserve(info.ndim);
+    for (int i = 0; i < info.ndim; i++) {
+        if (INT_MAX < info.shape[i] ||
+            INT_MAX < (info.strides[i] / t.bytes()) ||
+            INT_MIN > (info.strides[i] / t.bytes())) {
+            throw py::value_error("Out of range arguments to make_dim_vec.");
+        }
+        if (info.strides[i] % t.bytes() != 0) {
+            throw py::value_error("Strides must be a multiple of the element size.");
+        }
+        dims.emplace_back(0, (int32_t)info.shape[i], (int32_t)(info.strides[i] / t.bytes()));
+    }
+    return dims;
+}
+
 // Use an alias class so that if we are created via a py::buffer, we can
 // keep the py::buffer_info class alive for the life of the Buffer<>,
-// ensuring the data isn't collected out from under us.
+// ensuring the data isn't collected out from under us. Likewise, a Buffer<>
+// imported from DLPack holds on to the producer's tensor.
 class PyBuffer : public Buffer<> {
     py::buffer_info info;
-
-    static std::vector<halide_dimension_t> make_dim_vec(const py::buffer_info &info) {
-        const Type t = format_descriptor_to_type(info.format);
-        std::vector<halide_dimension_t> dims;
-        dims.reserve(info.ndim);
-        for (int i = 0; i < info.ndim; i++) {
-            if (INT_MAX < info.shape[i] || INT_MAX < (info.strides[i] / t.bytes())) {
-                throw py::value_error("Out of range arguments to make_dim_vec.");
-            }
-            dims.emplace_back(0, (int32_t)info.shape[i], (int32_t)(info.strides[i] / t.bytes()));
-        }
-        return dims;
-    }
+    std::shared_ptr<DLManagedTensor> dlpack_tensor;
 
     PyBuffer(py::buffer_info &&info, const std::string &name)
         : Buffer<>(
@@ -259,6 +363,12 @@ class PyBuffer : public Buffer<> {
           info(std::move(info)) {
     }
 
+    PyBuffer(const Type &t, void *data, const std::vector<halide_dimension_t> &dims,
+             std::shared_ptr<DLManagedTensor> dlpack_tensor, const std::string &name)
+        : Buffer<>(t, data, (int)dims.size(), dims.data(), name),
+          info(), dlpack_tensor(std::move(dlpack_tensor)) {
+    }
+
 public:
     PyBuffer()
         : Buffer<>(), info() {
@@ -286,11 +396,79 @@ public:
         this->set_host_dirty();
     }
 
+    // Wrap a DLPack capsule, or an object with a __dlpack__ method (e.g. a
+    // NumPy array or a PyTorch tensor), without copying. Only tensors
+    // in host memory are supported.
+    static Buffer<> *from_dlpack(const py::object &obj, const std::string &name) {
+        py::object capsule = obj;
+        if (!PyCapsule_CheckExact(obj.ptr())) {
+            if (!py::hasattr(obj, "__dlpack__")) {
+                throw py::value_error("Object does not support DLPack.");
+            }
+            capsule = obj.attr("__dlpack__")();
+        }
+        DLManagedTensor *tensor = (DLManagedTensor *)PyCapsule_GetPointer(capsule.ptr(), "dltensor");
+        if (tensor == nullptr) {
+            // Also the case if the capsule has already been consumed.
+            throw py::error_already_set();
+        }
+        // Take ownership of the tensor.
+        PyCapsule_SetName(capsule.ptr(), "used_dltensor");
+        std::shared_ptr<DLManagedTensor> owner(tensor, [](DLManagedTensor *t) {
+            if (t->deleter) {
+                t->deleter(t);
+            }
+        });
+
+        const DLTensor &t = tensor->dl_tensor;
+        if (t.device.device_type != kDLCPU && t.device.device_type != kDLCUDAHost) {
+            throw py::value_error("Only DLPack tensors in host memory can be converted to a Buffer<>.");
+        }
+        if (t.dtype.lanes != 1 || t.dtype.bits % 8 != 0) {
+            throw py::value_error("Unsupported DLPack data type.");
+        }
+        Type type;
+        if (t.dtype.code == kDLBool) {
+            type = Bool();
+        } else if (t.dtype.code == halide_type_int ||
+                   t.dtype.code == halide_type_uint ||
+                   t.dtype.code == halide_type_float ||
+                   t.dtype.code == halide_type_bfloat) {
+            type = Type((halide_type_code_t)t.dtype.code, t.dtype.bits, 1);
+        } else {
+            throw py::value_error("Unsupported DLPack data type.");
+        }
+
+        // As for py::buffer, dimension i of the Buffer<> is axis i of the
+        // tensor.
+        std::vector<halide_dimension_t> dims(t.ndim);
+        int64_t stride = 1;
+        for (int i = t.ndim - 1; i >= 0; i--) {
+            int64_t s = t.strides ? t.strides[i] : stride;
+            if (INT_MAX < t.shape[i] || INT_MAX < s || INT_MIN > s) {
+                throw py::value_error("Out of range DLPack tensor shape.");
+            }
+            dims[i] = halide_dimension_t(0, (int32_t)t.shape[i], (int32_t)s);
+            stride *= t.shape[i];
+        }
+
+        PyBuffer *b = new PyBuffer(type, (uint8_t *)t.data + t.byte_offset, dims, std::move(owner), name);
+        // See the comment in the py::buffer ctor.
+        b->set_host_dirty();
+        return b;
+    }
+
     ~PyBuffer() override = default;
 };
 
 }  // namespace
 
+Buffer<> borrow_py_buffer(const py::buffer &buffer) {
+    py::buffer_info info = buffer.request(/*writable*/ true);
+    return Buffer<>(format_descriptor_to_type(info.format), info.ptr,
+                    (int)info.ndim, make_dim_vec(info).data());
+}
+
 void define_buffer(py::module &m) {
     using BufferDimension = Halide::Runtime::Buffer<>::Dimension;
 
@@ -332,6 +510,19 @@ void define_buffer(py::module &m) {
             // This allows us to use any buffer-like python entity to create a Buffer<>
             // (most notably, an ndarray)
             .def(py::init_alias<py::buffer, const std::string &>(), py::arg("buffer"), py::arg("name") = "")
+
+            // DLPack interop (e.g. with PyTorch), without copying in either direction.
+            .def_static("from_dlpack", &PyBuffer::from_dlpack, py::arg("tensor"), py::arg("name") = "",
+                        py::return_value_policy::take_ownership)
+            .def(
+                "__dlpack__", [](Buffer<> &b, const py::object &stream) -> py::capsule {
+                    return buffer_to_dlpack(b);
+                },
+                py::arg("stream") = py::none())
+            .def("__dlpack_device__", [](Buffer<> &b) -> py::tuple {
+                return py::make_tuple(kDLCPU, 0);
+            })
+
             .def(py::init_alias<>())
             .def(py::init_alias<const Buffer<> &>())
             .def(py::init([](Type type, const std::vector<int> &sizes, const std::string &name) -> Buffer<> {
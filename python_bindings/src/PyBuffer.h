@@ -8,6 +8,12 @@ namespace PythonBindings {
 
 void define_buffer(py::module &m);
 
+// Wrap the memory of a buffer-like object (e.g. an ndarray) in a Buffer<>,
+// without copying it. Unlike a Buffer constructed from Python, the result
+// doesn't keep the object alive, so it must not outlive the call it is
+// made for.
+Buffer<> borrow_py_buffer(const py::buffer &buffer);
+
 }  // namespace PythonBindings
 }  // namespace Halide
 
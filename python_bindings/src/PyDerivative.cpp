@@ -4,6 +4,16 @@ namespace Halide {
 namespace PythonBindings {
 
 void define_derivative(py::module &m) {
+    py::class_<CheckpointPolicy>(m, "CheckpointPolicy")
+        .def(py::init<>())
+        .def_readwrite("recompute", &CheckpointPolicy::recompute)
+        .def_readwrite("memory_budget", &CheckpointPolicy::memory_budget);
+
+    py::class_<Checkpoint>(m, "Checkpoint")
+        .def_readonly("name", &Checkpoint::name)
+        .def_readonly("bytes", &Checkpoint::bytes)
+        .def_readonly("recomputed", &Checkpoint::recomputed);
+
     auto derivative_class =
         py::class_<Derivative>(m, "Derivative")
             .def(
@@ -23,7 +33,9 @@ void define_derivative(py::module &m) {
                 py::arg("param"))
             .def("__getitem__", [](const Derivative &d, const std::tuple<const Func &, int> &args) {
                 return d(std::get<0>(args), std::get<1>(args));
-            });
+            })
+            .def("checkpoints", &Derivative::checkpoints)
+            .def("checkpointed_bytes", &Derivative::checkpointed_bytes);
 
     m.def("propagate_adjoints",
           (Derivative(*)(const Func &, const Func &, const Region &)) & propagate_adjoints);
@@ -31,6 +43,12 @@ void define_derivative(py::module &m) {
           (Derivative(*)(const Func &, const Buffer<float> &)) & propagate_adjoints);
     m.def("propagate_adjoints",
           (Derivative(*)(const Func &)) & propagate_adjoints);
+    m.def("propagate_adjoints",
+          (Derivative(*)(const Func &, const Func &, const Region &, const CheckpointPolicy &)) & propagate_adjoints);
+    m.def("propagate_adjoints",
+          (Derivative(*)(const Func &, const Buffer<float> &, const CheckpointPolicy &)) & propagate_adjoints);
+    m.def("propagate_adjoints",
+          (Derivative(*)(const Func &, const CheckpointPolicy &)) & propagate_adjoints);
 }
 
 }  // namespace PythonBindings
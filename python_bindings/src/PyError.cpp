@@ -5,17 +5,22 @@ namespace PythonBindings {
 
 namespace {
 
+// Pipelines run with the GIL released (see PyPipeline.cpp), so anything
+// that calls back into Python must reacquire it first.
+
 void halide_python_error(void *, const char *msg) {
     throw Error(msg);
 }
 
 void halide_python_print(void *, const char *msg) {
+    py::gil_scoped_acquire acquire;
     py::print(msg, py::arg("end") = "");
 }
 
 class HalidePythonCompileTimeErrorReporter : public CompileTimeErrorReporter {
 public:
     void warning(const char *msg) override {
+        py::gil_scoped_acquire acquire;
         py::print(msg, py::arg("end") = "");
     }
 
@@ -6,6 +6,7 @@
 #include "PyExpr.h"
 #include "PyFuncRef.h"
 #include "PyLoopLevel.h"
+#include "PyPipeline.h"
 #include "PyScheduleMethods.h"
 #include "PyStage.h"
 #include "PyTuple.h"
@@ -16,6 +17,15 @@ namespace PythonBindings {
 
 namespace {
 
+// The Pipeline that Func::realize() uses, which is cached on first use, so
+// get it while we still hold the GIL.
+Pipeline realize_pipeline(Func &f) {
+    if (!f.defined()) {
+        throw Error("Can't realize undefined Func.");
+    }
+    return f.pipeline();
+}
+
 template<typename LHS>
 void define_get(py::class_<Func> &func_class) {
     func_class
@@ -117,7 +127,9 @@ void define_func(py::module &m) {
             .def(
                 "realize",
                 [](Func &f, Buffer<> buffer, const Target &target) -> void {
-                    f.realize(buffer, target);
+                    Pipeline p = realize_pipeline(f);
+                    Realization r(buffer);
+                    realize_without_gil(p, r, target);
                 },
                 py::arg("dst"), py::arg("target") = Target())
 
@@ -125,14 +137,35 @@ void define_func(py::module &m) {
             .def(
                 "realize",
                 [](Func &f, std::vector<Buffer<>> buffers, const Target &t) -> void {
-                    f.realize(Realization(buffers), t);
+                    Pipeline p = realize_pipeline(f);
+                    Realization r(buffers);
+                    realize_without_gil(p, r, t);
+                },
+                py::arg("dst"), py::arg("target") = Target())
+
+            // Buffer-like objects that aren't Buffers, e.g. ndarrays. See the
+            // comments in PyPipeline.cpp about the order of these overloads.
+            .def(
+                "realize",
+                [](Func &f, const py::buffer &buffer, const Target &target) -> void {
+                    Pipeline p = realize_pipeline(f);
+                    realize_to_py_buffers(p, {buffer}, target);
+                },
+                py::arg("dst"), py::arg("target") = Target())
+
+            .def(
+                "realize",
+                [](Func &f, const std::vector<py::buffer> &buffers, const Target &t) -> void {
+                    Pipeline p = realize_pipeline(f);
+                    realize_to_py_buffers(p, buffers, t);
                 },
                 py::arg("dst"), py::arg("target") = Target())
 
             .def(
                 "realize",
                 [](Func &f, const std::vector<int32_t> &sizes, const Target &target) -> py::object {
-                    return realization_to_object(f.realize(sizes, target));
+                    Pipeline p = realize_pipeline(f);
+                    return realization_to_object(realize_without_gil(p, sizes, target));
                 },
                 py::arg("sizes") = std::vector<int32_t>{}, py::arg("target") = Target())
 
@@ -140,7 +173,8 @@ void define_func(py::module &m) {
             .def(
                 "realize",
                 [](Func &f, int x_size, const Target &target) -> py::object {
-                    return realization_to_object(f.realize(x_size, target));
+                    Pipeline p = realize_pipeline(f);
+                    return realization_to_object(realize_without_gil(p, {x_size}, target));
                 },
                 py::arg("x_size"), py::arg("target") = Target())
 
@@ -148,7 +182,8 @@ void define_func(py::module &m) {
             .def(
                 "realize",
                 [](Func &f, int x_size, int y_size, const Target &target) -> py::object {
-                    return realization_to_object(f.realize(x_size, y_size, target));
+                    Pipeline p = realize_pipeline(f);
+                    return realization_to_object(realize_without_gil(p, {x_size, y_size}, target));
                 },
                 py::arg("x_size"), py::arg("y_size"), py::arg("target") = Target())
 
@@ -156,7 +191,8 @@ void define_func(py::module &m) {
             .def(
                 "realize",
                 [](Func &f, int x_size, int y_size, int z_size, const Target &target) -> py::object {
-                    return realization_to_object(f.realize(x_size, y_size, z_size, target));
+                    Pipeline p = realize_pipeline(f);
+                    return realization_to_object(realize_without_gil(p, {x_size, y_size, z_size}, target));
                 },
                 py::arg("x_size"), py::arg("y_size"), py::arg("z_size"), py::arg("target") = Target())
 
@@ -164,10 +200,14 @@ void define_func(py::module &m) {
             .def(
                 "realize",
                 [](Func &f, int x_size, int y_size, int z_size, int w_size, const Target &target) -> py::object {
-                    return realization_to_object(f.realize(x_size, y_size, z_size, w_size, target));
+                    Pipeline p = realize_pipeline(f);
+                    return realization_to_object(realize_without_gil(p, {x_size, y_size, z_size, w_size}, target));
                 },
                 py::arg("x_size"), py::arg("y_size"), py::arg("z_size"), py::arg("w_size"), py::arg("target") = Target())
 
+            // Takes the same arguments as realize().
+            .def("realize_async", &realize_async)
+
             .def("defined", &Func::defined)
             .def("name", &Func::name)
             .def("dimensions", &Func::dimensions)
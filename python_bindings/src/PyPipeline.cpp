@@ -2,6 +2,7 @@
 
 #include <utility>
 
+#include "PyBuffer.h"
 #include "PyTuple.h"
 
 namespace Halide {
@@ -19,8 +20,82 @@ py::object realization_to_object(const Realization &r) {
     return to_python_tuple(r);
 }
 
+// The target that realize() would be called with, given the same arguments.
+Target realize_target(const py::args &args, const py::kwargs &kwargs) {
+    if (kwargs.contains("target")) {
+        return kwargs["target"].cast<Target>();
+    }
+    if (args.size() > 0 && py::isinstance<Target>(args[args.size() - 1])) {
+        return args[args.size() - 1].cast<Target>();
+    }
+    return Target();
+}
+
 }  // namespace
 
+void realize_without_gil(Pipeline &p, Realization &outputs, const Target &target) {
+    py::gil_scoped_release release;
+    p.realize(outputs, target);
+}
+
+Realization realize_without_gil(Pipeline &p, const std::vector<int32_t> &sizes, const Target &target) {
+    py::gil_scoped_release release;
+    return p.realize(sizes, target);
+}
+
+void realize_to_py_buffers(Pipeline &p, const std::vector<py::buffer> &buffers, const Target &target) {
+    // The Buffers only borrow the memory, which the caller's objects keep
+    // alive until we return.
+    std::vector<Buffer<>> dst;
+    for (const py::buffer &b : buffers) {
+        dst.push_back(borrow_py_buffer(b));
+    }
+    Realization r(dst);
+    realize_without_gil(p, r, target);
+
+    py::gil_scoped_release release;
+    for (Buffer<> &b : dst) {
+        b.copy_to_host();
+    }
+}
+
+py::object realize_async(const py::object &self, const py::args &args, const py::kwargs &kwargs) {
+    // Compile here, with the GIL held, rather than in realize() on the pool,
+    // so that several realize_async() calls on the same Pipeline don't
+    // compile it concurrently. Errors are left for realize() to report
+    // through the future.
+    Pipeline p;
+    if (py::isinstance<Pipeline>(self)) {
+        p = self.cast<Pipeline>();
+    } else if (py::isinstance<Func>(self) && self.cast<Func &>().defined()) {
+        p = self.cast<Func &>().pipeline();
+    }
+    if (p.defined()) {
+        // Without a target, realize() uses the one the Pipeline was last
+        // compiled for, so compiling for the environment's target here
+        // picks it for realize() too.
+        Target target = realize_target(args, kwargs);
+        if (target.has_unknowns()) {
+            target = get_jit_target_from_environment();
+        }
+        try {
+            p.compile_jit(target);
+        } catch (const Error &) {
+        }
+    }
+
+    // Created on first use, and deliberately never destroyed, since the
+    // interpreter may be gone by the time static destructors run. The
+    // executor shuts itself down at exit.
+    static py::object *executor = nullptr;
+    if (executor == nullptr) {
+        executor = new py::object(
+            py::module::import("concurrent.futures")
+                .attr("ThreadPoolExecutor")(py::arg("thread_name_prefix") = "halide_realize"));
+    }
+    return executor->attr("submit")(self.attr("realize"), *args, **kwargs);
+}
+
 void define_pipeline(py::module &m) {
 
     // Deliberately not supported, because they don't seem to make sense for Python:
@@ -96,51 +171,71 @@ void define_pipeline(py::module &m) {
 
             .def(
                 "realize", [](Pipeline &p, Buffer<> buffer, const Target &target) -> void {
-                    p.realize(Realization(buffer), target);
+                    Realization r(buffer);
+                    realize_without_gil(p, r, target);
                 },
                 py::arg("dst"), py::arg("target") = Target())
 
             // This will actually allow a list-of-buffers as well as a tuple-of-buffers, but that's OK.
             .def(
                 "realize", [](Pipeline &p, std::vector<Buffer<>> buffers, const Target &t) -> void {
-                    p.realize(Realization(buffers), t);
+                    Realization r(buffers);
+                    realize_without_gil(p, r, t);
+                },
+                py::arg("dst"), py::arg("target") = Target())
+
+            // Buffer-like objects that aren't Buffers, e.g. ndarrays. These must come
+            // after the Buffer overloads, which take Buffers without copying them,
+            // and before the sizes overload, since an ndarray is also a sequence.
+            .def(
+                "realize", [](Pipeline &p, const py::buffer &buffer, const Target &target) -> void {
+                    realize_to_py_buffers(p, {buffer}, target);
+                },
+                py::arg("dst"), py::arg("target") = Target())
+
+            .def(
+                "realize", [](Pipeline &p, const std::vector<py::buffer> &buffers, const Target &t) -> void {
+                    realize_to_py_buffers(p, buffers, t);
                 },
                 py::arg("dst"), py::arg("target") = Target())
 
             .def(
                 "realize", [](Pipeline &p, std::vector<int32_t> sizes, const Target &target) -> py::object {
-                    return realization_to_object(p.realize(std::move(sizes), target));
+                    return realization_to_object(realize_without_gil(p, sizes, target));
                 },
                 py::arg("sizes") = std::vector<int32_t>{}, py::arg("target") = Target())
 
             // TODO: deprecate in favor of std::vector<int32_t> size version?
             .def(
                 "realize", [](Pipeline &p, int x_size, const Target &target) -> py::object {
-                    return realization_to_object(p.realize(x_size, target));
+                    return realization_to_object(realize_without_gil(p, {x_size}, target));
                 },
                 py::arg("x_size"), py::arg("target") = Target())
 
             // TODO: deprecate in favor of std::vector<int32_t> size version?
             .def(
                 "realize", [](Pipeline &p, int x_size, int y_size, const Target &target) -> py::object {
-                    return realization_to_object(p.realize(x_size, y_size, target));
+                    return realization_to_object(realize_without_gil(p, {x_size, y_size}, target));
                 },
                 py::arg("x_size"), py::arg("y_size"), py::arg("target") = Target())
 
             // TODO: deprecate in favor of std::vector<int32_t> size version?
             .def(
                 "realize", [](Pipeline &p, int x_size, int y_size, int z_size, const Target &target) -> py::object {
-                    return realization_to_object(p.realize(x_size, y_size, z_size, target));
+                    return realization_to_object(realize_without_gil(p, {x_size, y_size, z_size}, target));
                 },
                 py::arg("x_size"), py::arg("y_size"), py::arg("z_size"), py::arg("target") = Target())
 
             // TODO: deprecate in favor of std::vector<int32_t> size version?
             .def(
                 "realize", [](Pipeline &p, int x_size, int y_size, int z_size, int w_size, const Target &target) -> py::object {
-                    return realization_to_object(p.realize(x_size, y_size, z_size, w_size, target));
+                    return realization_to_object(realize_without_gil(p, {x_size, y_size, z_size, w_size}, target));
                 },
                 py::arg("x_size"), py::arg("y_size"), py::arg("z_size"), py::arg("w_size"), py::arg("target") = Target())
 
+            // Takes the same arguments as realize().
+            .def("realize_async", &realize_async)
+
             // TODO: deprecate/remove when the C++ non-vector version of this API is removed
             .def(
                 "infer_input_bounds", [](Pipeline &p, int x_size, int y_size, int z_size, int w_size, const Target &target) -> void {
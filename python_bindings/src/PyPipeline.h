@@ -8,6 +8,23 @@ namespace PythonBindings {
 
 void define_pipeline(py::module &m);
 
+// Realize a Pipeline with the GIL released, so that other Python threads
+// can run (and realize other Pipelines) in the meantime. Compilation also
+// happens without the GIL, so realizing the same Pipeline from several
+// threads at once requires calling compile_jit() on it first.
+void realize_without_gil(Pipeline &p, Realization &outputs, const Target &target);
+Realization realize_without_gil(Pipeline &p, const std::vector<int32_t> &sizes, const Target &target);
+
+// Realize into the memory of buffer-like objects (e.g. ndarrays), without
+// copying, as realize_without_gil does. The results are copied back to host
+// memory, which is the only part such objects can see.
+void realize_to_py_buffers(Pipeline &p, const std::vector<py::buffer> &buffers, const Target &target);
+
+// Call self.realize(*args, **kwargs) on a shared thread pool, and return
+// a concurrent.futures.Future for the result. The Pipeline is JIT compiled
+// on the calling thread first, so it can be realized concurrently.
+py::object realize_async(const py::object &self, const py::args &args, const py::kwargs &kwargs);
+
 }  // namespace PythonBindings
 }  // namespace Halide
 
@@ -7,6 +7,7 @@
 #include "Simplify.h"
 #include "Substitute.h"
 #include "Target.h"
+#include "Util.h"
 
 namespace Halide {
 namespace Internal {
@@ -759,5 +760,44 @@ Stmt add_image_checks(const Stmt &s,
     return injector.mutate(s);
 }
 
+Stmt strip_argument_checks(const Stmt &s) {
+    // The checks that only depend on the shapes of the buffer arguments
+    // and the values of the scalar arguments. Checks on host pointers,
+    // alignment and device state are cheap and left in place.
+    static const char *const shape_checks[] = {
+        "halide_error_access_out_of_bounds",
+        "halide_error_bad_dimensions",
+        "halide_error_bad_type",
+        "halide_error_buffer_allocation_too_large",
+        "halide_error_buffer_argument_is_null",
+        "halide_error_buffer_extents_negative",
+        "halide_error_buffer_extents_too_large",
+        "halide_error_constraint_violated",
+        "halide_error_constraints_make_required_region_smaller",
+        "halide_error_explicit_bounds_too_small",
+    };
+
+    class StripArgumentChecks : public IRMutator {
+        using IRMutator::visit;
+
+        Stmt visit(const AssertStmt *op) override {
+            const Call *c = op->message.as<Call>();
+            if (c && c->call_type == Call::Extern) {
+                if (starts_with(c->name, "halide_error_param_too_")) {
+                    return Evaluate::make(0);
+                }
+                for (const char *name : shape_checks) {
+                    if (c->name == name) {
+                        return Evaluate::make(0);
+                    }
+                }
+            }
+            return op;
+        }
+    };
+
+    return StripArgumentChecks().mutate(s);
+}
+
 }  // namespace Internal
 }  // namespace Halide
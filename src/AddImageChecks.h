@@ -35,6 +35,13 @@ Stmt add_image_checks(const Stmt &s,
                       const FuncValueBounds &fb,
                       bool will_inject_host_copies);
 
+/** Remove the assertions added by add_image_checks and
+ * add_parameter_checks (and the null checks on buffer arguments) that
+ * depend only on the shapes of the buffers and the values of the
+ * scalar arguments. Used to build a variant of a pipeline that may
+ * only be called with arguments already known to pass those checks. */
+Stmt strip_argument_checks(const Stmt &s);
+
 }  // namespace Internal
 }  // namespace Halide
 
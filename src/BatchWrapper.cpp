@@ -0,0 +1,64 @@
+#include "BatchWrapper.h"
+#include "Error.h"
+#include "LLVM_Headers.h"
+
+using namespace llvm;
+
+namespace Halide {
+namespace Internal {
+
+// Define the batched entry point for a func whose argv wrapper is pipeline_argv_wrapper.
+llvm::Function *define_batch_wrapper(llvm::Module *module,
+                                     llvm::Function *pipeline_argv_wrapper,
+                                     llvm::Function *unchecked_argv_wrapper,
+                                     llvm::Function *metadata_getter,
+                                     const std::string &name) {
+    LLVMContext &ctx = module->getContext();
+
+    llvm::Function *call_pipeline = module->getFunction("halide_batch_call_pipeline");
+    internal_assert(call_pipeline) << "Did not find function 'halide_batch_call_pipeline' in module.\n";
+
+    llvm::Type *i8_ty = llvm::Type::getInt8Ty(ctx);
+    llvm::Type *i32_ty = llvm::Type::getInt32Ty(ctx);
+    Value *user_context = ConstantPointerNull::get(i8_ty->getPointerTo());
+
+    // int name(void ***batch_args, int batch_size)
+    llvm::Type *batch_args_ty = i8_ty->getPointerTo()->getPointerTo()->getPointerTo();
+    llvm::Type *batch_arg_types[] = {
+        batch_args_ty,
+        i32_ty,
+    };
+    FunctionType *batch_ty = FunctionType::get(i32_ty, batch_arg_types, false);
+    llvm::Function *batch = llvm::Function::Create(batch_ty, llvm::GlobalValue::ExternalLinkage, name, module);
+    BasicBlock *entry = BasicBlock::Create(ctx, "entry", batch);
+
+    IRBuilder<> ir(ctx);
+    ir.SetInsertPoint(entry);
+
+    llvm::CallInst *metadata_ptr = ir.CreateCall(metadata_getter);
+
+    llvm::Function::arg_iterator args = batch->arg_begin();
+    Value *batch_args = iterator_to_pointer(args++);
+    Value *batch_size = iterator_to_pointer(args++);
+
+    Value *unchecked = unchecked_argv_wrapper;
+    if (!unchecked) {
+        unchecked = ConstantPointerNull::get(pipeline_argv_wrapper->getType());
+    }
+
+    Value *call_pipeline_args[] = {
+        user_context,
+        pipeline_argv_wrapper,
+        unchecked,
+        metadata_ptr,
+        batch_args,
+        batch_size,
+    };
+    Value *result = ir.CreateCall(call_pipeline, call_pipeline_args);
+    ir.CreateRet(result);
+
+    return batch;
+}
+
+}  // namespace Internal
+}  // namespace Halide
@@ -0,0 +1,36 @@
+#ifndef HALIDE_BATCH_WRAPPER_H
+#define HALIDE_BATCH_WRAPPER_H
+
+/** \file
+ *
+ * Provides an output function to generate a batched entry point for a pipeline.
+ */
+
+#include "Module.h"
+
+namespace llvm {
+class Module;
+class Function;
+}  // namespace llvm
+
+namespace Halide {
+namespace Internal {
+
+/** Add a definition of a function with the given name and the
+ * signature int(void **batch_args[], int batch_size) to the module,
+ * which runs the pipeline once per element of batch_args (each of
+ * which is an argv array as accepted by pipeline_argv_wrapper) via
+ * halide_batch_call_pipeline. If unchecked_argv_wrapper is non-null, it
+ * is an argv wrapper for the same pipeline without the argument checks
+ * (see strip_argument_checks), used for the elements whose arguments
+ * match those of the first element. Returns the new function. */
+llvm::Function *define_batch_wrapper(llvm::Module *module,
+                                     llvm::Function *pipeline_argv_wrapper,
+                                     llvm::Function *unchecked_argv_wrapper,
+                                     llvm::Function *metadata_getter,
+                                     const std::string &name);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
@@ -1,4 +1,6 @@
 #include <iostream>
+#include <map>
+#include <tuple>
 #include <utility>
 
 #include "Bounds.h"
@@ -110,6 +112,32 @@ public:
     // unbounded.
     bool const_bound;
 
+    // The same Expr node can be reached along many paths (e.g. after
+    // substitution), so the bounds of non-leaf nodes are memoized for
+    // the lifetime of this visitor. A result depends on the bindings in
+    // scope and on const_bound, so the key includes both: every binding
+    // pushed while visiting gets a fresh epoch, and the enclosing one is
+    // restored when it is popped. The cached Expr keeps the node alive,
+    // so its address can't be reused by a different node.
+    struct CachedBounds {
+        Expr expr;
+        Interval interval;
+    };
+    std::map<std::tuple<const IRNode *, int, bool>, CachedBounds> cache;
+    int epoch = 0, next_epoch = 0;
+
+    struct ScopedEpoch {
+        Bounds *self;
+        int old_epoch;
+        ScopedEpoch(Bounds *self)
+            : self(self), old_epoch(self->epoch) {
+            self->epoch = ++self->next_epoch;
+        }
+        ~ScopedEpoch() {
+            self->epoch = old_epoch;
+        }
+    };
+
     Bounds(const Scope<Interval> *s, const FuncValueBounds &fb, bool const_bound)
         : func_bounds(fb), const_bound(const_bound) {
         scope.set_containing_scope(s);
@@ -209,6 +237,37 @@ private:
         }
     }
 
+    // Compute the bounds of e into interval, reusing a previous result
+    // for the same node if there is one. A node with a single reference
+    // can only be reached through its one parent, which is itself
+    // cached if it is shared, so only shared non-leaf nodes go through
+    // the cache.
+    void bounds_of(const Expr &e) {
+        switch (e->node_type) {
+        case IRNodeType::IntImm:
+        case IRNodeType::UIntImm:
+        case IRNodeType::FloatImm:
+        case IRNodeType::StringImm:
+        case IRNodeType::Variable:
+            e.accept(this);
+            return;
+        default:
+            break;
+        }
+        if (e->ref_count.is_const_one()) {
+            e.accept(this);
+            return;
+        }
+        auto key = std::make_tuple((const IRNode *)e.get(), epoch, const_bound);
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            interval = it->second.interval;
+            return;
+        }
+        e.accept(this);
+        cache.emplace(key, CachedBounds{e, interval});
+    }
+
     using IRVisitor::visit;
 
     void visit(const IntImm *op) override {
@@ -233,7 +292,7 @@ private:
 
     void visit(const Cast *op) override {
         TRACK_BOUNDS_INTERVAL;
-        op->value.accept(this);
+        bounds_of(op->value);
         Interval a = interval;
 
         if (a.is_single_point(op->value)) {
@@ -272,9 +331,9 @@ private:
                 // Then try to strip off junk mins and maxes.
                 bool old_constant_bound = const_bound;
                 const_bound = true;
-                a.min.accept(this);
+                bounds_of(a.min);
                 Expr lower_bound = interval.has_lower_bound() ? interval.min : Expr();
-                a.max.accept(this);
+                bounds_of(a.max);
                 Expr upper_bound = interval.has_upper_bound() ? interval.max : Expr();
                 const_bound = old_constant_bound;
 
@@ -381,9 +440,9 @@ private:
 
     void visit(const Add *op) override {
         TRACK_BOUNDS_INTERVAL;
-        op->a.accept(this);
+        bounds_of(op->a);
         Interval a = interval;
-        op->b.accept(this);
+        bounds_of(op->b);
         Interval b = interval;
 
         if (a.is_single_point(op->a) && b.is_single_point(op->b)) {
@@ -421,9 +480,9 @@ private:
 
     void visit(const Sub *op) override {
         TRACK_BOUNDS_INTERVAL;
-        op->a.accept(this);
+        bounds_of(op->a);
         Interval a = interval;
-        op->b.accept(this);
+        bounds_of(op->b);
         Interval b = interval;
 
         if (a.is_single_point(op->a) && b.is_single_point(op->b)) {
@@ -468,10 +527,10 @@ private:
 
     void visit(const Mul *op) override {
         TRACK_BOUNDS_INTERVAL;
-        op->a.accept(this);
+        bounds_of(op->a);
         Interval a = interval;
 
-        op->b.accept(this);
+        bounds_of(op->b);
         Interval b = interval;
 
         // Move constants to the right
@@ -538,10 +597,10 @@ private:
 
     void visit(const Div *op) override {
         TRACK_BOUNDS_INTERVAL;
-        op->a.accept(this);
+        bounds_of(op->a);
         Interval a = interval;
 
-        op->b.accept(this);
+        bounds_of(op->b);
         Interval b = interval;
 
         if (!b.is_bounded()) {
@@ -636,10 +695,10 @@ private:
 
     void visit(const Mod *op) override {
         TRACK_BOUNDS_INTERVAL;
-        op->a.accept(this);
+        bounds_of(op->a);
         Interval a = interval;
 
-        op->b.accept(this);
+        bounds_of(op->b);
         Interval b = interval;
 
         if (a.is_single_point(op->a) && b.is_single_point(op->b)) {
@@ -683,10 +742,10 @@ private:
 
     void visit(const Min *op) override {
         TRACK_BOUNDS_INTERVAL;
-        op->a.accept(this);
+        bounds_of(op->a);
         Interval a = interval;
 
-        op->b.accept(this);
+        bounds_of(op->b);
         Interval b = interval;
 
         if (a.is_single_point(op->a) && b.is_single_point(op->b)) {
@@ -699,10 +758,10 @@ private:
 
     void visit(const Max *op) override {
         TRACK_BOUNDS_INTERVAL;
-        op->a.accept(this);
+        bounds_of(op->a);
         Interval a = interval;
 
-        op->b.accept(this);
+        bounds_of(op->b);
         Interval b = interval;
 
         if (a.is_single_point(op->a) && b.is_single_point(op->b)) {
@@ -716,14 +775,14 @@ private:
     // only used for LT and LE - GT and GE normalize to LT and LTE
     template<typename Cmp>
     void visit_compare(const Expr &a_expr, const Expr &b_expr) {
-        a_expr.accept(this);
+        bounds_of(a_expr);
         if (!interval.has_upper_bound() && !interval.has_lower_bound()) {
             bounds_of_type(Bool());
             return;
         }
         Interval a = interval;
 
-        b_expr.accept(this);
+        bounds_of(b_expr);
         if (!interval.has_upper_bound() && !interval.has_lower_bound()) {
             bounds_of_type(Bool());
             return;
@@ -776,10 +835,10 @@ private:
 
     void visit(const EQ *op) override {
         TRACK_BOUNDS_INTERVAL;
-        op->a.accept(this);
+        bounds_of(op->a);
         Interval a = interval;
 
-        op->b.accept(this);
+        bounds_of(op->b);
         Interval b = interval;
 
         if (a.is_single_point(op->a) && b.is_single_point(op->b)) {
@@ -806,10 +865,10 @@ private:
 
     void visit(const NE *op) override {
         TRACK_BOUNDS_INTERVAL;
-        op->a.accept(this);
+        bounds_of(op->a);
         Interval a = interval;
 
-        op->b.accept(this);
+        bounds_of(op->b);
         Interval b = interval;
 
         if (a.is_single_point(op->a) && b.is_single_point(op->b)) {
@@ -856,10 +915,10 @@ private:
 
     void visit(const And *op) override {
         TRACK_BOUNDS_INTERVAL;
-        op->a.accept(this);
+        bounds_of(op->a);
         Interval a = interval;
 
-        op->b.accept(this);
+        bounds_of(op->b);
         Interval b = interval;
 
         if (a.is_single_point(op->a) && b.is_single_point(op->b)) {
@@ -891,10 +950,10 @@ private:
 
     void visit(const Or *op) override {
         TRACK_BOUNDS_INTERVAL;
-        op->a.accept(this);
+        bounds_of(op->a);
         Interval a = interval;
 
-        op->b.accept(this);
+        bounds_of(op->b);
         Interval b = interval;
 
         if (a.is_single_point(op->a) && b.is_single_point(op->b)) {
@@ -920,7 +979,7 @@ private:
 
     void visit(const Not *op) override {
         TRACK_BOUNDS_INTERVAL;
-        op->a.accept(this);
+        bounds_of(op->a);
         Interval a = interval;
 
         if (a.is_single_point(op->a)) {
@@ -935,13 +994,13 @@ private:
 
     void visit(const Select *op) override {
         TRACK_BOUNDS_INTERVAL;
-        op->true_value.accept(this);
+        bounds_of(op->true_value);
         Interval a = interval;
 
-        op->false_value.accept(this);
+        bounds_of(op->false_value);
         Interval b = interval;
 
-        op->condition.accept(this);
+        bounds_of(op->condition);
         Interval cond = interval;
 
         if (cond.is_single_point()) {
@@ -1019,7 +1078,7 @@ private:
 
     void visit(const Load *op) override {
         TRACK_BOUNDS_INTERVAL;
-        op->index.accept(this);
+        bounds_of(op->index);
         if (!const_bound && interval.is_single_point() && is_const_one(op->predicate)) {
             // If the index is const and it is not a predicated load,
             // we can return the load of that index
@@ -1040,12 +1099,13 @@ private:
         Expr var = Variable::make(op->base.type().element_of(), var_name);
         Expr lane = op->base + var * op->stride;
         ScopedBinding<Interval> p(scope, var_name, Interval(make_const(var.type(), 0), make_const(var.type(), op->lanes - 1)));
-        lane.accept(this);
+        ScopedEpoch e(this);
+        bounds_of(lane);
     }
 
     void visit(const Broadcast *op) override {
         TRACK_BOUNDS_INTERVAL;
-        op->value.accept(this);
+        bounds_of(op->value);
     }
 
     void visit(const Call *op) override {
@@ -1062,7 +1122,7 @@ private:
         // TODO: are any other intrinsics worth including here as well?
         if (op->is_intrinsic(Call::strict_float)) {
             internal_assert(op->args.size() == 1);
-            op->args[0].accept(this);
+            bounds_of(op->args[0]);
             return;
         }
 
@@ -1090,7 +1150,7 @@ private:
             std::vector<Expr> new_args(op->args.size());
             bool const_args = true;
             for (size_t i = 0; i < op->args.size() && const_args; i++) {
-                op->args[i].accept(this);
+                bounds_of(op->args[i]);
                 if (interval.is_single_point()) {
                     new_args[i] = interval.min;
                 } else {
@@ -1107,7 +1167,7 @@ private:
         }
 
         if (op->is_intrinsic(Call::abs)) {
-            op->args[0].accept(this);
+            bounds_of(op->args[0]);
             Interval a = interval;
             interval.min = make_zero(t);
             if (a.is_bounded()) {
@@ -1128,7 +1188,7 @@ private:
             internal_assert(!t.is_handle());
             if (t.is_float()) {
                 Expr e = abs(op->args[0] - op->args[1]);
-                e.accept(this);
+                bounds_of(e);
             } else {
                 // absd() for int types will always produce a uint result
                 internal_assert(t.is_uint());
@@ -1137,10 +1197,10 @@ private:
                 Expr b = op->args[1];
                 internal_assert(a.type() == b.type());
 
-                a.accept(this);
+                bounds_of(a);
                 Interval a_interval = interval;
 
-                b.accept(this);
+                bounds_of(b);
                 Interval b_interval = interval;
 
                 if (a_interval.is_bounded() && b_interval.is_bounded()) {
@@ -1154,11 +1214,11 @@ private:
                    op->is_intrinsic(Call::promise_clamped)) {
             // Unlike an explicit clamp, we are also permitted to
             // assume the upper bound is greater than the lower bound.
-            op->args[1].accept(this);
+            bounds_of(op->args[1]);
             Interval lower = interval;
-            op->args[2].accept(this);
+            bounds_of(op->args[2]);
             Interval upper = interval;
-            op->args[0].accept(this);
+            bounds_of(op->args[0]);
 
             if (op->is_intrinsic(Call::promise_clamped) &&
                 interval.is_single_point()) {
@@ -1193,27 +1253,27 @@ private:
         } else if (op->is_intrinsic(Call::likely) ||
                    op->is_intrinsic(Call::likely_if_innermost)) {
             internal_assert(op->args.size() == 1);
-            op->args[0].accept(this);
+            bounds_of(op->args[0]);
         } else if (op->is_intrinsic(Call::return_second)) {
             internal_assert(op->args.size() == 2);
-            op->args[1].accept(this);
+            bounds_of(op->args[1]);
         } else if (op->is_intrinsic(Call::if_then_else)) {
             internal_assert(op->args.size() == 3);
             // Probably more conservative than necessary
             Expr equivalent_select = Select::make(op->args[0], op->args[1], op->args[2]);
-            equivalent_select.accept(this);
+            bounds_of(equivalent_select);
         } else if (op->is_intrinsic(Call::require)) {
             internal_assert(op->args.size() == 3);
-            op->args[1].accept(this);
+            bounds_of(op->args[1]);
         } else if (op->is_intrinsic(Call::shift_left) ||
                    op->is_intrinsic(Call::shift_right) ||
                    op->is_intrinsic(Call::bitwise_xor) ||
                    op->is_intrinsic(Call::bitwise_and) ||
                    op->is_intrinsic(Call::bitwise_or)) {
             Expr a = op->args[0], b = op->args[1];
-            a.accept(this);
+            bounds_of(a);
             Interval a_interval = interval;
-            b.accept(this);
+            bounds_of(b);
             Interval b_interval = interval;
             if (a_interval.is_single_point(a) && b_interval.is_single_point(b)) {
                 interval = Interval::single_point(op);
@@ -1281,7 +1341,7 @@ private:
                         } else if (is_const(b)) {
                             // We can normalize to multiplication
                             Expr equiv = a * (make_const(t, 1) << b);
-                            equiv.accept(this);
+                            bounds_of(equiv);
                         }
                     } else if (op->is_intrinsic(Call::shift_right)) {
                         // Only try to improve on bounds-of-type if we can prove 0 <= b < t.bits,
@@ -1372,7 +1432,7 @@ private:
             // In 2's complement bitwise not inverts the ordering of
             // the space, without causing overflow (unlike negation),
             // so bitwise not is monotonic decreasing.
-            op->args[0].accept(this);
+            bounds_of(op->args[0]);
             Interval a_interval = interval;
             if (a_interval.is_single_point(op->args[0])) {
                 interval = Interval::single_point(op);
@@ -1412,7 +1472,7 @@ private:
             if (op->is_intrinsic(Call::count_leading_zeros)) {
                 // clz treats signed and unsigned ints the same way;
                 // cast all ints to uint to simplify this.
-                cast(op->type.with_code(halide_type_uint), op->args[0]).accept(this);
+                bounds_of(cast(op->type.with_code(halide_type_uint), op->args[0]));
                 Interval a = interval;
                 if (a.has_lower_bound()) {
                     max = cast(t, count_leading_zeros(a.min));
@@ -1424,7 +1484,7 @@ private:
             interval = Interval(min, max);
         } else if (op->is_intrinsic(Call::memoize_expr)) {
             internal_assert(!op->args.empty());
-            op->args[0].accept(this);
+            bounds_of(op->args[0]);
         } else if (op->call_type == Call::Halide) {
             bounds_of_func(op->name, op->value_index, op->type);
         } else {
@@ -1435,7 +1495,7 @@ private:
 
     void visit(const Let *op) override {
         TRACK_BOUNDS_INTERVAL;
-        op->value.accept(this);
+        bounds_of(op->value);
         Interval val = interval;
 
         // We'll either substitute the values in directly, or pass
@@ -1469,7 +1529,8 @@ private:
 
         {
             ScopedBinding<Interval> p(scope, op->name, var);
-            op->body.accept(this);
+            ScopedEpoch e(this);
+            bounds_of(op->body);
         }
 
         bool single_point = interval.is_single_point();
@@ -1505,7 +1566,7 @@ private:
         TRACK_BOUNDS_INTERVAL;
         Interval result = Interval::nothing();
         for (const Expr &i : op->vectors) {
-            i.accept(this);
+            bounds_of(i);
             result.include(interval);
         }
         interval = result;
@@ -1513,7 +1574,7 @@ private:
 
     void visit(const VectorReduce *op) override {
         TRACK_BOUNDS_INTERVAL;
-        op->value.accept(this);
+        bounds_of(op->value);
         int factor = op->value.type().lanes() / op->type.lanes();
         switch (op->op) {
         case VectorReduce::Add:
@@ -3094,6 +3155,15 @@ void bounds_test() {
     check(scope, Load::make(Int(8), "buf", x, Buffer<>(), Parameter(), const_true(), ModulusRemainder()),
           i8(-128), i8(127));
     check(scope, y + (Let::make("y", x + 3, y - x + 10)), y + 3, y + 23);  // Once again, we don't know that y is correlated with x
+    {
+        // The bounds of a shared subexpression are memoized, but must
+        // not be reused under a Let that rebinds one of its variables,
+        // nor leak out of it.
+        Expr e = x * 2 + 1;
+        check(scope, e + Let::make("x", 10, e), 22, 42);
+        check(scope, Let::make("x", 10, e) + e, 22, 42);
+        check(scope, Let::make("x", 3, e) + Let::make("x", 10, e), 28, 28);
+    }
     check(scope, clamp(1000 / (x - 2), x - 10, x + 10), -10, 20);
     check(scope, cast<uint16_t>(x / 2), u16(0), u16(5));
     check(scope, cast<uint16_t>((x + 10) / 2), u16(5), u16(10));
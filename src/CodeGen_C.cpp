@@ -3,7 +3,9 @@
 
 #include "CodeGen_C.h"
 #include "CodeGen_Internal.h"
+#include "ConciseCasts.h"
 #include "Deinterleave.h"
+#include "IRMatch.h"
 #include "IROperator.h"
 #include "Lerp.h"
 #include "Param.h"
@@ -67,6 +69,7 @@ const string headers = R"INLINE_CODE(
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <limits>
 #include <type_traits>
 )INLINE_CODE";
 
@@ -471,6 +474,55 @@ struct CppVector {
     }
 };
 
+// The element type of the result of widening_mul().
+template<typename T>
+struct CppVectorWidenedType { using type = T; };
+
+template<>
+struct CppVectorWidenedType<int8_t> { using type = int16_t; };
+
+template<>
+struct CppVectorWidenedType<int16_t> { using type = int32_t; };
+
+template<>
+struct CppVectorWidenedType<int32_t> { using type = int64_t; };
+
+template<>
+struct CppVectorWidenedType<uint8_t> { using type = uint16_t; };
+
+template<>
+struct CppVectorWidenedType<uint16_t> { using type = uint32_t; };
+
+template<>
+struct CppVectorWidenedType<uint32_t> { using type = uint64_t; };
+
+template<>
+struct CppVectorWidenedType<float> { using type = double; };
+
+// The element type of the result of absd().
+template<typename T>
+struct CppVectorAbsdType { using type = T; };
+
+template<>
+struct CppVectorAbsdType<int8_t> { using type = uint8_t; };
+
+template<>
+struct CppVectorAbsdType<int16_t> { using type = uint16_t; };
+
+template<>
+struct CppVectorAbsdType<int32_t> { using type = uint32_t; };
+
+template<>
+struct CppVectorAbsdType<int64_t> { using type = uint64_t; };
+
+// Clamp x to the range of T, for saturating_add() and saturating_sub(),
+// which are only used for 8- and 16-bit types.
+template<typename T>
+HALIDE_ALWAYS_INLINE T cpp_vector_saturate(const int64_t x) {
+    return (T)::halide_cpp_min<int64_t>(::halide_cpp_max<int64_t>(x, std::numeric_limits<T>::min()),
+                                        std::numeric_limits<T>::max());
+}
+
 template <typename ElementType_, size_t Lanes_>
 class CppVectorOps {
 public:
@@ -479,6 +531,8 @@ public:
 
     using Vec = CppVector<ElementType, Lanes>;
     using Mask = CppVector<uint8_t, Lanes>;
+    using WideVec = CppVector<typename CppVectorWidenedType<ElementType>::type, Lanes>;
+    using AbsdVec = CppVector<typename CppVectorAbsdType<ElementType>::type, Lanes>;
 
     CppVectorOps() = delete;
 
@@ -631,6 +685,40 @@ public:
         }
         return r;
     }
+
+    static Vec saturating_add(const Vec &a, const Vec &b) {
+        Vec r;
+        for (size_t i = 0; i < Lanes; i++) {
+            r[i] = cpp_vector_saturate<ElementType>((int64_t)a[i] + (int64_t)b[i]);
+        }
+        return r;
+    }
+
+    static Vec saturating_sub(const Vec &a, const Vec &b) {
+        Vec r;
+        for (size_t i = 0; i < Lanes; i++) {
+            r[i] = cpp_vector_saturate<ElementType>((int64_t)a[i] - (int64_t)b[i]);
+        }
+        return r;
+    }
+
+    static WideVec widening_mul(const Vec &a, const Vec &b) {
+        using WideElementType = typename CppVectorWidenedType<ElementType>::type;
+        WideVec r;
+        for (size_t i = 0; i < Lanes; i++) {
+            r[i] = (WideElementType)a[i] * (WideElementType)b[i];
+        }
+        return r;
+    }
+
+    static AbsdVec absd(const Vec &a, const Vec &b) {
+        using AbsdElementType = typename CppVectorAbsdType<ElementType>::type;
+        AbsdVec r;
+        for (size_t i = 0; i < Lanes; i++) {
+            r[i] = a[i] < b[i] ? (AbsdElementType)b[i] - (AbsdElementType)a[i] : (AbsdElementType)a[i] - (AbsdElementType)b[i];
+        }
+        return r;
+    }
 };
 
 template<typename ElementType, size_t Lanes>
@@ -986,6 +1074,8 @@ public:
 
     using Vec = NativeVector<ElementType, Lanes>;
     using Mask = NativeVector<uint8_t, Lanes>;
+    using WideVec = NativeVector<typename CppVectorWidenedType<ElementType>::type, Lanes>;
+    using AbsdVec = NativeVector<typename CppVectorAbsdType<ElementType>::type, Lanes>;
 
     NativeVectorOps() = delete;
 
@@ -1172,6 +1262,37 @@ public:
         const NativeVector<T, Lanes> r = a != b;
         return NativeVectorOps<uint8_t, Lanes>::convert_from(r);
     }
+
+    // The following have target-specific specializations below; these are the fallbacks.
+    static Vec saturating_add(const Vec a, const Vec b) {
+        Vec r;
+        for (size_t i = 0; i < Lanes; i++) {
+            r[i] = cpp_vector_saturate<ElementType>((int64_t)a[i] + (int64_t)b[i]);
+        }
+        return r;
+    }
+
+    static Vec saturating_sub(const Vec a, const Vec b) {
+        Vec r;
+        for (size_t i = 0; i < Lanes; i++) {
+            r[i] = cpp_vector_saturate<ElementType>((int64_t)a[i] - (int64_t)b[i]);
+        }
+        return r;
+    }
+
+    static WideVec widening_mul(const Vec a, const Vec b) {
+        using WideOps = NativeVectorOps<typename CppVectorWidenedType<ElementType>::type, Lanes>;
+        return WideOps::convert_from(a) * WideOps::convert_from(b);
+    }
+
+    static AbsdVec absd(const Vec a, const Vec b) {
+        using AbsdElementType = typename CppVectorAbsdType<ElementType>::type;
+        AbsdVec r;
+        for (size_t i = 0; i < Lanes; i++) {
+            r[i] = a[i] < b[i] ? (AbsdElementType)b[i] - (AbsdElementType)a[i] : (AbsdElementType)a[i] - (AbsdElementType)b[i];
+        }
+        return r;
+    }
 };
 
 
@@ -1202,6 +1323,216 @@ public:
     #define halide_cpp_use_native_vector(type, lanes) (false)
 #endif
 
+)INLINE_CODE";
+
+        const char *native_vector_intrinsics_decl = R"INLINE_CODE(
+// Specializations of NativeVectorOps that use the SIMD intrinsics of the
+// instruction sets the C++ compiler is targeting. Define
+// HALIDE_CPP_NO_VECTOR_INTRINSICS to use the generic implementations instead.
+#if !defined(__EMSCRIPTEN__) && (__has_attribute(ext_vector_type) || __has_attribute(vector_size)) && !HALIDE_CPP_NO_VECTOR_INTRINSICS
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// Specialize NativeVectorOps<T, LANES>::OP (which returns a RESULT) as EXPR,
+// with the arguments a and b reinterpreted as the intrinsic vector type NATIVE.
+#define HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(T, LANES, OP, RESULT, NATIVE, EXPR)               \
+    template<>                                                                               \
+    inline auto NativeVectorOps<T, LANES>::OP(const Vec a_, const Vec b_) -> RESULT {       \
+        NATIVE a, b;                                                                         \
+        memcpy(&a, &a_, sizeof(a));                                                          \
+        memcpy(&b, &b_, sizeof(b));                                                          \
+        const auto r_ = EXPR;                                                                \
+        RESULT r;                                                                            \
+        static_assert(sizeof(r) == sizeof(r_), "Intrinsic result does not match " #RESULT); \
+        memcpy(&r, &r_, sizeof(r));                                                          \
+        return r;                                                                            \
+    }
+
+#if defined(__SSE2__)
+
+inline __m128i halide_cpp_sse2_absd_u8(const __m128i a, const __m128i b) {
+    return _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+}
+
+inline __m128i halide_cpp_sse2_absd_i8(const __m128i a, const __m128i b) {
+    // Flipping the sign bits maps int8 onto uint8 monotonically.
+    const __m128i bias = _mm_set1_epi8(-128);
+    return halide_cpp_sse2_absd_u8(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+}
+
+// The widening multiplies below produce their results in two halves.
+inline NativeVector<uint16_t, 16> halide_cpp_sse2_mul_wide_u8(const __m128i a, const __m128i b) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i halves[2] = {_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)),
+                               _mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero))};
+    NativeVector<uint16_t, 16> r;
+    memcpy(&r, halves, sizeof(r));
+    return r;
+}
+
+inline NativeVector<int16_t, 16> halide_cpp_sse2_mul_wide_i8(const __m128i a, const __m128i b) {
+    // Unpacking a vector with itself and shifting right arithmetically sign-extends it.
+    const __m128i halves[2] = {_mm_mullo_epi16(_mm_srai_epi16(_mm_unpacklo_epi8(a, a), 8), _mm_srai_epi16(_mm_unpacklo_epi8(b, b), 8)),
+                               _mm_mullo_epi16(_mm_srai_epi16(_mm_unpackhi_epi8(a, a), 8), _mm_srai_epi16(_mm_unpackhi_epi8(b, b), 8))};
+    NativeVector<int16_t, 16> r;
+    memcpy(&r, halves, sizeof(r));
+    return r;
+}
+
+inline NativeVector<uint32_t, 8> halide_cpp_sse2_mul_wide_u16(const __m128i a, const __m128i b) {
+    const __m128i lo = _mm_mullo_epi16(a, b);
+    const __m128i hi = _mm_mulhi_epu16(a, b);
+    const __m128i halves[2] = {_mm_unpacklo_epi16(lo, hi), _mm_unpackhi_epi16(lo, hi)};
+    NativeVector<uint32_t, 8> r;
+    memcpy(&r, halves, sizeof(r));
+    return r;
+}
+
+inline NativeVector<int32_t, 8> halide_cpp_sse2_mul_wide_i16(const __m128i a, const __m128i b) {
+    const __m128i lo = _mm_mullo_epi16(a, b);
+    const __m128i hi = _mm_mulhi_epi16(a, b);
+    const __m128i halves[2] = {_mm_unpacklo_epi16(lo, hi), _mm_unpackhi_epi16(lo, hi)};
+    NativeVector<int32_t, 8> r;
+    memcpy(&r, halves, sizeof(r));
+    return r;
+}
+
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint8_t, 16, saturating_add, Vec, __m128i, _mm_adds_epu8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int8_t, 16, saturating_add, Vec, __m128i, _mm_adds_epi8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint16_t, 8, saturating_add, Vec, __m128i, _mm_adds_epu16(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int16_t, 8, saturating_add, Vec, __m128i, _mm_adds_epi16(a, b))
+
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint8_t, 16, saturating_sub, Vec, __m128i, _mm_subs_epu8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int8_t, 16, saturating_sub, Vec, __m128i, _mm_subs_epi8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint16_t, 8, saturating_sub, Vec, __m128i, _mm_subs_epu16(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int16_t, 8, saturating_sub, Vec, __m128i, _mm_subs_epi16(a, b))
+
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint8_t, 16, widening_mul, WideVec, __m128i, halide_cpp_sse2_mul_wide_u8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int8_t, 16, widening_mul, WideVec, __m128i, halide_cpp_sse2_mul_wide_i8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint16_t, 8, widening_mul, WideVec, __m128i, halide_cpp_sse2_mul_wide_u16(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int16_t, 8, widening_mul, WideVec, __m128i, halide_cpp_sse2_mul_wide_i16(a, b))
+
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint8_t, 16, absd, AbsdVec, __m128i, halide_cpp_sse2_absd_u8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int8_t, 16, absd, AbsdVec, __m128i, halide_cpp_sse2_absd_i8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint16_t, 8, absd, AbsdVec, __m128i, _mm_or_si128(_mm_subs_epu16(a, b), _mm_subs_epu16(b, a)))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int16_t, 8, absd, AbsdVec, __m128i, _mm_sub_epi16(_mm_max_epi16(a, b), _mm_min_epi16(a, b)))
+
+#endif  // __SSE2__
+
+#if defined(__AVX2__)
+
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint8_t, 32, saturating_add, Vec, __m256i, _mm256_adds_epu8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int8_t, 32, saturating_add, Vec, __m256i, _mm256_adds_epi8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint16_t, 16, saturating_add, Vec, __m256i, _mm256_adds_epu16(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int16_t, 16, saturating_add, Vec, __m256i, _mm256_adds_epi16(a, b))
+
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint8_t, 32, saturating_sub, Vec, __m256i, _mm256_subs_epu8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int8_t, 32, saturating_sub, Vec, __m256i, _mm256_subs_epi8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint16_t, 16, saturating_sub, Vec, __m256i, _mm256_subs_epu16(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int16_t, 16, saturating_sub, Vec, __m256i, _mm256_subs_epi16(a, b))
+
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint8_t, 32, absd, AbsdVec, __m256i, _mm256_sub_epi8(_mm256_max_epu8(a, b), _mm256_min_epu8(a, b)))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int8_t, 32, absd, AbsdVec, __m256i, _mm256_sub_epi8(_mm256_max_epi8(a, b), _mm256_min_epi8(a, b)))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint16_t, 16, absd, AbsdVec, __m256i, _mm256_sub_epi16(_mm256_max_epu16(a, b), _mm256_min_epu16(a, b)))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int16_t, 16, absd, AbsdVec, __m256i, _mm256_sub_epi16(_mm256_max_epi16(a, b), _mm256_min_epi16(a, b)))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint32_t, 8, absd, AbsdVec, __m256i, _mm256_sub_epi32(_mm256_max_epu32(a, b), _mm256_min_epu32(a, b)))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int32_t, 8, absd, AbsdVec, __m256i, _mm256_sub_epi32(_mm256_max_epi32(a, b), _mm256_min_epi32(a, b)))
+
+#endif  // __AVX2__
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+// The widening multiplies below produce their results in two halves.
+inline NativeVector<uint16_t, 16> halide_cpp_neon_mull_u8x16(const uint8x16_t a, const uint8x16_t b) {
+    const uint16x8_t halves[2] = {vmull_u8(vget_low_u8(a), vget_low_u8(b)), vmull_u8(vget_high_u8(a), vget_high_u8(b))};
+    NativeVector<uint16_t, 16> r;
+    memcpy(&r, halves, sizeof(r));
+    return r;
+}
+
+inline NativeVector<int16_t, 16> halide_cpp_neon_mull_i8x16(const int8x16_t a, const int8x16_t b) {
+    const int16x8_t halves[2] = {vmull_s8(vget_low_s8(a), vget_low_s8(b)), vmull_s8(vget_high_s8(a), vget_high_s8(b))};
+    NativeVector<int16_t, 16> r;
+    memcpy(&r, halves, sizeof(r));
+    return r;
+}
+
+inline NativeVector<uint32_t, 8> halide_cpp_neon_mull_u16x8(const uint16x8_t a, const uint16x8_t b) {
+    const uint32x4_t halves[2] = {vmull_u16(vget_low_u16(a), vget_low_u16(b)), vmull_u16(vget_high_u16(a), vget_high_u16(b))};
+    NativeVector<uint32_t, 8> r;
+    memcpy(&r, halves, sizeof(r));
+    return r;
+}
+
+inline NativeVector<int32_t, 8> halide_cpp_neon_mull_i16x8(const int16x8_t a, const int16x8_t b) {
+    const int32x4_t halves[2] = {vmull_s16(vget_low_s16(a), vget_low_s16(b)), vmull_s16(vget_high_s16(a), vget_high_s16(b))};
+    NativeVector<int32_t, 8> r;
+    memcpy(&r, halves, sizeof(r));
+    return r;
+}
+
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint8_t, 8, saturating_add, Vec, uint8x8_t, vqadd_u8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint8_t, 16, saturating_add, Vec, uint8x16_t, vqaddq_u8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int8_t, 8, saturating_add, Vec, int8x8_t, vqadd_s8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int8_t, 16, saturating_add, Vec, int8x16_t, vqaddq_s8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint16_t, 4, saturating_add, Vec, uint16x4_t, vqadd_u16(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint16_t, 8, saturating_add, Vec, uint16x8_t, vqaddq_u16(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int16_t, 4, saturating_add, Vec, int16x4_t, vqadd_s16(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int16_t, 8, saturating_add, Vec, int16x8_t, vqaddq_s16(a, b))
+
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint8_t, 8, saturating_sub, Vec, uint8x8_t, vqsub_u8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint8_t, 16, saturating_sub, Vec, uint8x16_t, vqsubq_u8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int8_t, 8, saturating_sub, Vec, int8x8_t, vqsub_s8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int8_t, 16, saturating_sub, Vec, int8x16_t, vqsubq_s8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint16_t, 4, saturating_sub, Vec, uint16x4_t, vqsub_u16(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint16_t, 8, saturating_sub, Vec, uint16x8_t, vqsubq_u16(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int16_t, 4, saturating_sub, Vec, int16x4_t, vqsub_s16(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int16_t, 8, saturating_sub, Vec, int16x8_t, vqsubq_s16(a, b))
+
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint8_t, 8, widening_mul, WideVec, uint8x8_t, vmull_u8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint8_t, 16, widening_mul, WideVec, uint8x16_t, halide_cpp_neon_mull_u8x16(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int8_t, 8, widening_mul, WideVec, int8x8_t, vmull_s8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int8_t, 16, widening_mul, WideVec, int8x16_t, halide_cpp_neon_mull_i8x16(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint16_t, 4, widening_mul, WideVec, uint16x4_t, vmull_u16(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint16_t, 8, widening_mul, WideVec, uint16x8_t, halide_cpp_neon_mull_u16x8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int16_t, 4, widening_mul, WideVec, int16x4_t, vmull_s16(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int16_t, 8, widening_mul, WideVec, int16x8_t, halide_cpp_neon_mull_i16x8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint32_t, 2, widening_mul, WideVec, uint32x2_t, vmull_u32(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int32_t, 2, widening_mul, WideVec, int32x2_t, vmull_s32(a, b))
+
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint8_t, 8, absd, AbsdVec, uint8x8_t, vabd_u8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint8_t, 16, absd, AbsdVec, uint8x16_t, vabdq_u8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int8_t, 8, absd, AbsdVec, int8x8_t, vabd_s8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int8_t, 16, absd, AbsdVec, int8x16_t, vabdq_s8(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint16_t, 4, absd, AbsdVec, uint16x4_t, vabd_u16(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint16_t, 8, absd, AbsdVec, uint16x8_t, vabdq_u16(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int16_t, 4, absd, AbsdVec, int16x4_t, vabd_s16(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int16_t, 8, absd, AbsdVec, int16x8_t, vabdq_s16(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint32_t, 2, absd, AbsdVec, uint32x2_t, vabd_u32(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(uint32_t, 4, absd, AbsdVec, uint32x4_t, vabdq_u32(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int32_t, 2, absd, AbsdVec, int32x2_t, vabd_s32(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(int32_t, 4, absd, AbsdVec, int32x4_t, vabdq_s32(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(float, 2, absd, AbsdVec, float32x2_t, vabd_f32(a, b))
+HALIDE_CPP_NATIVE_VECTOR_INTRINSIC(float, 4, absd, AbsdVec, float32x4_t, vabdq_f32(a, b))
+
+#endif  // __ARM_NEON
+
+#undef HALIDE_CPP_NATIVE_VECTOR_INTRINSIC
+
+}  // namespace
+
+#endif  // !HALIDE_CPP_NO_VECTOR_INTRINSICS
+
 )INLINE_CODE";
 
         // Vodoo fix: on at least one config (our arm32 buildbot running gcc 5.4),
@@ -1209,7 +1540,7 @@ public:
         // flushing the stream before or after heals it. Since C++ codegen is rarely
         // on a compilation critical path, we'll just band-aid it in this way.
         stream << std::flush;
-        stream << cpp_vector_decl << native_vector_decl << vector_selection_decl;
+        stream << cpp_vector_decl << native_vector_decl << vector_selection_decl << native_vector_intrinsics_decl;
         stream << std::flush;
 
         for (const auto &t : vector_types) {
@@ -1615,6 +1946,11 @@ void CodeGen_C::compile(const LoweredFunc &f) {
 
         // And also the metadata.
         stream << "\nHALIDE_FUNCTION_ATTRS\nconst struct halide_filter_metadata_t *" << simple_name << "_metadata();\n";
+
+        // And the batched entry point, if requested.
+        if (target.has_feature(Target::Batch)) {
+            stream << "\nHALIDE_FUNCTION_ATTRS\nint " << simple_name << "_batch(void **batch_args[], int batch_size);\n";
+        }
     }
 
     if (!namespaces.empty()) {
@@ -1756,6 +2092,48 @@ void CodeGen_C::visit(const Variable *op) {
 }
 
 void CodeGen_C::visit(const Cast *op) {
+    if (op->type.is_vector() && using_vector_typedefs) {
+        // Saturating arithmetic maps onto the vector ops' saturating_add
+        // and saturating_sub, which use intrinsics where available. The
+        // vector ops only exist in our own prelude, not in the languages
+        // of the GPU backends that derive from us.
+        struct Pattern {
+            const char *op;
+            Expr pattern;
+        };
+
+        static const Expr wild_i16x = Variable::make(Int(16, 0), "*");
+        static const Expr wild_i32x = Variable::make(Int(32, 0), "*");
+        static const Expr wild_u16x = Variable::make(UInt(16, 0), "*");
+        static const Expr wild_u32x = Variable::make(UInt(32, 0), "*");
+
+        // clang-format off
+        static const Pattern patterns[] = {
+            {"saturating_add", ConciseCasts::i8_sat(wild_i16x + wild_i16x)},
+            {"saturating_sub", ConciseCasts::i8_sat(wild_i16x - wild_i16x)},
+            {"saturating_add", ConciseCasts::i16_sat(wild_i32x + wild_i32x)},
+            {"saturating_sub", ConciseCasts::i16_sat(wild_i32x - wild_i32x)},
+            {"saturating_add", ConciseCasts::u8_sat(wild_u16x + wild_u16x)},
+            {"saturating_sub", ConciseCasts::u8(max(wild_i16x - wild_i16x, 0))},
+            {"saturating_add", ConciseCasts::u16_sat(wild_u32x + wild_u32x)},
+            {"saturating_sub", ConciseCasts::u16(max(wild_i32x - wild_i32x, 0))},
+        };
+        // clang-format on
+
+        vector<Expr> matches;
+        for (const Pattern &p : patterns) {
+            if (expr_match(p.pattern, op, matches)) {
+                Expr a = lossless_cast(op->type, matches[0]);
+                Expr b = lossless_cast(op->type, matches[1]);
+                if (a.defined() && b.defined()) {
+                    string sa = print_expr(a);
+                    string sb = print_expr(b);
+                    print_assignment(op->type, print_type(op->type) + "_ops::" + p.op + "(" + sa + ", " + sb + ")");
+                    return;
+                }
+            }
+        }
+    }
     id = print_cast_expr(op->type, op->value);
 }
 
@@ -1774,6 +2152,29 @@ void CodeGen_C::visit(const Sub *op) {
 }
 
 void CodeGen_C::visit(const Mul *op) {
+    if (op->type.is_vector() && using_vector_typedefs &&
+        op->type.is_int_or_uint() && op->type.bits() >= 16) {
+        // A multiply of values widened from the half-width type can use
+        // widening_mul, which uses intrinsics where available. Require
+        // one side to be an actual widening cast, so that the narrow
+        // vector type is known to have been declared.
+        Type narrow = op->type.narrow();
+        Expr a = op->a, b = op->b;
+        const Cast *cast_a = a.as<Cast>();
+        if (!cast_a || cast_a->value.type() != narrow) {
+            std::swap(a, b);
+            cast_a = a.as<Cast>();
+        }
+        if (cast_a && cast_a->value.type() == narrow) {
+            Expr narrow_b = lossless_cast(narrow, b);
+            if (narrow_b.defined()) {
+                string sa = print_expr(cast_a->value);
+                string sb = print_expr(narrow_b);
+                print_assignment(op->type, print_type(narrow) + "_ops::widening_mul(" + sa + ", " + sb + ")");
+                return;
+            }
+        }
+    }
     visit_binop(op->type, op->a, op->b, "*");
 }
 
@@ -2013,8 +2414,14 @@ void CodeGen_C::visit(const Call *op) {
         internal_assert(op->args.size() == 2);
         Expr a = op->args[0];
         Expr b = op->args[1];
-        Expr e = cast(op->type, select(a < b, b - a, a - b));
-        rhs << print_expr(e);
+        if (op->type.is_vector() && using_vector_typedefs) {
+            string sa = print_expr(a);
+            string sb = print_expr(b);
+            rhs << print_type(a.type()) << "_ops::absd(" << sa << ", " << sb << ")";
+        } else {
+            Expr e = cast(op->type, select(a < b, b - a, a - b));
+            rhs << print_expr(e);
+        }
     } else if (op->is_intrinsic(Call::return_second)) {
         internal_assert(op->args.size() == 2);
         string arg0 = print_expr(op->args[0]);
@@ -4,6 +4,7 @@
 #include <mutex>
 #include <sstream>
 
+#include "BatchWrapper.h"
 #include "CPlusPlusMangle.h"
 #include "CSE.h"
 #include "CodeGen_ARM.h"
@@ -410,6 +411,7 @@ struct MangledNames {
     string extern_name;
     string argv_name;
     string metadata_name;
+    string batch_name;
 };
 
 MangledNames get_mangled_names(const std::string &name,
@@ -423,6 +425,7 @@ MangledNames get_mangled_names(const std::string &name,
     names.extern_name = names.simple_name;
     names.argv_name = names.simple_name + "_argv";
     names.metadata_name = names.simple_name + "_metadata";
+    names.batch_name = names.simple_name + "_batch";
 
     if (linkage != LinkageType::Internal &&
         ((mangling == NameMangling::Default &&
@@ -443,6 +446,10 @@ MangledNames get_mangled_names(const std::string &name,
         Type void_star_star(Handle(1, &inner_type));
         names.argv_name = cplusplus_function_mangled_name(names.argv_name, namespaces, type_of<int>(), {ExternFuncArgument(make_zero(void_star_star))}, target);
         names.metadata_name = cplusplus_function_mangled_name(names.metadata_name, namespaces, type_of<const struct halide_filter_metadata_t *>(), {}, target);
+        halide_handle_cplusplus_type batch_inner_type(halide_cplusplus_type_name(halide_cplusplus_type_name::Simple, "void"), {}, {},
+                                                      {halide_handle_cplusplus_type::Pointer, halide_handle_cplusplus_type::Pointer, halide_handle_cplusplus_type::Pointer});
+        Type void_star_star_star(Handle(1, &batch_inner_type));
+        names.batch_name = cplusplus_function_mangled_name(names.batch_name, namespaces, type_of<int>(), {ExternFuncArgument(make_zero(void_star_star_star)), ExternFuncArgument(make_zero(Int(32)))}, target);
     }
     return names;
 }
@@ -551,6 +558,12 @@ std::unique_ptr<llvm::Module> CodeGen_LLVM::compile(const Module &input) {
 
     add_external_code(input);
 
+    struct BatchEntryPoint {
+        llvm::Function *wrapper, *metadata_getter;
+        std::string simple_name, batch_name;
+    };
+    std::vector<BatchEntryPoint> batch_entry_points;
+
     // Generate the code for this module.
     debug(1) << "Generating llvm bitcode...\n";
     for (const auto &b : input.buffers()) {
@@ -571,7 +584,21 @@ std::unique_ptr<llvm::Module> CodeGen_LLVM::compile(const Module &input) {
             if (target.has_feature(Target::Matlab)) {
                 define_matlab_wrapper(module.get(), wrapper, metadata_getter);
             }
+            if (target.has_feature(Target::Batch)) {
+                batch_entry_points.push_back({wrapper, metadata_getter, names.simple_name, names.batch_name});
+            }
+        }
+    }
+
+    // The unchecked variant of a pipeline, if any, is only compiled after
+    // its public entry point.
+    for (const auto &b : batch_entry_points) {
+        llvm::Function *unchecked_wrapper = nullptr;
+        if (llvm::Function *unchecked = module->getFunction(b.simple_name + "_unchecked")) {
+            unchecked_wrapper = add_argv_wrapper(unchecked, b.simple_name + "_unchecked_argv");
+            unchecked_wrapper->setLinkage(llvm::GlobalValue::InternalLinkage);
         }
+        define_batch_wrapper(module.get(), b.wrapper, unchecked_wrapper, b.metadata_getter, b.batch_name);
     }
 
     debug(2) << module.get() << "\n";
@@ -22,6 +22,42 @@ CodeGen_Posix::CodeGen_Posix(Target t)
     : CodeGen_LLVM(t) {
 }
 
+void CodeGen_Posix::begin_func(LinkageType linkage, const std::string &simple_name,
+                               const std::string &extern_name, const std::vector<LoweredArgument> &args) {
+    workspace = nullptr;
+    workspace_name = extern_name + ".workspace";
+    workspace_release_name = simple_name + "_release_workspace";
+    workspace_slots = 0;
+    CodeGen_LLVM::begin_func(linkage, simple_name, extern_name, args);
+}
+
+void CodeGen_Posix::define_workspace_release() {
+    // AOT code keeps its workspace until halide_release_workspaces() is
+    // called, so there's nothing to define.
+    if (!target.has_feature(Target::JIT)) {
+        return;
+    }
+
+    llvm::Function *release_fn = module->getFunction("halide_release_workspace");
+    internal_assert(release_fn) << "Could not find halide_release_workspace in module\n";
+
+    llvm::Function::arg_iterator arg_iter = release_fn->arg_begin();
+    llvm::Type *user_context_ty = arg_iter->getType();
+    ++arg_iter;
+    llvm::Type *workspace_ty = arg_iter->getType();
+
+    FunctionType *release_ty = FunctionType::get(void_t, {user_context_ty}, false);
+    llvm::Function *release = llvm::Function::Create(release_ty, llvm::GlobalValue::ExternalLinkage,
+                                                     workspace_release_name, module.get());
+    IRBuilderBase::InsertPoint here = builder->saveIP();
+    builder->SetInsertPoint(BasicBlock::Create(*context, "entry", release));
+    Value *args[2] = {iterator_to_pointer(release->arg_begin()),
+                      builder->CreatePointerCast(workspace, workspace_ty)};
+    builder->CreateCall(release_fn, args);
+    builder->CreateRetVoid();
+    builder->restoreIP(here);
+}
+
 Value *CodeGen_Posix::codegen_allocation_size(const std::string &name, Type type, const std::vector<Expr> &extents, const Expr &condition) {
     // Compute size from list of extents checking for overflow.
 
@@ -239,6 +275,36 @@ CodeGen_Posix::Allocation CodeGen_Posix::create_allocation(const std::string &na
     } else {
         if (new_expr.defined()) {
             allocation.ptr = codegen(new_expr);
+        } else if (target.has_feature(Target::PersistentWorkspace) && free_function.empty()) {
+            // Allocate from this site's slot in the function's
+            // persistent workspace, which keeps the memory around for
+            // the next call.
+            if (!workspace) {
+                llvm::Type *ptr_ty = i8_t->getPointerTo();
+                workspace = new GlobalVariable(*module, ptr_ty, false, GlobalValue::PrivateLinkage,
+                                               ConstantPointerNull::get(cast<PointerType>(ptr_ty)),
+                                               workspace_name);
+                define_workspace_release();
+            }
+            llvm::Function *malloc_fn = module->getFunction("halide_workspace_malloc");
+            internal_assert(malloc_fn) << "Could not find halide_workspace_malloc in module\n";
+            malloc_fn->setReturnDoesNotAlias();
+
+            llvm::Function::arg_iterator arg_iter = malloc_fn->arg_begin();
+            ++arg_iter;  // skip the user context *
+            Value *workspace_ptr = builder->CreatePointerCast(workspace, arg_iter->getType());
+            ++arg_iter;  // skip the workspace **
+            Value *slot = ConstantInt::get(arg_iter->getType(), workspace_slots++);
+            ++arg_iter;  // skip the slot index
+            llvm_size = builder->CreateIntCast(llvm_size, arg_iter->getType(), false);
+
+            debug(4) << "Creating call to halide_workspace_malloc for allocation " << name
+                     << " in slot " << workspace_slots - 1 << "\n";
+            Value *args[4] = {get_user_context(), workspace_ptr, slot, llvm_size};
+            Value *call = builder->CreateCall(malloc_fn, args);
+
+            allocation.ptr = builder->CreatePointerCast(call, llvm_type_of(type)->getPointerTo());
+            free_function = "halide_workspace_free";
         } else {
             // call malloc
             llvm::Function *malloc_fn = module->getFunction("halide_malloc");
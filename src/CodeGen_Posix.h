@@ -28,6 +28,12 @@ protected:
     void visit(const Free *) override;
     // @}
 
+    /** Resets the persistent workspace state (see
+     * Target::PersistentWorkspace) before delegating to
+     * CodeGen_LLVM. */
+    void begin_func(LinkageType linkage, const std::string &simple_name,
+                    const std::string &extern_name, const std::vector<LoweredArgument> &args) override;
+
     /** It can be convenient for backends to assume there is extra
      * padding beyond the end of a buffer to enable faster
      * loads/stores. This function gets the padding required by the
@@ -82,6 +88,21 @@ private:
      * for debug output purposes. */
     size_t cur_stack_alloc_total{0};
 
+    /** With Target::PersistentWorkspace, the global holding the
+     * workspace of the function being compiled (created on its first
+     * heap allocation), its name, and the number of heap allocation
+     * sites, each of which gets its own slot in the workspace. */
+    // @{
+    llvm::GlobalVariable *workspace = nullptr;
+    std::string workspace_name, workspace_release_name;
+    int workspace_slots = 0;
+    // @}
+
+    /** When JIT compiling, define <name>_release_workspace(void
+     * *user_context), which the owner of the JIT module calls to free the
+     * workspace of the function being compiled before unloading it. */
+    void define_workspace_release();
+
     /** Generates code for computing the size of an allocation from a
      * list of its extents and its size. Fires a runtime assert
      * (halide_error) if the size overflows 2^31 -1, the maximum
@@ -105,23 +105,23 @@ void CodeGen_PyTorch::compile(const LoweredFunc &f, bool is_cuda) {
         stream << get_indent() << "void* __user_context = (void*) &user_ctx;\n\n";
     }
 
-    stream << get_indent() << "// Check tensors have contiguous memory and are on the correct device\n";
-    for (size_t i = 0; i < buffer_args.size(); i++) {
-        stream << get_indent();
-        stream
-            << "HLPT_CHECK_CONTIGUOUS("
-            << c_print_name(buffer_args[i].name)
-            << ");\n";
+    stream << get_indent() << "// Use no more threads than ATen does, if requested\n";
+    stream << get_indent() << "Halide::PyTorch::set_num_threads_from_aten();\n";
+    stream << "\n";
 
-        if (is_cuda) {
+    // Tensors don't need to be contiguous: the pipeline checks the strides
+    // of its buffers itself, so only check where the data is.
+    if (is_cuda) {
+        stream << get_indent() << "// Check tensors are on the correct device\n";
+        for (size_t i = 0; i < buffer_args.size(); i++) {
             stream << get_indent();
             stream
                 << "HLPT_CHECK_DEVICE("
                 << c_print_name(buffer_args[i].name)
                 << ", device_id);\n";
         }
+        stream << "\n";
     }
-    stream << "\n";
 
     stream << get_indent() << "// Wrap tensors in Halide buffers\n";
     for (size_t i = 0; i < buffer_args.size(); i++) {
@@ -296,8 +296,8 @@ int test1(struct halide_buffer_t *_buf_buffer, float _alpha, int32_t _beta);
 
 HALIDE_FUNCTION_ATTRS
 inline int test1_th_(at::Tensor &_buf, float _alpha, int32_t _beta) {
-    // Check tensors have contiguous memory and are on the correct device
-    HLPT_CHECK_CONTIGUOUS(_buf);
+    // Use no more threads than ATen does, if requested
+    Halide::PyTorch::set_num_threads_from_aten();
 
     // Wrap tensors in Halide buffers
     Halide::Runtime::Buffer<int32_t> _buf_buffer = Halide::PyTorch::wrap<int32_t>(_buf);
@@ -373,8 +373,10 @@ inline int test1_th_(at::Tensor &_buf, float _alpha, int32_t _beta) {
     Halide::PyTorch::UserContext user_ctx(device_id, &ctx, &stream);
     void* __user_context = (void*) &user_ctx;
 
-    // Check tensors have contiguous memory and are on the correct device
-    HLPT_CHECK_CONTIGUOUS(_buf);
+    // Use no more threads than ATen does, if requested
+    Halide::PyTorch::set_num_threads_from_aten();
+
+    // Check tensors are on the correct device
     HLPT_CHECK_DEVICE(_buf, device_id);
 
     // Wrap tensors in Halide buffers
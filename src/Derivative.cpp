@@ -3,6 +3,7 @@
 #include <set>
 
 #include "Associativity.h"
+#include "AutoScheduleUtils.h"
 #include "BoundaryConditions.h"
 #include "CSE.h"
 #include "Debug.h"
@@ -14,6 +15,7 @@
 #include "IREquality.h"
 #include "IRMutator.h"
 #include "IROperator.h"
+#include "Inline.h"
 #include "RealizationOrder.h"
 #include "Simplify.h"
 #include "Solve.h"
@@ -37,6 +39,20 @@ bool is_float_extern(const string &op_name,
            op_name == (func_name + "_f64");
 };
 
+// Count the IR nodes of an Expr, as a rough measure of the cost of
+// recomputing it.
+class CountNodes : public IRGraphVisitor {
+    using IRGraphVisitor::include;
+
+    void include(const Expr &e) override {
+        count++;
+        IRGraphVisitor::include(e);
+    }
+
+public:
+    int count = 0;
+};
+
 /** Compute derivatives through reverse accumulation
  */
 class ReverseAccumulationVisitor : public IRVisitor {
@@ -49,6 +65,8 @@ public:
         return adjoint_funcs;
     }
 
+    vector<Checkpoint> apply_checkpoint_policy(const CheckpointPolicy &policy);
+
 protected:
     void visit(const IntImm *) override;
     void visit(const UIntImm *) override;
@@ -155,6 +173,8 @@ private:
     map<const BaseExprNode *, Expr> expr_adjoints;
     // For each function and each update, we store the accumulated adjoints func
     map<FuncKey, Func> adjoint_funcs;
+    // The forward functions in realization order
+    vector<Func> forward_funcs;
     // Let variables and their mapping
     map<string, Expr> let_var_mapping;
     vector<string> let_variables;
@@ -195,6 +215,7 @@ void ReverseAccumulationVisitor::propagate_adjoints(
         funcs.emplace_back(env[func_name]);
     }
     internal_assert(!funcs.empty());
+    forward_funcs = funcs;
 
     // If the derivatives depend on an in-place overwrite,
     // and the self reference adjoint is not 0 or 1,
@@ -759,6 +780,177 @@ void ReverseAccumulationVisitor::propagate_adjoints(
     }
 }
 
+vector<Checkpoint> ReverseAccumulationVisitor::apply_checkpoint_policy(
+    const CheckpointPolicy &policy) {
+    map<string, Function> forward;
+    for (const Func &func : forward_funcs) {
+        forward.emplace(func.name(), func.function());
+    }
+
+    set<string> recompute;
+    for (const Func &func : policy.recompute) {
+        user_assert(forward.find(func.name()) != forward.end())
+            << "Cannot recompute " << func.name() << " in the backward pass, "
+            << "because the output does not depend on it.\n";
+        user_assert(func.function().can_be_inlined())
+            << "Cannot recompute " << func.name() << " in the backward pass. "
+            << "Only pure Funcs without specializations can be recomputed.\n";
+        recompute.insert(func.name());
+    }
+
+    // The backward pass is the adjoints, and any Funcs they call
+    // that are not part of the forward pass.
+    map<string, Function> backward;
+    for (const auto &it : adjoint_funcs) {
+        for (const auto &call : find_transitive_calls(it.second.function())) {
+            if (forward.find(call.first) == forward.end()) {
+                backward.insert(call);
+            }
+        }
+    }
+
+    // Find the forward Funcs the backward pass reads.
+    auto find_forward_reads = [&]() {
+        set<string> reads;
+        for (const auto &it : backward) {
+            for (const auto &call : find_direct_calls(it.second)) {
+                if (forward.find(call.first) != forward.end()) {
+                    reads.insert(call.first);
+                }
+            }
+        }
+        return reads;
+    };
+
+    // Estimate the footprint of a forward Func over the region the
+    // gradient needs, using the estimates of any parameters.
+    auto estimate_bytes = [&](const string &name) -> int64_t {
+        auto it = func_bounds.find(name);
+        if (it == func_bounds.end()) {
+            return -1;
+        }
+        Expr size = box_size(it->second);
+        if (!size.defined()) {
+            return -1;
+        }
+        const int64_t *points = as_const_int(simplify(substitute_var_estimates(size)));
+        if (points == nullptr) {
+            return -1;
+        }
+        int64_t bytes_per_point = 0;
+        for (const Type &t : forward[name].output_types()) {
+            bytes_per_point += t.bytes();
+        }
+        return *points * bytes_per_point;
+    };
+
+    set<string> reads = find_forward_reads();
+    map<string, int64_t> bytes;
+    for (const Func &func : forward_funcs) {
+        bytes[func.name()] = estimate_bytes(func.name());
+    }
+
+    if (policy.memory_budget > 0) {
+        int64_t checkpointed = 0;
+        for (const string &name : reads) {
+            if (!recompute.count(name) && bytes[name] > 0) {
+                checkpointed += bytes[name];
+            }
+        }
+
+        // The forward Funcs that recomputing a Func would newly
+        // checkpoint, because its definition reads them.
+        auto new_reads = [&](const string &name) {
+            vector<string> result;
+            for (const auto &call : find_direct_calls(forward[name])) {
+                if (forward.find(call.first) != forward.end() &&
+                    !reads.count(call.first) &&
+                    !recompute.count(call.first) &&
+                    bytes[call.first] > 0) {
+                    result.push_back(call.first);
+                }
+            }
+            return result;
+        };
+
+        // Greedily recompute the Func that saves the most memory per
+        // unit of recomputation, until the rest fit in the budget. The
+        // memory saved is net of the producers that recomputing it
+        // would checkpoint instead.
+        while (checkpointed > policy.memory_budget) {
+            string best;
+            double best_score = 0;
+            int64_t best_saved = 0;
+            for (const string &name : reads) {
+                if (recompute.count(name) ||
+                    bytes[name] <= 0 ||
+                    !forward[name].can_be_inlined()) {
+                    continue;
+                }
+                int64_t saved = bytes[name];
+                for (const string &producer : new_reads(name)) {
+                    saved -= bytes[producer];
+                }
+                if (saved <= 0) {
+                    continue;
+                }
+                CountNodes cost;
+                for (const Expr &e : forward[name].values()) {
+                    e.accept(&cost);
+                }
+                double score = (double)saved / std::max(cost.count, 1);
+                if (score > best_score) {
+                    best = name;
+                    best_score = score;
+                    best_saved = saved;
+                }
+            }
+            if (best.empty()) {
+                break;
+            }
+            // Recomputing it reads its producers instead.
+            for (const string &producer : new_reads(best)) {
+                reads.insert(producer);
+            }
+            recompute.insert(best);
+            checkpointed -= best_saved;
+        }
+    }
+
+    // Inline the recomputed Funcs into the backward pass, consumers
+    // first, so the producers they read can be recomputed too. We
+    // inline a copy of each definition, so that however the forward
+    // Func is scheduled does not matter.
+    for (auto it = forward_funcs.rbegin(); it != forward_funcs.rend(); it++) {
+        if (!recompute.count(it->name())) {
+            continue;
+        }
+        const Function &func = it->function();
+        Function copy(func.name());
+        copy.define(func.args(), func.values());
+        for (auto &b : backward) {
+            inline_function(b.second, copy);
+        }
+    }
+
+    reads = find_forward_reads();
+    vector<Checkpoint> plan;
+    for (const Func &func : forward_funcs) {
+        if (!reads.count(func.name()) && !recompute.count(func.name())) {
+            continue;
+        }
+        Checkpoint c;
+        c.name = func.name();
+        c.bytes = bytes[func.name()];
+        c.recomputed = recompute.count(func.name()) > 0;
+        debug(1) << "Checkpoint plan: " << c.name << " ("
+                 << (c.bytes >= 0 ? std::to_string(c.bytes) + " bytes" : "unknown size") << ") is "
+                 << (c.recomputed ? "recomputed" : "checkpointed") << "\n";
+        plan.push_back(c);
+    }
+    return plan;
+}
+
 void ReverseAccumulationVisitor::accumulate(const Expr &stub, Expr adjoint) {
     const BaseExprNode *stub_ptr = (const BaseExprNode *)stub.get();
 
@@ -1946,9 +2138,26 @@ Func Derivative::operator()(const Param<> &param) const {
     return it->second;
 }
 
+int64_t Derivative::checkpointed_bytes() const {
+    int64_t total = 0;
+    for (const Checkpoint &c : checkpoint_plan) {
+        if (!c.recomputed && c.bytes > 0) {
+            total += c.bytes;
+        }
+    }
+    return total;
+}
+
 Derivative propagate_adjoints(const Func &output,
                               const Func &adjoint,
                               const Region &output_bounds) {
+    return propagate_adjoints(output, adjoint, output_bounds, CheckpointPolicy());
+}
+
+Derivative propagate_adjoints(const Func &output,
+                              const Func &adjoint,
+                              const Region &output_bounds,
+                              const CheckpointPolicy &policy) {
     user_assert(output.dimensions() == adjoint.dimensions())
         << "output dimensions and adjoint dimensions must match\n";
     user_assert((int)output_bounds.size() == adjoint.dimensions())
@@ -1956,23 +2165,33 @@ Derivative propagate_adjoints(const Func &output,
 
     Internal::ReverseAccumulationVisitor visitor;
     visitor.propagate_adjoints(output, adjoint, output_bounds);
-    // Since the return value of get_adjoint_funcs() is a temporary,
-    // we should *not* use std::move.
-    return Derivative{visitor.get_adjoint_funcs()};
+    vector<Checkpoint> checkpoints = visitor.apply_checkpoint_policy(policy);
+    return Derivative{visitor.get_adjoint_funcs(), std::move(checkpoints)};
 }
 
 Derivative propagate_adjoints(const Func &output,
                               const Buffer<float> &adjoint) {
+    return propagate_adjoints(output, adjoint, CheckpointPolicy());
+}
+
+Derivative propagate_adjoints(const Func &output,
+                              const Buffer<float> &adjoint,
+                              const CheckpointPolicy &policy) {
     user_assert(output.dimensions() == adjoint.dimensions());
     Region bounds;
     for (int dim = 0; dim < adjoint.dimensions(); dim++) {
         bounds.emplace_back(adjoint.min(dim), adjoint.min(dim) + adjoint.extent(dim) - 1);
     }
     Func adjoint_func = BoundaryConditions::constant_exterior(adjoint, 0.f);
-    return propagate_adjoints(output, adjoint_func, bounds);
+    return propagate_adjoints(output, adjoint_func, bounds, policy);
 }
 
 Derivative propagate_adjoints(const Func &output) {
+    return propagate_adjoints(output, CheckpointPolicy());
+}
+
+Derivative propagate_adjoints(const Func &output,
+                              const CheckpointPolicy &policy) {
     Func adjoint("adjoint");
     adjoint(output.args()) = Internal::make_one(output.value().type());
     Region output_bounds;
@@ -1980,7 +2199,7 @@ Derivative propagate_adjoints(const Func &output) {
     for (int i = 0; i < output.dimensions(); i++) {
         output_bounds.push_back({0, 0});
     }
-    return propagate_adjoints(output, adjoint, output_bounds);
+    return propagate_adjoints(output, adjoint, output_bounds, policy);
 }
 
 }  // namespace Halide
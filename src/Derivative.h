@@ -15,6 +15,42 @@
 
 namespace Halide {
 
+/**
+ *  Selects which of the forward Funcs read by the backward pass are kept in
+ *  memory (checkpointed), and which the backward pass recomputes. By default
+ *  every forward Func the adjoints call is checkpointed, so its buffer stays
+ *  alive until the backward pass is done with it. Recomputing a Func instead
+ *  inlines its definition into the adjoints that call it, so its buffer can
+ *  be freed as soon as the forward pass is done with it, at the cost of
+ *  evaluating it again in the backward pass. Only pure Funcs without
+ *  specializations can be recomputed.
+ */
+struct CheckpointPolicy {
+    /** Forward Funcs to recompute in the backward pass. */
+    std::vector<Func> recompute;
+
+    /** If positive, also pick forward Funcs to recompute, in order of the
+     * most memory saved per unit of recomputation, until the estimated
+     * footprint of the checkpointed Funcs fits in this many bytes. */
+    int64_t memory_budget = 0;
+};
+
+/**
+ *  A forward Func read by the backward pass, and whether it is checkpointed.
+ */
+struct Checkpoint {
+    std::string name;
+
+    /** The estimated size of the Func over the region the backward pass
+     * reads, in bytes. Sizes that depend on parameters use their
+     * estimates. -1 if the size could not be estimated. */
+    int64_t bytes = -1;
+
+    /** True if the backward pass recomputes the Func instead of reading it
+     * from memory. */
+    bool recomputed = false;
+};
+
 /**
  *  Helper structure storing the adjoints Func.
  *  Use d(func) or d(buffer) to obtain the derivative Func.
@@ -30,6 +66,10 @@ public:
     explicit Derivative(std::map<FuncKey, Func> &&adjoints_in)
         : adjoints(std::move(adjoints_in)) {
     }
+    Derivative(std::map<FuncKey, Func> &&adjoints_in,
+               std::vector<Checkpoint> &&checkpoints_in)
+        : adjoints(std::move(adjoints_in)), checkpoint_plan(std::move(checkpoints_in)) {
+    }
 
     // These all return an undefined Func if no derivative is found
     // (typically, if the input Funcs aren't differentiable)
@@ -37,8 +77,19 @@ public:
     Func operator()(const Buffer<> &buffer) const;
     Func operator()(const Param<> &param) const;
 
+    /** The forward Funcs read by the backward pass, in realization order,
+     * and whether each one is checkpointed or recomputed. */
+    const std::vector<Checkpoint> &checkpoints() const {
+        return checkpoint_plan;
+    }
+
+    /** The total estimated footprint of the checkpointed Funcs, in
+     * bytes. Funcs whose size could not be estimated are not counted. */
+    int64_t checkpointed_bytes() const;
+
 private:
     const std::map<FuncKey, Func> adjoints;
+    const std::vector<Checkpoint> checkpoint_plan;
 };
 
 /**
@@ -70,6 +121,24 @@ Derivative propagate_adjoints(const Func &output,
  */
 Derivative propagate_adjoints(const Func &output);
 
+/**
+ *  Versions of the above that also apply a CheckpointPolicy to the
+ *  forward Funcs the adjoints read. The resulting plan, with the
+ *  estimated footprint of each Func, is available from
+ *  Derivative::checkpoints().
+ */
+// @{
+Derivative propagate_adjoints(const Func &output,
+                              const Func &adjoint,
+                              const Region &output_bounds,
+                              const CheckpointPolicy &policy);
+Derivative propagate_adjoints(const Func &output,
+                              const Buffer<float> &adjoint,
+                              const CheckpointPolicy &policy);
+Derivative propagate_adjoints(const Func &output,
+                              const CheckpointPolicy &policy);
+// @}
+
 }  // namespace Halide
 
 #endif
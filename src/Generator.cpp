@@ -784,7 +784,12 @@ int generate_filter_main_inner(int argc, char **argv, std::ostream &cerr) {
         "     find one. Flags across all of the targets that do not affect runtime code\n"
         "     generation, such as `no_asserts` and `no_runtime`, are ignored.\n"
         "\n"
-        " -s  The name of an autoscheduler to set as the default.\n";
+        " -s  The name of an autoscheduler to set as the default.\n"
+        "\n"
+        " Passing dispatch_sizes=N1[,N2...] (in increasing order) builds one variant\n"
+        " of the pipeline for outputs of at most N1 elements, one for at most N2, and\n"
+        " so on, plus one for any size, and selects between them on every call.\n"
+        " Use generator_arg@K=value to set a GeneratorParam for variant K only.\n";
 
     std::map<std::string, std::string> flags_info = {
         {"-d", "0"},
@@ -912,6 +917,46 @@ int generate_filter_main_inner(int argc, char **argv, std::ostream &cerr) {
         targets.emplace_back(s);
     }
 
+    // Size variants are described by a list of output-size limits, plus
+    // per-variant overrides of GeneratorParams of the form name@K=value.
+    // None of these are real GeneratorParams, so pull them out here.
+    std::vector<SizeVariant> size_variants;
+    std::map<std::string, std::map<size_t, std::string>> variant_generator_args;
+    if (generator_args.count("dispatch_sizes")) {
+        for (const auto &n : split_string(generator_args["dispatch_sizes"].string_value, ",")) {
+            SizeVariant v;
+            std::istringstream iss(n);
+            if (!(iss >> v.max_output_elements) || !iss.eof() || v.max_output_elements < 0) {
+                cerr << "dispatch_sizes must be a comma-separated list of non-negative integers\n";
+                cerr << kUsage;
+                return 1;
+            }
+            size_variants.push_back(v);
+        }
+        size_variants.emplace_back();
+        for (size_t i = 0; i < size_variants.size(); i++) {
+            size_variants[i].suffix = "-size" + std::to_string(i);
+        }
+        generator_args.erase("dispatch_sizes");
+    }
+    for (auto it = generator_args.begin(); it != generator_args.end();) {
+        size_t at = it->first.find('@');
+        if (at == std::string::npos) {
+            ++it;
+            continue;
+        }
+        std::string index_str = it->first.substr(at + 1);
+        size_t index = 0;
+        std::istringstream iss(index_str);
+        if (!(iss >> index) || !iss.eof() || index >= std::max<size_t>(size_variants.size(), 1)) {
+            cerr << "Generator arg " << it->first << " does not name a size variant in dispatch_sizes\n";
+            cerr << kUsage;
+            return 1;
+        }
+        variant_generator_args[it->first.substr(0, at)][index] = it->second.string_value;
+        it = generator_args.erase(it);
+    }
+
     // extensions won't vary across multitarget output
     std::map<Output, const OutputInfo> output_info = get_output_info(targets[0]);
 
@@ -1029,15 +1074,21 @@ int generate_filter_main_inner(int argc, char **argv, std::ostream &cerr) {
         // Don't bother with this if we're just emitting a cpp_stub.
         if (!stub_only) {
             auto output_files = compute_output_files(targets[0], base_path, outputs);
-            auto module_factory = [&generator_name, &generator_args, build_gradient_module](const std::string &name, const Target &target) -> Module {
+            auto module_factory = [&generator_name, &generator_args, &variant_generator_args, build_gradient_module](const std::string &name, const Target &target, size_t variant) -> Module {
                 auto sub_generator_args = generator_args;
                 sub_generator_args.erase("target");
+                for (const auto &it : variant_generator_args) {
+                    auto v = it.second.find(variant);
+                    if (v != it.second.end()) {
+                        sub_generator_args[it.first] = v->second;
+                    }
+                }
                 // Must re-create each time since each instance will have a different Target.
                 auto gen = GeneratorRegistry::create(generator_name, GeneratorContext(target));
                 gen->set_generator_param_values(sub_generator_args);
                 return build_gradient_module ? gen->build_gradient_module(name) : gen->build_module(name);
             };
-            compile_multitarget(function_name, output_files, targets, target_strings, module_factory, compiler_logger_factory);
+            compile_multitarget(function_name, output_files, targets, target_strings, size_variants, module_factory, compiler_logger_factory);
         }
     }
 
@@ -305,6 +305,11 @@ void JITModule::compile_module(std::unique_ptr<llvm::Module> m, const string &fu
         exports[function_name] = entrypoint;
         argv_entrypoint = compile_and_get_function(*ee, function_name + "_argv");
         exports[function_name + "_argv"] = argv_entrypoint;
+        // Only defined for pipelines with a persistent workspace.
+        const std::string release_name = function_name + "_release_workspace";
+        if (ee->FindFunctionNamed(release_name)) {
+            exports[release_name] = compile_and_get_function(*ee, release_name);
+        }
     }
 
     for (size_t i = 0; i < requested_exports.size(); i++) {
@@ -1,5 +1,11 @@
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+
 #include "LLVM_Runtime_Linker.h"
 #include "LLVM_Headers.h"
+#include "Util.h"
 
 namespace Halide {
 
@@ -77,6 +83,7 @@ DECLARE_CPP_INITMOD(android_clock)
 DECLARE_CPP_INITMOD(android_host_cpu_count)
 DECLARE_CPP_INITMOD(android_io)
 DECLARE_CPP_INITMOD(halide_buffer_t)
+DECLARE_CPP_INITMOD(batch)
 DECLARE_CPP_INITMOD(cache)
 DECLARE_CPP_INITMOD(can_use_target)
 DECLARE_CPP_INITMOD(cuda)
@@ -147,6 +154,7 @@ DECLARE_CPP_INITMOD(windows_profiler)
 DECLARE_CPP_INITMOD(windows_threads)
 DECLARE_CPP_INITMOD(windows_threads_tsan)
 DECLARE_CPP_INITMOD(windows_yield)
+DECLARE_CPP_INITMOD(workspace)
 DECLARE_CPP_INITMOD(write_debug_image)
 
 // Universal LL Initmods. Please keep sorted alphabetically.
@@ -749,7 +757,9 @@ std::unique_ptr<llvm::Module> link_with_wasm_jit_runtime(llvm::LLVMContext *c, c
 }
 
 /** Create an llvm module containing the support code for a given target. */
-std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVMContext *c, bool for_shared_jit_runtime, bool just_gpu) {
+namespace {
+
+std::unique_ptr<llvm::Module> link_initial_module_for_target(Target t, llvm::LLVMContext *c, bool for_shared_jit_runtime, bool just_gpu) {
     enum InitialModuleType {
         ModuleAOT,
         ModuleAOTNoRuntime,
@@ -965,6 +975,11 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
             }
 
             modules.push_back(get_initmod_allocation_cache(c, bits_64, debug));
+            // The JIT runtime is shared by pipelines with and without
+            // persistent workspaces, so it always needs this module.
+            if (t.has_feature(Target::PersistentWorkspace) || module_type == ModuleJITShared) {
+                modules.push_back(get_initmod_workspace(c, bits_64, debug));
+            }
             modules.push_back(get_initmod_device_interface(c, bits_64, debug));
             modules.push_back(get_initmod_metadata(c, bits_64, debug));
             modules.push_back(get_initmod_float16_t(c, bits_64, debug));
@@ -1158,6 +1173,10 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
         modules.push_back(get_initmod_matlab(c, bits_64, debug));
     }
 
+    if (module_type == ModuleAOT && t.has_feature(Target::Batch)) {
+        modules.push_back(get_initmod_batch(c, bits_64, debug));
+    }
+
     if (module_type == ModuleAOTNoRuntime ||
         module_type == ModuleJITInlined ||
         t.os == Target::NoOS) {
@@ -1179,6 +1198,73 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
     return std::move(modules[0]);
 }
 
+// Parsing and linking the runtime modules for a target takes a
+// significant fraction of a small compile, and is the same for every
+// compile with that target. Modules belong to an LLVMContext, and every
+// compile uses a fresh one, so a linked module is cached as bitcode,
+// which is much cheaper to parse than the pieces were to parse and link.
+// Writing the bitcode costs about as much as a link, so it's only done
+// the second time a key is requested; most processes compile for a
+// single target once. The cache holds at most HL_RUNTIME_MODULE_CACHE_SIZE
+// modules (16 by default; 0 disables it).
+struct LinkedRuntimeModule {
+    std::string identifier;
+    std::string bitcode;
+};
+
+std::mutex linked_runtime_modules_lock;
+std::map<std::string, LinkedRuntimeModule> linked_runtime_modules;
+
+size_t runtime_module_cache_size() {
+    static const size_t size = []() {
+        std::string s = get_env_variable("HL_RUNTIME_MODULE_CACHE_SIZE");
+        return s.empty() ? (size_t)16 : (size_t)std::max(0, std::atoi(s.c_str()));
+    }();
+    return size;
+}
+
+}  // namespace
+
+std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVMContext *c, bool for_shared_jit_runtime, bool just_gpu) {
+    const size_t cache_size = runtime_module_cache_size();
+    if (cache_size == 0) {
+        return link_initial_module_for_target(t, c, for_shared_jit_runtime, just_gpu);
+    }
+
+    const std::string key = t.to_string() +
+                            (for_shared_jit_runtime ? "/shared_jit_runtime" : "") +
+                            (just_gpu ? "/just_gpu" : "");
+    bool serialize = false;
+    {
+        std::lock_guard<std::mutex> lock(linked_runtime_modules_lock);
+        auto it = linked_runtime_modules.find(key);
+        if (it != linked_runtime_modules.end()) {
+            if (!it->second.bitcode.empty()) {
+                return parse_bitcode_file(it->second.bitcode, c, it->second.identifier.c_str());
+            }
+            // Requested before: worth keeping this time.
+            serialize = true;
+        } else if (linked_runtime_modules.size() < cache_size) {
+            // Remember the key, but don't pay for the bitcode yet.
+            linked_runtime_modules.emplace(key, LinkedRuntimeModule());
+        }
+    }
+
+    std::unique_ptr<llvm::Module> module = link_initial_module_for_target(t, c, for_shared_jit_runtime, just_gpu);
+
+    if (serialize) {
+        LinkedRuntimeModule linked;
+        linked.identifier = module->getModuleIdentifier();
+        llvm::raw_string_ostream stream(linked.bitcode);
+        llvm::WriteBitcodeToFile(*module, stream);
+        stream.flush();
+
+        std::lock_guard<std::mutex> lock(linked_runtime_modules_lock);
+        linked_runtime_modules[key] = std::move(linked);
+    }
+    return module;
+}
+
 #ifdef WITH_NVPTX
 std::unique_ptr<llvm::Module> get_initial_module_for_ptx_device(Target target, llvm::LLVMContext *c) {
     std::vector<std::unique_ptr<llvm::Module>> modules;
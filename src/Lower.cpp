@@ -549,6 +549,17 @@ Module lower(const vector<Function> &output_funcs,
 
     result_module.append(main_func);
 
+    // The batched entry point runs every element after the first through
+    // a variant without the argument checks, once it has checked that the
+    // element's arguments match the first one's. (MSAN annotates the
+    // outputs only of external functions, so it always uses the checks.)
+    if (t.has_feature(Target::Batch) &&
+        linkage_type == LinkageType::ExternalPlusMetadata &&
+        !t.has_feature(Target::MSAN)) {
+        result_module.append(LoweredFunc(pipeline_name + "_unchecked", public_args,
+                                         strip_argument_checks(s), LinkageType::Internal));
+    }
+
     auto *logger = get_compiler_logger();
     if (logger) {
         auto time_end = std::chrono::high_resolution_clock::now();
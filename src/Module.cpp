@@ -3,6 +3,7 @@
 #include <array>
 #include <fstream>
 #include <future>
+#include <set>
 #include <utility>
 
 #include "CodeGen_C.h"
@@ -571,7 +572,8 @@ void Module::compile(const std::map<Output, std::string> &output_files) const {
     }
     if (contains(output_files, Output::stmt_html)) {
         debug(1) << "Module.compile(): stmt_html " << output_files.at(Output::stmt_html) << "\n";
-        Internal::print_to_html(output_files.at(Output::stmt_html), *this);
+        Internal::print_to_html(output_files.at(Output::stmt_html), *this,
+                                Internal::get_env_variable("HL_STMT_HTML_PROFILE"));
     }
 
     // If there are submodules, recursively lower submodules to
@@ -759,12 +761,39 @@ void compile_multitarget(const std::string &fn_name,
                          const std::vector<std::string> &suffixes,
                          const ModuleFactory &module_factory,
                          const CompilerLoggerFactory &compiler_logger_factory) {
+    compile_multitarget(
+        fn_name, output_files, targets, suffixes, {},
+        [&](const std::string &name, const Target &target, size_t) -> Module {
+            return module_factory(name, target);
+        },
+        compiler_logger_factory);
+}
+
+void compile_multitarget(const std::string &fn_name,
+                         const std::map<Output, std::string> &output_files,
+                         const std::vector<Target> &targets,
+                         const std::vector<std::string> &suffixes,
+                         const std::vector<SizeVariant> &variants,
+                         const VariantModuleFactory &module_factory,
+                         const CompilerLoggerFactory &compiler_logger_factory) {
     validate_outputs(output_files);
 
     user_assert(!fn_name.empty()) << "Function name must be specified.\n";
     user_assert(!targets.empty()) << "Must specify at least one target.\n";
     user_assert(suffixes.empty() || suffixes.size() == targets.size())
         << "The suffixes list must be empty or the same length as the targets list.\n";
+    std::set<std::string> variant_suffixes;
+    for (size_t v = 0; v < variants.size(); v++) {
+        const bool is_last = (v + 1 == variants.size());
+        user_assert(is_last == (variants[v].max_output_elements < 0))
+            << "Only the last size variant may (and must) have no limit on the output size.\n";
+        user_assert(v == 0 || is_last || variants[v].max_output_elements > variants[v - 1].max_output_elements)
+            << "Size variants must be listed in order of increasing output size.\n";
+        user_assert(variants.size() == 1 ||
+                    (!variants[v].suffix.empty() && variant_suffixes.insert(variants[v].suffix).second))
+            << "Each size variant must have a distinct, non-empty suffix.\n";
+    }
+    const bool has_size_variants = variants.size() > 1;
 
     // The final target in the list is considered "baseline", and is used
     // for (e.g.) the runtime and shared code. It is often just arch-bits-os
@@ -790,9 +819,10 @@ void compile_multitarget(const std::string &fn_name,
         return out;
     };
 
-    // If only one target, don't bother with the runtime feature detection wrapping.
-    const bool needs_wrapper = (targets.size() > 1);
-    if (targets.size() == 1) {
+    // If only one target (and one variant of it), don't bother with the runtime
+    // feature detection wrapping.
+    const bool needs_wrapper = (targets.size() > 1) || has_size_variants;
+    if (!needs_wrapper) {
         debug(1) << "compile_multitarget: single target is " << base_target.to_string() << "\n";
         ScopedCompilerLogger activate(compiler_logger_factory, fn_name, base_target);
 
@@ -805,10 +835,14 @@ void compile_multitarget(const std::string &fn_name,
         // This would make the filename outputs more symmetrical (ie the same for n=1 as for n>1)
         // but at the expense of breaking existing users. So for now, we're going to continue
         // with the legacy treatment below:
-        module_factory(fn_name, base_target).compile(output_files);
+        module_factory(fn_name, base_target, 0).compile(output_files);
         return;
     }
 
+    // Size dispatch calls the variants as plain extern functions.
+    user_assert(!has_size_variants || !base_target.has_feature(Target::CPlusPlusMangling))
+        << "Size variants are not supported with C++ name mangling.\n";
+
     user_assert(((int)contains(output_files, Output::object) + (int)contains(output_files, Output::static_library)) == 1)
         << "compile_multitarget() expects exactly one of 'object' and 'static_library' to be specified when multiple targets are specified.\n";
 
@@ -843,8 +877,9 @@ void compile_multitarget(const std::string &fn_name,
             user_error << "All Targets must have matching arch-bits-os for compile_multitarget.\n";
         }
         // Some features must match across all targets.
-        static const std::array<Target::Feature, 9> must_match_features = {{
+        static const std::array<Target::Feature, 10> must_match_features = {{
             Target::ASAN,
+            Target::Batch,
             Target::CPlusPlusMangling,
             Target::Debug,
             Target::JIT,
@@ -866,34 +901,43 @@ void compile_multitarget(const std::string &fn_name,
         std::string sub_fn_name = needs_wrapper ? (fn_name + suffix) : fn_name;
 
         // We always produce the runtime separately, so add NoRuntime explicitly.
-        // Matlab should be added to the wrapper pipeline below, instead of each sub-pipeline.
+        // Matlab and Batch should be added to the wrapper pipeline below, instead of each sub-pipeline.
         Target sub_fn_target = target.with_feature(Target::NoRuntime);
         if (needs_wrapper) {
-            sub_fn_target = sub_fn_target.without_feature(Target::Matlab);
+            sub_fn_target = sub_fn_target.without_feature(Target::Matlab).without_feature(Target::Batch);
         }
 
-        {
-            ScopedCompilerLogger activate(compiler_logger_factory, sub_fn_name, sub_fn_target);
-            Module sub_module = module_factory(sub_fn_name, sub_fn_target);
+        const size_t num_variants = std::max<size_t>(variants.size(), 1);
+        for (size_t v = 0; v < num_variants; v++) {
+            const std::string variant_suffix = suffix + (has_size_variants ? variants[v].suffix : "");
+            const std::string variant_fn_name = sub_fn_name + (has_size_variants ? variants[v].suffix : "");
+
+            ScopedCompilerLogger activate(compiler_logger_factory, variant_fn_name, sub_fn_target);
+            Module sub_module = module_factory(variant_fn_name, sub_fn_target, v);
             // Re-assign every time -- should be the same across all targets anyway,
             // but base_target is always the last one we encounter.
-            base_target_args = sub_module.get_function_by_name(sub_fn_name).args;
+            base_target_args = sub_module.get_function_by_name(variant_fn_name).args;
 
-            auto sub_out = add_suffixes(output_files, suffix);
+            auto sub_out = add_suffixes(output_files, variant_suffix);
             if (contains(output_files, Output::static_library)) {
-                sub_out[Output::object] = temp_obj_dir.add_temp_object_file(output_files.at(Output::static_library), suffix, target);
+                sub_out[Output::object] = temp_obj_dir.add_temp_object_file(output_files.at(Output::static_library), variant_suffix, target);
                 sub_out.erase(Output::static_library);
             }
             sub_out.erase(Output::registration);
             sub_out.erase(Output::schedule);
             sub_out.erase(Output::c_header);
             if (contains(sub_out, Output::compiler_log)) {
-                sub_out[Output::compiler_log] = temp_compiler_log_dir.add_temp_file(output_files.at(Output::compiler_log), suffix, target);
+                sub_out[Output::compiler_log] = temp_compiler_log_dir.add_temp_file(output_files.at(Output::compiler_log), variant_suffix, target);
             }
             debug(1) << "compile_multitarget: compile_sub_target " << sub_out[Output::object] << "\n";
             sub_module.compile(sub_out);
-            const auto *r = sub_module.get_auto_scheduler_results();
-            auto_scheduler_results.push_back(r ? *r : AutoSchedulerResults());
+
+            // The schedule output describes the unbounded variant, which
+            // is the one compiled last.
+            if (v + 1 == num_variants) {
+                const auto *r = sub_module.get_auto_scheduler_results();
+                auto_scheduler_results.push_back(r ? *r : AutoSchedulerResults());
+            }
         }
 
         uint64_t cur_target_features[kFeaturesWordCount] = {0};
@@ -951,11 +995,66 @@ void compile_multitarget(const std::string &fn_name,
     }
 
     if (needs_wrapper) {
-        Expr indirect_result = Call::make(Int(32), Call::call_cached_indirect_function, wrapper_args, Call::Intrinsic);
-        std::string private_result_name = unique_name(fn_name + "_result");
-        Expr private_result_var = Variable::make(Int(32), private_result_name);
-        Stmt wrapper_body = AssertStmt::make(private_result_var == 0, private_result_var);
-        wrapper_body = LetStmt::make(private_result_name, indirect_result, wrapper_body);
+        // Call the named sub-function with the wrapper's own arguments,
+        // and propagate any nonzero result code.
+        const auto call_and_check = [&](const Expr &call) -> Stmt {
+            std::string private_result_name = unique_name(fn_name + "_result");
+            Expr private_result_var = Variable::make(Int(32), private_result_name);
+            Stmt s = AssertStmt::make(private_result_var == 0, private_result_var);
+            return LetStmt::make(private_result_name, call, s);
+        };
+
+        // When there are size variants, each Target gets an internal
+        // function that picks a variant based on the number of elements
+        // in the first output. Unlike the Target, this can't be cached,
+        // so it's done on every call.
+        std::vector<LoweredFunc> size_dispatchers;
+        if (has_size_variants) {
+            std::vector<Expr> call_args;
+            Expr output_elements;
+            for (const auto &arg : base_target_args) {
+                if (arg.is_buffer()) {
+                    Expr buf = Variable::make(type_of<halide_buffer_t *>(), arg.name + ".buffer");
+                    call_args.push_back(buf);
+                    if (arg.is_output() && !output_elements.defined()) {
+                        output_elements = make_const(Int(64), 1);
+                        for (int d = 0; d < arg.dimensions; d++) {
+                            Expr extent = Call::make(Int(32), Call::buffer_get_extent, {buf, d}, Call::Extern);
+                            output_elements *= cast<int64_t>(extent);
+                        }
+                    }
+                } else {
+                    call_args.push_back(Variable::make(arg.type, arg.name));
+                }
+            }
+            internal_assert(output_elements.defined()) << "Pipeline " << fn_name << " has no output buffers\n";
+
+            for (size_t i = 1; i < wrapper_args.size(); i += 2) {
+                const std::string sub_fn_name = wrapper_args[i].as<StringImm>()->value;
+                Stmt body;
+                for (size_t v = variants.size(); v > 0; v--) {
+                    const SizeVariant &variant = variants[v - 1];
+                    Stmt call = call_and_check(Call::make(Int(32), sub_fn_name + variant.suffix, call_args, Call::Extern));
+                    if (!body.defined()) {
+                        body = call;
+                    } else {
+                        body = IfThenElse::make(output_elements <= make_const(Int(64), variant.max_output_elements), call, body);
+                    }
+                }
+                size_dispatchers.emplace_back(sub_fn_name, base_target_args, body, LinkageType::Internal);
+            }
+        }
+
+        Stmt wrapper_body;
+        if (targets.size() == 1) {
+            // Just the size dispatch; inline it into the wrapper.
+            internal_assert(size_dispatchers.size() == 1);
+            wrapper_body = size_dispatchers[0].body;
+            size_dispatchers.clear();
+        } else {
+            Expr indirect_result = Call::make(Int(32), Call::call_cached_indirect_function, wrapper_args, Call::Intrinsic);
+            wrapper_body = call_and_check(indirect_result);
+        }
 
         // Always build with NoRuntime: that's handled as a separate module.
         //
@@ -973,8 +1072,15 @@ void compile_multitarget(const std::string &fn_name,
         if (base_target.has_feature(Target::Matlab)) {
             wrapper_target = wrapper_target.with_feature(Target::Matlab);
         }
+        // Likewise for the batched entry point.
+        if (base_target.has_feature(Target::Batch)) {
+            wrapper_target = wrapper_target.with_feature(Target::Batch);
+        }
 
         Module wrapper_module(fn_name, wrapper_target);
+        for (const auto &f : size_dispatchers) {
+            wrapper_module.append(f);
+        }
         wrapper_module.append(LoweredFunc(fn_name, base_target_args, wrapper_body, LinkageType::ExternalPlusMetadata));
 
         std::string wrapper_path = contains(output_files, Output::static_library) ?
@@ -228,6 +228,31 @@ void compile_multitarget(const std::string &fn_name,
                          const ModuleFactory &module_factory,
                          const CompilerLoggerFactory &compiler_logger_factory = nullptr);
 
+/** A problem-size variant of a pipeline, for use with compile_multitarget.
+ * The Target to use is selected once per process, but the variant is
+ * selected on every call: the first variant whose max_output_elements is
+ * at least the number of elements in the first output buffer is
+ * called. The last variant must have a negative max_output_elements,
+ * which means no limit. */
+struct SizeVariant {
+    int64_t max_output_elements = -1;
+    std::string suffix;
+};
+
+using VariantModuleFactory = std::function<Module(const std::string &fn_name, const Target &target, size_t variant)>;
+
+/** Like compile_multitarget above, but also compile one version of the
+ * pipeline per SizeVariant for each Target, and generate a wrapper that
+ * dispatches between them based on the size of the output. Passing zero
+ * or one variants is equivalent to the version above. */
+void compile_multitarget(const std::string &fn_name,
+                         const std::map<Output, std::string> &output_files,
+                         const std::vector<Target> &targets,
+                         const std::vector<std::string> &suffixes,
+                         const std::vector<SizeVariant> &variants,
+                         const VariantModuleFactory &module_factory,
+                         const CompilerLoggerFactory &compiler_logger_factory = nullptr);
+
 }  // namespace Halide
 
 #endif
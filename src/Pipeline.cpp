@@ -80,12 +80,16 @@ struct PipelineContents {
     /** Clear all cached state */
     void invalidate_cache() {
         module = Module("", Target());
-        jit_module = JITModule();
+        release_jit_module();
         jit_target = Target();
         inferred_args.clear();
         wasm_module = WasmModule();
     }
 
+    /** Drop the cached jit-compiled code, first freeing any buffers
+     * it kept in a persistent workspace. */
+    void release_jit_module();
+
     // The outputs
     vector<Function> outputs;
 
@@ -648,6 +652,11 @@ void Pipeline::set_error_handler(void (*handler)(void *, const char *)) {
 void Pipeline::set_custom_allocator(void *(*cust_malloc)(void *, size_t),
                                     void (*cust_free)(void *, void *)) {
     user_assert(defined()) << "Pipeline is undefined\n";
+    // Buffers kept by a persistent workspace must go back to the
+    // allocator that made them.
+    if (contents->jit_target.has_feature(Target::PersistentWorkspace)) {
+        contents->invalidate_cache();
+    }
     contents->jit_handlers.custom_malloc = cust_malloc;
     contents->jit_handlers.custom_free = cust_free;
 }
@@ -907,6 +916,19 @@ struct JITFuncCallContext {
 
 }  // namespace
 
+void PipelineContents::release_jit_module() {
+    // With Target::PersistentWorkspace, the code exports a function that
+    // frees its workspace. Call it with this pipeline's own handlers, so
+    // the buffers go back to the allocator that made them.
+    for (const auto &e : jit_module.exports()) {
+        if (ends_with(e.first, "_release_workspace")) {
+            JITFuncCallContext jit_context(jit_handlers);
+            ((void (*)(void *))e.second.address)(&jit_context.jit_context);
+        }
+    }
+    jit_module = JITModule();
+}
+
 struct Pipeline::JITCallArgs {
     size_t size{0};
     const void **store;
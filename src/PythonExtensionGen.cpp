@@ -104,14 +104,14 @@ void PythonExtensionGen::convert_buffer(const string &name, const LoweredArgumen
     internal_assert(arg->dimensions);
     dest << "    halide_buffer_t buffer_" << name << ";\n";
     dest << "    halide_dimension_t dimensions_" << name << "[" << (int)arg->dimensions << "];\n";
-    dest << "    Py_buffer view_" << name << ";\n";
+    dest << "    _halide_buffer_ref ref_" << name << ";\n";
     dest << "    if (_convert_py_buffer_to_halide(";
     dest << /*pyobj*/ "py_" << name << ", ";
     dest << /*dimensions*/ (int)arg->dimensions << ", ";
     dest << /*flags*/ (arg->is_output() ? "PyBUF_WRITABLE" : "0") << ", ";
     dest << /*dim*/ "dimensions_" << name << ", ";
     dest << /*out*/ "&buffer_" << name << ", ";
-    dest << /*buf*/ "view_" << name << ", ";
+    dest << /*ref*/ "ref_" << name << ", ";
     dest << /*name*/ "\"" << name << "\"";
     dest << ") < 0) {\n";
     release_buffers("        ");
@@ -125,7 +125,7 @@ PythonExtensionGen::PythonExtensionGen(std::ostream &dest)
 
 void PythonExtensionGen::release_buffers(const string &prefix = "    ") {
     for (size_t i = 0; i < buffer_refs.size(); i++) {
-        dest << prefix << "PyBuffer_Release(&" << buffer_refs[i] << ");\n";
+        dest << prefix << "_release_buffer_ref(" << buffer_refs[i] << ");\n";
     }
 }
 
@@ -158,6 +158,143 @@ void PythonExtensionGen::compile(const Module &module) {
 extern "C" {
 #endif
 
+/* The subset of the DLPack ABI (https://github.com/dmlc/dlpack) needed to
+ * accept host tensors from other frameworks. The DLPack type codes for int,
+ * uint, float and bfloat match halide_type_code_t. */
+struct _halide_DLTensor {
+    void* data;
+    int32_t device_type;
+    int32_t device_id;
+    int32_t ndim;
+    uint8_t code;
+    uint8_t bits;
+    uint16_t lanes;
+    int64_t* shape;
+    int64_t* strides;  /* In elements. Null means compact, row-major. */
+    uint64_t byte_offset;
+};
+
+struct _halide_DLManagedTensor {
+    _halide_DLTensor dl_tensor;
+    void* manager_ctx;
+    void (*deleter)(_halide_DLManagedTensor* self);
+};
+
+/* Keeps the memory of a buffer argument alive for the duration of a call. */
+struct _halide_buffer_ref {
+    Py_buffer view;                    /* If the buffer protocol was used. */
+    _halide_DLManagedTensor* dlpack;   /* If DLPack was used. */
+};
+
+static inline void _release_buffer_ref(_halide_buffer_ref &ref) {
+    if (ref.dlpack) {
+        if (ref.dlpack->deleter) {
+            ref.dlpack->deleter(ref.dlpack);
+        }
+        ref.dlpack = nullptr;
+    } else {
+        PyBuffer_Release(&ref.view);
+    }
+}
+
+/* Fill in one dimension, given in the order of the Python array. */
+static inline int _convert_dim_to_halide(
+        int64_t extent, int64_t stride, halide_dimension_t* dim, const char* name) {
+    if (extent > INT32_MAX || stride > INT32_MAX || stride < INT32_MIN) {
+        PyErr_Format(PyExc_ValueError, "Invalid argument %s: too large", name);
+        return -1;
+    }
+    dim->min = 0;
+    dim->stride = (int32_t)stride;
+    dim->extent = (int32_t)extent;
+    dim->flags = 0;
+    return 0;
+}
+
+/* Python arrays have their first dimension outermost by convention, and
+ * Halide has it innermost, so we usually reverse the dimensions. We don't
+ * if the first dimension has the smallest stride (e.g. the array is in
+ * Fortran order, which can be achieved in numpy by passing order='F' during
+ * array creation), so that either way the array can be processed without
+ * copying it. */
+static inline void _reorder_dims_for_halide(
+        int ndim, halide_dimension_t* dim, int fortran_order) {
+    if (fortran_order < 0) {
+        int64_t first = dim[0].stride, last = dim[ndim - 1].stride;
+        fortran_order = (first < 0 ? -first : first) < (last < 0 ? -last : last);
+    }
+    if (!fortran_order) {
+        for (int i = 0, j = ndim - 1; i < j; ++i, --j) {
+            halide_dimension_t tmp = dim[i];
+            dim[i] = dim[j];
+            dim[j] = tmp;
+        }
+    }
+}
+
+static inline int _convert_dlpack_to_halide(
+        PyObject* pyobj, int dimensions,
+        halide_dimension_t* dim,  // array of size `dimensions`
+        halide_buffer_t* out, _halide_buffer_ref &ref, const char* name) {
+    PyObject* capsule = PyObject_CallMethod(pyobj, "__dlpack__", nullptr);
+    if (!capsule) {
+        return -1;
+    }
+    ref.dlpack = (_halide_DLManagedTensor*)PyCapsule_GetPointer(capsule, "dltensor");
+    if (!ref.dlpack) {
+        Py_DECREF(capsule);
+        return -1;
+    }
+    /* Take ownership of the tensor; we call its deleter when we're done. */
+    PyCapsule_SetName(capsule, "used_dltensor");
+    Py_DECREF(capsule);
+
+    const _halide_DLTensor t = ref.dlpack->dl_tensor;  /* Copied, since errors release it. */
+    const int kDLCPU = 1, kDLCUDAHost = 3, kDLBool = 6;
+    if (t.device_type != kDLCPU && t.device_type != kDLCUDAHost) {
+      _release_buffer_ref(ref);
+      PyErr_Format(PyExc_ValueError, "Invalid argument %s: not in host memory", name);
+      return -1;
+    }
+    if (t.ndim != dimensions) {
+      _release_buffer_ref(ref);
+      PyErr_Format(PyExc_ValueError, "Invalid argument %s: Expected %d dimensions, got %d",
+                   name, dimensions, t.ndim);
+      return -1;
+    }
+    /* DLPack code 3 is kDLOpaqueHandle, not halide_type_handle. */
+    if (t.lanes != 1 || t.bits % 8 != 0 ||
+        (t.code != halide_type_int && t.code != halide_type_uint &&
+         t.code != halide_type_float && t.code != halide_type_bfloat &&
+         t.code != kDLBool)) {
+      _release_buffer_ref(ref);
+      PyErr_Format(PyExc_ValueError, "Invalid data type for %s", name);
+      return -1;
+    }
+    int64_t stride = 1;
+    for (int i = t.ndim - 1; i >= 0; --i) {
+        if (_convert_dim_to_halide(t.shape[i], t.strides ? t.strides[i] : stride, &dim[i], name) < 0) {
+            _release_buffer_ref(ref);
+            return -1;
+        }
+        stride *= t.shape[i];
+    }
+    _reorder_dims_for_halide(t.ndim, dim, t.strides ? -1 : 0);
+
+    if (t.code == kDLBool) {
+        out->type.code = halide_type_uint;
+        out->type.bits = 1;
+    } else {
+        out->type.code = (halide_type_code_t)t.code;
+        out->type.bits = t.bits;
+    }
+    out->type.lanes = 1;
+    out->dimensions = t.ndim;
+    out->dim = dim;
+    out->host = (uint8_t*)t.data + t.byte_offset;
+    return 0;
+}
+
 static
 #if !defined(_MSC_VER)
 __attribute__((unused))
@@ -165,45 +302,27 @@ __attribute__((unused))
 int _convert_py_buffer_to_halide(
         PyObject* pyobj, int dimensions, int flags,
         halide_dimension_t* dim,  // array of size `dimensions`
-        halide_buffer_t* out, Py_buffer &buf, const char* name) {
+        halide_buffer_t* out, _halide_buffer_ref &ref, const char* name) {
+    *out = halide_buffer_t();
+    ref.dlpack = nullptr;
+    if (!PyObject_CheckBuffer(pyobj) && PyObject_HasAttrString(pyobj, "__dlpack__")) {
+      /* E.g. a PyTorch tensor. */
+      return _convert_dlpack_to_halide(pyobj, dimensions, dim, out, ref, name);
+    }
+    Py_buffer &buf = ref.view;
+    /* Any strides are fine; we don't need to copy to make the buffer contiguous. */
     int ret = PyObject_GetBuffer(
-      pyobj, &buf, PyBUF_FORMAT | PyBUF_STRIDED_RO | PyBUF_ANY_CONTIGUOUS | flags);
+      pyobj, &buf, PyBUF_FORMAT | PyBUF_STRIDED_RO | flags);
     if (ret < 0) {
       return ret;
     }
-    if (dimensions && buf.ndim != dimensions) {
+    if (buf.ndim != dimensions) {
       PyErr_Format(PyExc_ValueError, "Invalid argument %s: Expected %d dimensions, got %d",
                    name, dimensions, buf.ndim);
       PyBuffer_Release(&buf);
       return -1;
     }
-    /* We'll get a buffer that's either:
-     * C_CONTIGUOUS (last dimension varies the fastest, i.e., has stride=1) or
-     * F_CONTIGUOUS (first dimension varies the fastest, i.e., has stride=1).
-     * The latter is preferred, since it's already in the format that Halide
-     * needs. It can can be achieved in numpy by passing order='F' during array
-     * creation. However, if we do get a C_CONTIGUOUS buffer, flip the dimensions
-     * (transpose) so we can process it without having to reallocate.
-     */
-    int i, j, j_step;
-    if (PyBuffer_IsContiguous(&buf, 'F')) {
-      j = 0;
-      j_step = 1;
-    } else if (PyBuffer_IsContiguous(&buf, 'C')) {
-      j = buf.ndim - 1;
-      j_step = -1;
-    } else {
-      /* Python checks all dimensions and strides, so this typically indicates
-       * a bug in the array's buffer protocol. */
-      PyErr_Format(PyExc_ValueError, "Invalid buffer: neither C nor Fortran contiguous");
-      PyBuffer_Release(&buf);
-      return -1;
-    }
-    for (i = 0; i < buf.ndim; ++i, j += j_step) {
-        dim[i].min = 0;
-        dim[i].stride = (int)(buf.strides[j] / buf.itemsize); // strides is in bytes
-        dim[i].extent = (int)buf.shape[j];
-        dim[i].flags = 0;
+    for (int i = 0; i < buf.ndim; ++i) {
         if (buf.suboffsets && buf.suboffsets[i] >= 0) {
             // Halide doesn't support arrays of pointers. But we should never see this
             // anyway, since we specified PyBUF_STRIDED.
@@ -211,14 +330,22 @@ int _convert_py_buffer_to_halide(
             PyBuffer_Release(&buf);
             return -1;
         }
+        if (buf.strides[i] % buf.itemsize != 0) {
+            PyErr_Format(PyExc_ValueError, "Invalid buffer: strides must be a multiple of the item size");
+            PyBuffer_Release(&buf);
+            return -1;
+        }
+        // strides is in bytes
+        if (_convert_dim_to_halide(buf.shape[i], buf.strides[i] / buf.itemsize, &dim[i], name) < 0) {
+            PyBuffer_Release(&buf);
+            return -1;
+        }
     }
-    if (dim[buf.ndim - 1].extent * dim[buf.ndim - 1].stride * buf.itemsize != buf.len) {
-        PyErr_Format(PyExc_ValueError, "Invalid buffer: length %ld, but computed length %ld",
-                     buf.len, buf.shape[0] * buf.strides[0]);
-        PyBuffer_Release(&buf);
-        return -1;
-    }
-    *out = halide_buffer_t();
+    // Contiguous arrays are reordered by their layout, and other arrays by
+    // their strides.
+    _reorder_dims_for_halide(buf.ndim, dim,
+                             PyBuffer_IsContiguous(&buf, 'F') ? 1 :
+                             PyBuffer_IsContiguous(&buf, 'C') ? 0 : -1);
     if (!buf.format) {
         out->type.code = halide_type_uint;
         out->type.bits = 8;
@@ -303,6 +430,7 @@ void PythonExtensionGen::compile(const LoweredFunc &f) {
     const std::vector<LoweredArgument> &args = f.args;
     const string basename = remove_namespaces(f.name);
     std::vector<string> arg_names(args.size());
+    buffer_refs.clear();
     dest << "// " << f.name << "\n";
     dest << "static PyObject* _f_" << basename << "(PyObject* module, PyObject* args, PyObject* kwargs) {\n";
     for (size_t i = 0; i < args.size(); i++) {
@@ -342,12 +470,17 @@ void PythonExtensionGen::compile(const LoweredFunc &f) {
     for (size_t i = 0; i < args.size(); i++) {
         if (args[i].is_buffer()) {
             convert_buffer(arg_names[i], &args[i]);
-            buffer_refs.push_back("view_" + arg_names[i]);
+            buffer_refs.push_back("ref_" + arg_names[i]);
         } else {
             // Python already converted this.
         }
     }
-    dest << "    int result = " << f.name << "(";
+    // Run the pipeline without the GIL, so that other Python threads can
+    // run in the meantime. The buffer arguments are kept alive by their
+    // views and references, which we only release once we have it again.
+    dest << "    int result;\n";
+    dest << "    Py_BEGIN_ALLOW_THREADS\n";
+    dest << "    result = " << f.name << "(";
     for (size_t i = 0; i < args.size(); i++) {
         if (i > 0) {
             dest << ", ";
@@ -359,6 +492,7 @@ void PythonExtensionGen::compile(const LoweredFunc &f) {
         }
     }
     dest << ");\n";
+    dest << "    Py_END_ALLOW_THREADS\n";
     release_buffers();
     dest << R"INLINE_CODE(
     if (result != 0) {
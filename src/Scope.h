@@ -1,10 +1,13 @@
 #ifndef HALIDE_SCOPE_H
 #define HALIDE_SCOPE_H
 
+#include <algorithm>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <stack>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -93,7 +96,26 @@ public:
 template<typename T = void>
 class Scope {
 private:
-    std::map<std::string, SmallStack<T>> table;
+    // IR names are long and share long prefixes (e.g. "f.s0.x.x"), so
+    // this is a hash table rather than an ordered map: lookups hash the
+    // name once instead of comparing it against O(log n) others.
+    using Table = std::unordered_map<std::string, SmallStack<T>>;
+    Table table;
+
+    // The entries of the table sorted by name, for iteration. Built on
+    // the first cbegin() and kept until a name is added or removed, so
+    // passes that iterate repeatedly over an unchanged scope sort once.
+    using Entries = std::vector<const typename Table::value_type *>;
+    mutable std::shared_ptr<const Entries> sorted_entries;
+
+    SmallStack<T> &stack_for_push(const std::string &name) {
+        size_t old_size = table.size();
+        SmallStack<T> &stack = table[name];
+        if (table.size() != old_size) {
+            sorted_entries.reset();
+        }
+        return stack;
+    }
 
     const Scope<T> *containing_scope = nullptr;
 
@@ -126,7 +148,7 @@ public:
     template<typename T2 = T,
              typename = typename std::enable_if<!std::is_same<T2, void>::value>::type>
     T2 get(const std::string &name) const {
-        typename std::map<std::string, SmallStack<T>>::const_iterator iter = table.find(name);
+        typename Table::const_iterator iter = table.find(name);
         if (iter == table.end() || iter->second.empty()) {
             if (containing_scope) {
                 return containing_scope->get(name);
@@ -142,7 +164,7 @@ public:
     template<typename T2 = T,
              typename = typename std::enable_if<!std::is_same<T2, void>::value>::type>
     T2 &ref(const std::string &name) {
-        typename std::map<std::string, SmallStack<T>>::iterator iter = table.find(name);
+        typename Table::iterator iter = table.find(name);
         if (iter == table.end() || iter->second.empty()) {
             internal_error << "Name not in Scope: " << name << "\n"
                            << *this << "\n";
@@ -152,7 +174,7 @@ public:
 
     /** Tests if a name is in scope */
     bool contains(const std::string &name) const {
-        typename std::map<std::string, SmallStack<T>>::const_iterator iter = table.find(name);
+        typename Table::const_iterator iter = table.find(name);
         if (iter == table.end() || iter->second.empty()) {
             if (containing_scope) {
                 return containing_scope->contains(name);
@@ -179,72 +201,105 @@ public:
     template<typename T2 = T,
              typename = typename std::enable_if<!std::is_same<T2, void>::value>::type>
     void push(const std::string &name, T2 &&value) {
-        table[name].push(std::forward<T2>(value));
+        stack_for_push(name).push(std::forward<T2>(value));
     }
 
     template<typename T2 = T,
              typename = typename std::enable_if<std::is_same<T2, void>::value>::type>
     void push(const std::string &name) {
-        table[name].push();
+        stack_for_push(name).push();
     }
 
     /** A name goes out of scope. Restore whatever its old value
      * was (or remove it entirely if there was nothing else of the
      * same name in an outer scope) */
     void pop(const std::string &name) {
-        typename std::map<std::string, SmallStack<T>>::iterator iter = table.find(name);
+        typename Table::iterator iter = table.find(name);
         internal_assert(iter != table.end()) << "Name not in Scope: " << name << "\n"
                                              << *this << "\n";
         iter->second.pop();
         if (iter->second.empty()) {
             table.erase(iter);
+            sorted_entries.reset();
         }
     }
 
-    /** Iterate through the scope. Does not capture any containing scope. */
+    /** Iterate through the scope in order of name, so that passes
+     * which emit IR while iterating are deterministic. Does not capture
+     * any containing scope. An iterator walks the names that were in
+     * scope when it was created: names pushed while iterating are not
+     * visited, and names that were in scope must not be removed until
+     * the iteration is done. */
     class const_iterator {
-        typename std::map<std::string, SmallStack<T>>::const_iterator iter;
+        // Pointers to elements (unlike iterators) stay valid if the
+        // table rehashes because a pass pushes names while iterating.
+        std::shared_ptr<const Entries> entries;
+        size_t pos = 0;
+
+        bool at_end() const {
+            return !entries || pos == entries->size();
+        }
 
     public:
-        explicit const_iterator(const typename std::map<std::string, SmallStack<T>>::const_iterator &i)
-            : iter(i) {
+        explicit const_iterator(std::shared_ptr<const Entries> e)
+            : entries(std::move(e)) {
         }
 
+        // The default-constructed iterator is the end iterator.
         const_iterator() = default;
 
         bool operator!=(const const_iterator &other) {
-            return iter != other.iter;
+            if (at_end() || other.at_end()) {
+                return at_end() != other.at_end();
+            }
+            return entries != other.entries || pos != other.pos;
         }
 
         void operator++() {
-            ++iter;
+            ++pos;
         }
 
         const std::string &name() {
-            return iter->first;
+            return (*entries)[pos]->first;
         }
 
         const SmallStack<T> &stack() {
-            return iter->second;
+            return (*entries)[pos]->second;
         }
 
         template<typename T2 = T,
                  typename = typename std::enable_if<!std::is_same<T2, void>::value>::type>
         const T2 &value() {
-            return iter->second.top_ref();
+            return (*entries)[pos]->second.top_ref();
         }
     };
 
     const_iterator cbegin() const {
-        return const_iterator(table.begin());
+        if (table.empty()) {
+            return const_iterator();
+        }
+        if (!sorted_entries) {
+            auto sorted = std::make_shared<Entries>();
+            sorted->reserve(table.size());
+            for (const auto &entry : table) {
+                sorted->push_back(&entry);
+            }
+            std::sort(sorted->begin(), sorted->end(),
+                      [](const typename Table::value_type *a, const typename Table::value_type *b) {
+                          return a->first < b->first;
+                      });
+            sorted_entries = std::move(sorted);
+        }
+        return const_iterator(sorted_entries);
     }
 
     const_iterator cend() const {
-        return const_iterator(table.end());
+        return const_iterator();
     }
 
     void swap(Scope<T> &other) {
         table.swap(other.table);
+        sorted_entries.swap(other.sorted_entries);
         std::swap(containing_scope, other.containing_scope);
     }
 };
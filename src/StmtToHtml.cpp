@@ -3,10 +3,15 @@
 #include "IRVisitor.h"
 #include "Scope.h"
 
+#include <algorithm>
 #include <cstdio>
+#include <cstdlib>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <iterator>
+#include <map>
+#include <set>
 #include <sstream>
 
 namespace Halide {
@@ -22,6 +27,133 @@ std::string to_string(T value) {
     return os.str();
 }
 
+// The per-run numbers for one Func in a profiler report.
+struct FuncProfile {
+    double time_ms = 0;
+    double threads = 0;
+    double heap_peak = 0, num_allocs = 0, avg_alloc = 0, stack_peak = 0;
+};
+
+// The per-run numbers for one pipeline in a profiler report.
+struct PipelineProfile {
+    double time_ms = 0;
+    double heap_peak = 0;
+    std::map<string, FuncProfile> funcs;
+};
+
+// The profiler names Funcs by everything before the first '.', so
+// that "f.s0.x" belongs to "f".
+string profiled_func_name(const string &name) {
+    return name.substr(0, name.find('.'));
+}
+
+// Parse the number following key in line, if key is present.
+bool parse_value_after(const string &line, const string &key, double *value) {
+    size_t pos = line.find(key);
+    if (pos == string::npos) {
+        return false;
+    }
+    const char *start = line.c_str() + pos + key.size();
+    char *end = nullptr;
+    double v = std::strtod(start, &end);
+    if (end == start) {
+        return false;
+    }
+    *value = v;
+    return true;
+}
+
+// Parse the text printed by halide_profiler_report(), which looks like:
+//
+// pipeline_name
+//  total time: 12.5 ms  samples: 120  runs: 10  time/run: 1.25 ms
+//  heap allocations: 20  peak heap usage: 65536 bytes
+//   f:                     0.875ms   (70%)   peak: 65536   num: 2   avg: 32768
+//   g:                     0.375ms   (30%)
+//
+// Lines that aren't part of a report (e.g. other output of the program
+// that was profiled) are ignored.
+std::map<string, PipelineProfile> parse_profiler_report(const string &filename) {
+    std::ifstream in(filename.c_str());
+    user_assert(in) << "Could not open profiler report " << filename << "\n";
+
+    std::map<string, PipelineProfile> profiles;
+    PipelineProfile *current = nullptr;
+    string last_name, line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] != ' ') {
+            last_name = line;
+            current = nullptr;
+        } else if (line.compare(0, 13, " total time: ") == 0) {
+            current = &profiles[last_name];
+            double runs = 1;
+            parse_value_after(line, "runs:", &runs);
+            if (!parse_value_after(line, "time/run:", &current->time_ms)) {
+                parse_value_after(line, "total time:", &current->time_ms);
+                current->time_ms /= std::max(runs, 1.0);
+            }
+        } else if (current == nullptr) {
+            continue;
+        } else if (line.compare(0, 2, "  ") != 0) {
+            parse_value_after(line, "peak heap usage:", &current->heap_peak);
+        } else {
+            size_t colon = line.find(": ", 2);
+            if (colon == string::npos) {
+                continue;
+            }
+            string name = line.substr(2, colon - 2);
+            string rest = line.substr(colon + 2);
+            FuncProfile &f = current->funcs[name];
+            parse_value_after(rest, "", &f.time_ms);
+            parse_value_after(rest, "threads:", &f.threads);
+            parse_value_after(rest, "peak:", &f.heap_peak);
+            parse_value_after(rest, "num:", &f.num_allocs);
+            parse_value_after(rest, "avg:", &f.avg_alloc);
+            parse_value_after(rest, "stack:", &f.stack_peak);
+        }
+    }
+
+    // Reports of pipelines that take no measurable time have no total.
+    for (auto &p : profiles) {
+        if (p.second.time_ms <= 0) {
+            for (const auto &f : p.second.funcs) {
+                p.second.time_ms += f.second.time_ms;
+            }
+        }
+    }
+    return profiles;
+}
+
+string format_bytes(double bytes) {
+    const char *units[] = {"B", "KB", "MB", "GB", "TB"};
+    int unit = 0;
+    while (bytes >= 1024 && unit < 4) {
+        bytes /= 1024;
+        unit++;
+    }
+    std::ostringstream s;
+    s << std::setprecision(3) << bytes << " " << units[unit];
+    return s.str();
+}
+
+// Collect the (profiler) names of all Funcs produced in a Stmt.
+class FuncsProduced : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const ProducerConsumer *op) override {
+        if (op->is_producer) {
+            names.insert(profiled_func_name(op->name));
+        }
+        IRVisitor::visit(op);
+    }
+
+public:
+    std::set<string> names;
+};
+
 class StmtToHtml : public IRVisitor {
 
     static const std::string css, js;
@@ -32,6 +164,92 @@ class StmtToHtml : public IRVisitor {
 private:
     std::ofstream stream;
 
+    // The profiler reports read from the file passed to the
+    // constructor, by pipeline name, and the one that applies to the
+    // function being printed (if any).
+    std::map<string, PipelineProfile> profiles;
+    const PipelineProfile *profile = nullptr;
+
+    const PipelineProfile *find_profile(const string &pipeline_name) const {
+        auto it = profiles.find(pipeline_name);
+        if (it != profiles.end()) {
+            return &it->second;
+        }
+        // A report of a single pipeline applies to whatever we're printing.
+        if (profiles.size() == 1) {
+            return &profiles.begin()->second;
+        }
+        return nullptr;
+    }
+
+    // An annotation colored by the fraction of the total time it
+    // accounts for, from pale yellow for none of it to red for all of it.
+    string heat_span(double time_ms, const string &text, const string &title) {
+        double fraction = profile->time_ms > 0 ? time_ms / profile->time_ms : 0;
+        fraction = std::min(std::max(fraction, 0.0), 1.0);
+        std::ostringstream s;
+        s << "<span class='Profile' title='" << title << "' style='background-color: hsla("
+          << (int)(60 * (1 - fraction)) << ", 100%, 50%, " << 0.1 + 0.6 * fraction << ");'>"
+          << std::fixed << std::setprecision(3) << time_ms << "ms "
+          << std::setprecision(1) << "(" << 100 * fraction << "%)" << text
+          << "</span>";
+        return s.str();
+    }
+
+    // The annotation for the produce node of a Func.
+    string func_profile(const string &name) {
+        if (profile == nullptr) {
+            return "";
+        }
+        auto it = profile->funcs.find(profiled_func_name(name));
+        if (it == profile->funcs.end()) {
+            return "";
+        }
+        const FuncProfile &f = it->second;
+        std::ostringstream text, title;
+        title << it->first << ": " << f.time_ms << "ms per run";
+        if (f.threads > 0) {
+            title << ", " << f.threads << " threads on average";
+        }
+        if (f.heap_peak > 0) {
+            text << ", peak " << format_bytes(f.heap_peak);
+            title << ", peak heap usage " << format_bytes(f.heap_peak)
+                  << " in " << f.num_allocs << " allocations of "
+                  << format_bytes(f.avg_alloc) << " on average";
+        }
+        if (f.stack_peak > 0) {
+            title << ", peak stack usage " << format_bytes(f.stack_peak);
+        }
+        return " " + heat_span(f.time_ms, text.str(), title.str());
+    }
+
+    // The profiler only measures time per Func, so a loop is charged
+    // with the time of the Func it belongs to plus that of every Func
+    // produced inside it. When a Func has several loops at the same
+    // level (e.g. for its update definitions), each is charged with all
+    // of its time.
+    string loop_profile(const For *op) {
+        if (profile == nullptr) {
+            return "";
+        }
+        FuncsProduced produced;
+        op->body.accept(&produced);
+        produced.names.insert(profiled_func_name(op->name));
+        double time_ms = 0;
+        string names;
+        for (const string &name : produced.names) {
+            auto it = profile->funcs.find(name);
+            if (it != profile->funcs.end()) {
+                time_ms += it->second.time_ms;
+                names += (names.empty() ? "" : ", ") + name;
+            }
+        }
+        if (names.empty()) {
+            return "";
+        }
+        return " " + heat_span(time_ms, "", "Time spent in " + names);
+    }
+
     int unique_id() {
         return ++id_count;
     }
@@ -374,7 +592,9 @@ private:
         stream << var(op->name);
         stream << close_expand_button() << " {";
         stream << close_span();
-        ;
+        if (op->is_producer) {
+            stream << func_profile(op->name);
+        }
         stream << open_div(op->is_producer ? "ProduceBody Indent" : "ConsumeBody Indent", produce_id);
         print(op->body);
         stream << close_div();
@@ -413,6 +633,7 @@ private:
         stream << matched(")");
         stream << close_expand_button();
         stream << " " << matched("{");
+        stream << loop_profile(op);
         stream << open_div("ForBody Indent", id);
         print(op->body);
         stream << close_div();
@@ -733,8 +954,17 @@ public:
         ir.accept(this);
     }
 
+    // Print a Stmt that isn't part of a LoweredFunc, annotated with the
+    // profiler report if there is exactly one.
+    void print_with_profile(const Stmt &ir) {
+        profile = find_profile("");
+        print(ir);
+        profile = nullptr;
+    }
+
     void print(const LoweredFunc &op) {
         scope.push(op.name, unique_id());
+        profile = find_profile(op.name);
         stream << open_div("Function");
 
         int id = unique_id();
@@ -752,6 +982,13 @@ public:
         stream << matched(")");
         stream << close_expand_button();
         stream << " " << matched("{");
+        if (profile != nullptr) {
+            stream << " <span class='ProfileTotal'>" << profile->time_ms << "ms per run";
+            if (profile->heap_peak > 0) {
+                stream << ", peak heap usage " << format_bytes(profile->heap_peak);
+            }
+            stream << "</span>";
+        }
         stream << open_div("FunctionBody Indent", id);
         print(op.body);
         stream << close_div();
@@ -759,6 +996,7 @@ public:
 
         stream << close_div();
         scope.pop(op.name);
+        profile = nullptr;
     }
 
     void print(const Buffer<> &op) {
@@ -797,8 +1035,14 @@ public:
         scope.pop(m.name());
     }
 
-    StmtToHtml(const string &filename)
+    StmtToHtml(const string &filename, const string &profile_report)
         : id_count(0), context_stack(1, 0) {
+        if (!profile_report.empty()) {
+            profiles = parse_profiler_report(profile_report);
+            if (profiles.empty()) {
+                user_warning << "No profiler report found in " << profile_report << "\n";
+            }
+        }
         stream.open(filename.c_str());
         stream << "<head>";
         stream << "<style type='text/css'>" << css << "</style>\n";
@@ -839,6 +1083,8 @@ span.IntImm { color: #099; }\n \
 span.FloatImm { color: #099; }\n \
 b.Highlight { font-weight: bold; background-color: #DDD; }\n \
 span.Highlight { font-weight: bold; background-color: #FF0; }\n \
+span.Profile { margin-left: 10px; padding: 0px 4px; border-radius: 3px; color: #333; }\n \
+span.ProfileTotal { margin-left: 10px; color: #998; font-style: italic; }\n \
 ";
 
 const std::string StmtToHtml::js = "\n \
@@ -859,13 +1105,13 @@ function toggle(id) { \n \
 }";
 }  // namespace
 
-void print_to_html(const string &filename, const Stmt &s) {
-    StmtToHtml sth(filename);
-    sth.print(s);
+void print_to_html(const string &filename, const Stmt &s, const string &profile_report) {
+    StmtToHtml sth(filename, profile_report);
+    sth.print_with_profile(s);
 }
 
-void print_to_html(const string &filename, const Module &m) {
-    StmtToHtml sth(filename);
+void print_to_html(const string &filename, const Module &m, const string &profile_report) {
+    StmtToHtml sth(filename, profile_report);
     sth.print(m);
 }
 
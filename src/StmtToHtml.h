@@ -11,12 +11,21 @@ namespace Halide {
 namespace Internal {
 
 /**
- * Dump an HTML-formatted print of a Stmt to filename.
+ * Dump an HTML-formatted print of a Stmt to filename. If
+ * profile_report is non-empty, it names a file holding the output of
+ * halide_profiler_report() for a run of the pipeline compiled with
+ * Target::Profile; each produce node and loop is then annotated with
+ * the time spent in it (and produce nodes with the Func's peak heap
+ * usage), colored as a heatmap.
  */
-void print_to_html(const std::string &filename, const Stmt &s);
+void print_to_html(const std::string &filename, const Stmt &s,
+                   const std::string &profile_report = "");
 
-/** Dump an HTML-formatted print of a Module to filename. */
-void print_to_html(const std::string &filename, const Module &m);
+/** Dump an HTML-formatted print of a Module to filename, optionally
+ * annotated with a profiler report as above. Each function in the
+ * Module is matched to the pipeline in the report with the same name. */
+void print_to_html(const std::string &filename, const Module &m,
+                   const std::string &profile_report = "");
 
 }  // namespace Internal
 }  // namespace Halide
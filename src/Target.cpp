@@ -375,6 +375,8 @@ const std::map<std::string, Target::Feature> feature_name_map = {
     {"sve2", Target::SVE2},
     {"arm_dot_prod", Target::ARMDotProd},
     {"llvm_large_code_model", Target::LLVMLargeCodeModel},
+    {"batch", Target::Batch},
+    {"persistent_workspace", Target::PersistentWorkspace},
     // NOTE: When adding features to this map, be sure to update PyEnums.cpp as well.
 };
 
@@ -127,6 +127,8 @@ struct Target {
         SVE2 = halide_target_feature_sve2,
         ARMDotProd = halide_target_feature_arm_dot_prod,
         LLVMLargeCodeModel = halide_llvm_large_code_model,
+        Batch = halide_target_feature_batch,
+        PersistentWorkspace = halide_target_feature_persistent_workspace,
         FeatureEnd = halide_target_feature_end
     };
     Target() = default;
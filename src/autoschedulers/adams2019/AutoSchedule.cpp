@@ -54,6 +54,9 @@
   HL_NO_SUBTILING
   If set to 1, limits the search space to that of Mullapudi et al.
 
+  HL_DISABLE_MEMOIZED_FEATURES
+  If set to 1, recompute the featurization of every state from scratch instead of reusing the features of loop nests unchanged from the parent state.
+
   HL_DEBUG_AUTOSCHEDULE
   If set, is used for the debug log level for auto-schedule generation (overriding the
   value of HL_DEBUG_CODEGEN, if any).
@@ -185,6 +188,10 @@ struct State {
     int num_decisions_made = 0;
     bool penalized = false;
 
+    // Whether to reuse the memoized features of the loop nests this
+    // state shares with its parent. Inherited by child states.
+    bool memoize_features = true;
+
     State() = default;
     State(const State &) = delete;
     State(State &&) = delete;
@@ -310,7 +317,7 @@ struct State {
             }
         }
 
-        root->compute_features(dag, params, sites, 1, 1, nullptr, nullptr, *root, nullptr, features);
+        root->compute_features(dag, params, sites, 1, 1, nullptr, nullptr, *root, nullptr, features, memoize_features);
 
         for (const auto &n : dag.nodes) {
             if (sites.get(&(n.stages[0])).produce == nullptr) {
@@ -421,6 +428,7 @@ struct State {
         s->root = root;
         s->cost = cost;
         s->num_decisions_made = num_decisions_made;
+        s->memoize_features = memoize_features;
         return s;
     }
 
@@ -992,6 +1000,7 @@ IntrusivePtr<State> optimal_schedule_pass(FunctionDAG &dag,
                                           std::mt19937 &rng,
                                           int beam_size,
                                           int64_t memory_limit,
+                                          bool memoize_features,
                                           int pass_idx,
                                           int num_passes,
                                           ProgressBar &tick,
@@ -1007,6 +1016,7 @@ IntrusivePtr<State> optimal_schedule_pass(FunctionDAG &dag,
     {
         IntrusivePtr<State> initial{new State};
         initial->root = new LoopNest;
+        initial->memoize_features = memoize_features;
         q.emplace(std::move(initial));
     }
 
@@ -1051,6 +1061,7 @@ IntrusivePtr<State> optimal_schedule_pass(FunctionDAG &dag,
                                              rng,
                                              beam_size * 2,
                                              memory_limit,
+                                             memoize_features,
                                              pass_idx,
                                              num_passes,
                                              tick,
@@ -1191,7 +1202,8 @@ IntrusivePtr<State> optimal_schedule(FunctionDAG &dag,
                                      CostModel *cost_model,
                                      std::mt19937 &rng,
                                      int beam_size,
-                                     int64_t memory_limit) {
+                                     int64_t memory_limit,
+                                     bool memoize_features) {
 
     IntrusivePtr<State> best;
 
@@ -1217,7 +1229,7 @@ IntrusivePtr<State> optimal_schedule(FunctionDAG &dag,
         ProgressBar tick;
 
         auto pass = optimal_schedule_pass(dag, outputs, params, cost_model,
-                                          rng, beam_size, memory_limit,
+                                          rng, beam_size, memory_limit, memoize_features,
                                           i, num_passes, tick, permitted_hashes);
 
         tick.clear();
@@ -1295,7 +1307,8 @@ void generate_schedule(const std::vector<Function> &outputs,
     IntrusivePtr<State> optimal;
 
     // Run beam search
-    optimal = optimal_schedule(dag, outputs, params, cost_model.get(), rng, beam_size, memory_limit);
+    optimal = optimal_schedule(dag, outputs, params, cost_model.get(), rng, beam_size, memory_limit,
+                               use_memoized_features());
 
     HALIDE_TOC;
 
@@ -1369,10 +1382,12 @@ void find_and_apply_schedule(FunctionDAG &dag,
                              CostModel *cost_model,
                              int beam_size,
                              int64_t memory_limit,
-                             StageMap<ScheduleFeatures> *schedule_features) {
+                             StageMap<ScheduleFeatures> *schedule_features,
+                             bool memoize_features) {
 
     std::mt19937 rng(12345);
-    IntrusivePtr<State> optimal = optimal_schedule(dag, outputs, params, cost_model, rng, beam_size, memory_limit);
+    IntrusivePtr<State> optimal = optimal_schedule(dag, outputs, params, cost_model, rng, beam_size, memory_limit,
+                                                   memoize_features);
 
     // Apply the schedules
     optimal->apply_schedule(dag, params);
@@ -12,7 +12,8 @@ namespace Autoscheduler {
 typedef PerfectHashMap<FunctionDAG::Node::Stage, ScheduleFeatures> StageMapOfScheduleFeatures;
 
 void find_and_apply_schedule(FunctionDAG &dag, const std::vector<Function> &outputs, const MachineParams &params,
-                             CostModel *cost_model, int beam_size, StageMapOfScheduleFeatures *schedule_features);
+                             CostModel *cost_model, int beam_size, int64_t memory_limit,
+                             StageMapOfScheduleFeatures *schedule_features, bool memoize_features = true);
 
 }  // namespace Autoscheduler
 }  // namespace Internal
@@ -55,25 +55,26 @@ void DefaultCostModel::set_pipeline_features(const Internal::Autoscheduler::Func
     static_assert(sizeof(PipelineFeatures) - 7 * sizeof(int) ==
                       sizeof(int) * pipeline_feat_size,
                   "Incorrect size for pipeline features");
-    int num_stages = 0;
+    stage_order.clear();
+    stage_order_dag = &dag;
     for (const auto &n : dag.nodes) {
-        if (!n.is_input) num_stages += (int)n.stages.size();
+        if (n.is_input) continue;
+        for (auto it = n.stages.rbegin(); it != n.stages.rend(); it++) {
+            stage_order.push_back(&*it);
+        }
     }
+    const int num_stages = (int)stage_order.size();
     Runtime::Buffer<float> pipeline_features(head1_w, head1_h, num_stages);
     int stage = 0;
-    for (const auto &n : dag.nodes) {
-        if (n.is_input) continue;
-        for (auto it = n.stages.rbegin(); it != n.stages.rend(); it++) {
-            const auto &s = *it;
-            const int *pipeline_feats = (const int *)(&(s.features)) + 7;
-            // skip the first 7 features
-            for (int i = 0; i < pipeline_feat_size; i++) {
-                int x = i / 7;
-                int y = i % 7;
-                pipeline_features(x, y, stage) = pipeline_feats[i];
-            }
-            stage += 1;
+    for (const auto *s : stage_order) {
+        const int *pipeline_feats = (const int *)(&(s->features)) + 7;
+        // skip the first 7 features
+        for (int i = 0; i < pipeline_feat_size; i++) {
+            int x = i / 7;
+            int y = i % 7;
+            pipeline_features(x, y, stage) = pipeline_feats[i];
         }
+        stage += 1;
     }
     internal_assert(stage == num_stages);
     pipeline_feat_queue = pipeline_features;
@@ -82,6 +83,10 @@ void DefaultCostModel::set_pipeline_features(const Internal::Autoscheduler::Func
 }
 
 void DefaultCostModel::set_pipeline_features(const Runtime::Buffer<float> &pipeline_feats, int n) {
+    // There's no DAG to derive a stage order from, so only the
+    // buffer-based enqueue can be used after this.
+    stage_order.clear();
+    stage_order_dag = nullptr;
     pipeline_feat_queue = pipeline_feats;
     internal_assert(n > 0);
     num_cores = n;
@@ -90,6 +95,9 @@ void DefaultCostModel::set_pipeline_features(const Runtime::Buffer<float> &pipel
 void DefaultCostModel::enqueue(const Internal::Autoscheduler::FunctionDAG &dag,
                                const Halide::Internal::Autoscheduler::StageMapOfScheduleFeatures &schedule_feats,
                                double *cost_ptr) {
+    internal_assert(stage_order_dag == &dag)
+        << "Call set_pipeline_features with this FunctionDAG before enqueueing schedule features\n";
+
     num_stages = (int)schedule_feats.size();
 
     Runtime::Buffer<float> schedule_features;
@@ -100,36 +108,30 @@ void DefaultCostModel::enqueue(const Internal::Autoscheduler::FunctionDAG &dag,
     // batched.
     enqueue(num_stages, &schedule_features, cost_ptr);
 
-    // index of current stage whose features we are reading
-    int stage = 0;
-    // load schedule features into input buffer
-    for (const auto &n : dag.nodes) {
-
-        // Inputs are computed outside of the pipeline and don't count.
-        if (n.is_input) continue;
-
-        // The remaining stages are not yet
-        // scheduled. Optimistically assume their internal costs
-        // will not depend on the decisions made already, so
-        // there's no point adding it on to the total because it's
-        // the same across all states.  An underestimate of the
-        // cost for loading from these unscheduled stages is
-        // already baked into the scheduled stages that consume
-        // them.
-        if (stage >= num_stages) break;
-
-        // Load up the schedule features for all stages of this Func.
-        for (auto it = n.stages.rbegin(); it != n.stages.rend(); it++) {
-            internal_assert(schedule_feats.contains(&*it)) << n.func.name() << "\n";
-            const auto &feat = schedule_feats.get(&*it);
-            for (size_t i = 0; i < ScheduleFeatures::num_features(); i++) {
-                schedule_features(i, stage) = feat[i];
-            }
-            stage += 1;
+    internal_assert(num_stages <= (int)stage_order.size());
+
+    // This state's features are a strided column of the
+    // structure-of-arrays queue. Write each one straight into place
+    // instead of going through Buffer::operator() per element.
+    //
+    // Stages beyond num_stages are not yet scheduled. Optimistically
+    // assume their internal costs will not depend on the decisions
+    // made already, so there's no point adding it on to the total
+    // because it's the same across all states. An underestimate of
+    // the cost for loading from these unscheduled stages is already
+    // baked into the scheduled stages that consume them.
+    float *dst = schedule_features.data();
+    const int feature_stride = schedule_features.dim(0).stride();
+    const int stage_stride = schedule_features.dim(1).stride();
+    for (int stage = 0; stage < num_stages; stage++) {
+        const auto *s = stage_order[stage];
+        internal_assert(schedule_feats.contains(s)) << s->node->func.name() << "\n";
+        const auto &feat = schedule_feats.get(s);
+        float *column = dst + stage * stage_stride;
+        for (size_t i = 0; i < ScheduleFeatures::num_features(); i++) {
+            column[i * feature_stride] = (float)feat[i];
         }
     }
-    // Check we considered everything we were supposed to.
-    internal_assert(stage == num_stages);
 }
 
 void DefaultCostModel::enqueue(int ns, Runtime::Buffer<float> *schedule_feats, double *cost_ptr) {
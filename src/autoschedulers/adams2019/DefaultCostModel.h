@@ -4,16 +4,29 @@
 #include "CostModel.h"
 #include "Weights.h"
 #include <string>
+#include <vector>
 
 namespace Halide {
 
 class DefaultCostModel : public CostModel {
 private:
     Internal::Weights weights;
+
+    // The queues are laid out structure-of-arrays with the batch
+    // innermost: schedule_feat_queue(batch, feature, stage). An
+    // enqueued state is a strided column of this buffer, which the
+    // cost model pipeline consumes directly.
     Runtime::Buffer<float> schedule_feat_queue, pipeline_feat_queue, costs;
     Runtime::Buffer<double *> cost_ptrs;
     int cursor, num_stages, num_cores;
 
+    // The pipeline stages in the order the cost model expects them,
+    // so that enqueueing a state doesn't need to walk the DAG.
+    std::vector<const Internal::Autoscheduler::FunctionDAG::Node::Stage *> stage_order;
+
+    // The DAG that stage_order was built from, if any.
+    const Internal::Autoscheduler::FunctionDAG *stage_order_dag = nullptr;
+
     const std::string weights_in_path, weights_out_path;
     const bool randomize_weights;
 
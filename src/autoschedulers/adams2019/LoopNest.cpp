@@ -12,6 +12,12 @@ namespace Autoscheduler {
 // registers.
 const int kUnrollLimit = 12;
 
+// How many featurizations of a child of the root to memoize before
+// starting over. A child is shared by every descendant of the state
+// that created it, and each new context it is featurized in adds an
+// entry, so this bounds the memory held by a long-lived loop nest.
+const size_t kMemoizedFeaturesLimit = 64;
+
 // Get the HL_NO_SUBTILING environment variable. Purpose described above.
 bool get_may_subtile() {
     string no_subtiling_str = get_env_variable("HL_NO_SUBTILING");
@@ -26,6 +32,16 @@ bool may_subtile() {
     return b;
 }
 
+// Get the HL_DISABLE_MEMOIZED_FEATURES environment variable. Purpose described above.
+bool get_use_memoized_features() {
+    string disable_str = get_env_variable("HL_DISABLE_MEMOIZED_FEATURES");
+    return disable_str != "1";
+}
+bool use_memoized_features() {
+    static bool b = get_use_memoized_features();
+    return b;
+}
+
 // Given a multi-dimensional box of dimensionality d, generate a list
 // of candidate tile sizes for it, logarithmically spacing the sizes
 // using the given factor. If 'allow_splits' is false, every dimension
@@ -224,6 +240,111 @@ void LoopNest::get_sites(StageMap<Sites> &sites,
     }
 }
 
+void LoopNest::InlinedCallSite::apply(StageMap<ScheduleFeatures> *features) const {
+    auto &inlined_feat = features->get_or_create(stage);
+    inlined_feat.inlined_calls += calls * instances;
+    inlined_feat.num_vectors += calls * num_vectors;
+    inlined_feat.num_scalars += calls * num_scalars;
+    inlined_feat.native_vector_size = native_vector_size;
+    if (inlined_feat.vector_size > 0) {
+        inlined_feat.vector_size = std::min(inlined_feat.vector_size, native_vector_size);
+    } else {
+        inlined_feat.vector_size = vector_size;
+    }
+    if (inlined_feat.innermost_pure_loop_extent > 0) {
+        inlined_feat.innermost_pure_loop_extent =
+            std::min(inlined_feat.innermost_pure_loop_extent,
+                     innermost_pure_loop_extent);
+    } else {
+        inlined_feat.innermost_pure_loop_extent = innermost_pure_loop_extent;
+    }
+    inlined_feat.inner_parallelism = 1;
+    inlined_feat.outer_parallelism = parallelism;
+}
+
+void LoopNest::collect_loops_and_stages(set<const LoopNest *> &loops,
+                                        set<const FunctionDAG::Node::Stage *> &stages) const {
+    loops.insert(this);
+    if (!is_root()) {
+        stages.insert(stage);
+    }
+    for (const auto *f : store_at) {
+        for (const auto &s : f->stages) {
+            stages.insert(&s);
+        }
+    }
+    for (auto it = inlined.begin(); it != inlined.end(); it++) {
+        stages.insert(&(it.key()->stages[0]));
+    }
+    for (const auto &c : children) {
+        c->collect_loops_and_stages(loops, stages);
+    }
+}
+
+void LoopNest::get_sites_key(const StageMap<Sites> &sites, vector<uint64_t> *key) const {
+    set<const LoopNest *> loops;
+    set<const FunctionDAG::Node::Stage *> stages;
+    collect_loops_and_stages(loops, stages);
+
+    // Loops inside this subtree live as long as its cache, so they
+    // can be identified by address. The root differs from state to
+    // state but always means the same thing. For a production site
+    // elsewhere we only ever look at its storage layout.
+    auto add_loop = [&](const LoopNest *l, bool produce) {
+        if (l == nullptr) {
+            key->push_back(1);
+        } else if (l->is_root()) {
+            key->push_back(2);
+        } else if (!produce || loops.count(l)) {
+            key->push_back((uint64_t)(uintptr_t)l);
+        } else {
+            key->push_back(3);
+            key->push_back((uint64_t)(l->vector_dim + 1));
+        }
+    };
+
+    // Walk from the stages in this subtree to everything they read,
+    // looking through any producer not stored at root.
+    vector<const FunctionDAG::Node::Stage *> pending(stages.begin(), stages.end());
+    while (!pending.empty()) {
+        const auto *s = pending.back();
+        pending.pop_back();
+        for (const auto *e : s->incoming_edges) {
+            const auto *p = &(e->producer->stages[0]);
+            if (stages.insert(p).second &&
+                sites.contains(p) &&
+                sites.get(p).store &&
+                !sites.get(p).store->is_root()) {
+                for (const auto &ps : e->producer->stages) {
+                    pending.push_back(&ps);
+                }
+            }
+        }
+    }
+
+    // The set is ordered by address, so sort by stage id to make the
+    // key independent of where the stages happen to live.
+    vector<const FunctionDAG::Node::Stage *> sorted_stages(stages.begin(), stages.end());
+    std::sort(sorted_stages.begin(), sorted_stages.end(),
+              [](const FunctionDAG::Node::Stage *a, const FunctionDAG::Node::Stage *b) {
+                  return a->id < b->id;
+              });
+
+    key->clear();
+    for (const auto *s : sorted_stages) {
+        key->push_back(s->id);
+        if (!sites.contains(s)) {
+            key->push_back(0);
+            continue;
+        }
+        const auto &site = sites.get(s);
+        key->push_back(site.inlined ? 2 : 1);
+        add_loop(site.compute, false);
+        add_loop(site.store, false);
+        add_loop(site.produce, true);
+    }
+}
+
 // Do a recursive walk over the loop nest computing features to feed the cost model.
 void LoopNest::compute_features(const FunctionDAG &dag,
                                 const MachineParams &params,
@@ -234,7 +355,9 @@ void LoopNest::compute_features(const FunctionDAG &dag,
                                 const LoopNest *grandparent,
                                 const LoopNest &root,
                                 int64_t *working_set,
-                                StageMap<ScheduleFeatures> *features) const {
+                                StageMap<ScheduleFeatures> *features,
+                                bool memoize_features,
+                                vector<InlinedCallSite> *inlined_call_sites) const {
     int64_t working_set_here = 0;
 
     int64_t loop_instances = 1, parallel_tasks = 1;
@@ -323,7 +446,43 @@ void LoopNest::compute_features(const FunctionDAG &dag,
     if (is_root()) {
         // TODO: This block of code is repeated below. Refactor
         for (const auto &c : children) {
-            c->compute_features(dag, params, sites, subinstances, parallelism, this, parent, root, &working_set_here, features);
+            if (!memoize_features) {
+                c->compute_features(dag, params, sites, subinstances, parallelism, this, parent, root, &working_set_here, features, false);
+                continue;
+            }
+
+            vector<uint64_t> key;
+            c->get_sites_key(sites, &key);
+            auto cached = c->features_cache.find(key);
+            if (cached != c->features_cache.end()) {
+                const auto &memo = cached->second;
+                for (const auto &f : memo.features) {
+                    features->insert(f.first, f.second);
+                }
+                for (const auto &i : memo.inlined_call_sites) {
+                    i.apply(features);
+                }
+                working_set_here += memo.working_set;
+                continue;
+            }
+
+            MemoizedFeatures memo;
+            c->compute_features(dag, params, sites, subinstances, parallelism, this, parent, root, &memo.working_set, features, false, &memo.inlined_call_sites);
+            working_set_here += memo.working_set;
+
+            set<const LoopNest *> loops;
+            set<const FunctionDAG::Node::Stage *> stages;
+            c->collect_loops_and_stages(loops, stages);
+            stages.clear();
+            for (const auto *l : loops) {
+                if (stages.insert(l->stage).second) {
+                    memo.features.emplace_back(l->stage, features->get(l->stage));
+                }
+            }
+            if (c->features_cache.size() >= kMemoizedFeaturesLimit) {
+                c->features_cache.clear();
+            }
+            c->features_cache.emplace(key, std::move(memo));
         }
 
         for (const auto *node : store_at) {
@@ -535,7 +694,7 @@ void LoopNest::compute_features(const FunctionDAG &dag,
 
     // Recurse inwards
     for (const auto &c : children) {
-        c->compute_features(dag, params, sites, subinstances, subparallelism, this, parent, root, &working_set_here, features);
+        c->compute_features(dag, params, sites, subinstances, subparallelism, this, parent, root, &working_set_here, features, false, inlined_call_sites);
     }
     for (const auto *node : store_at) {
         auto &feat = features->get(&(node->stages[0]));
@@ -932,25 +1091,20 @@ void LoopNest::compute_features(const FunctionDAG &dag,
     for (auto it = inlined.begin(); it != inlined.end(); it++) {
         const auto *f = it.key();
         internal_assert(f);
-        auto &inlined_feat = features->get_or_create(&(f->stages[0]));
-        inlined_feat.inlined_calls += it.value() * subinstances;
-        inlined_feat.num_vectors += it.value() * feat.num_vectors;
-        inlined_feat.num_scalars += it.value() * feat.num_scalars;
-        inlined_feat.native_vector_size = stage->vector_size;
-        if (inlined_feat.vector_size > 0) {
-            inlined_feat.vector_size = std::min(inlined_feat.vector_size, (double)stage->vector_size);
-        } else {
-            inlined_feat.vector_size = feat.vector_size;
-        }
-        if (inlined_feat.innermost_pure_loop_extent > 0) {
-            inlined_feat.innermost_pure_loop_extent =
-                std::min(inlined_feat.innermost_pure_loop_extent,
-                         feat.innermost_pure_loop_extent);
-        } else {
-            inlined_feat.innermost_pure_loop_extent = feat.innermost_pure_loop_extent;
+        InlinedCallSite call_site;
+        call_site.stage = &(f->stages[0]);
+        call_site.calls = it.value();
+        call_site.instances = subinstances;
+        call_site.parallelism = parallelism;
+        call_site.num_vectors = feat.num_vectors;
+        call_site.num_scalars = feat.num_scalars;
+        call_site.vector_size = feat.vector_size;
+        call_site.native_vector_size = stage->vector_size;
+        call_site.innermost_pure_loop_extent = feat.innermost_pure_loop_extent;
+        call_site.apply(features);
+        if (inlined_call_sites) {
+            inlined_call_sites->push_back(call_site);
         }
-        inlined_feat.inner_parallelism = 1;
-        inlined_feat.outer_parallelism = parallelism;
     }
 }
 
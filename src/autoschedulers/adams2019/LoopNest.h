@@ -8,6 +8,7 @@
 
 #include "FunctionDAG.h"
 #include "PerfectHashMap.h"
+#include <map>
 #include <set>
 #include <vector>
 
@@ -23,6 +24,11 @@ using StageMap = PerfectHashMap<FunctionDAG::Node::Stage, T>;
 
 bool may_subtile();
 
+// Whether features of unchanged subtrees of the loop nest are reused
+// across states. On by default; set HL_DISABLE_MEMOIZED_FEATURES=1 to
+// featurize every state from scratch.
+bool use_memoized_features();
+
 // Given a multi-dimensional box of dimensionality d, generate a list
 // of candidate tile sizes for it, logarithmically spacing the sizes
 // using the given factor. If 'allow_splits' is false, every dimension
@@ -122,7 +128,51 @@ struct LoopNest {
         }
     }
 
+    // The contribution one call site makes to the features of a Func
+    // inlined into it. These are recorded while featurizing a subtree
+    // so that they can be replayed in order when the subtree's
+    // features are reused.
+    struct InlinedCallSite {
+        const FunctionDAG::Node::Stage *stage = nullptr;
+        int64_t calls = 0;
+        int64_t instances = 0;
+        int64_t parallelism = 0;
+        double num_vectors = 0, num_scalars = 0;
+        double vector_size = 0, native_vector_size = 0;
+        double innermost_pure_loop_extent = 0;
+
+        void apply(StageMap<ScheduleFeatures> *features) const;
+    };
+
+    // The featurization of the subtree rooted at a child of the
+    // root. A new State shares all but one of the root's children
+    // with its parent, so these let us skip re-featurizing the
+    // unchanged ones.
+    struct MemoizedFeatures {
+        std::vector<std::pair<const FunctionDAG::Node::Stage *, ScheduleFeatures>> features;
+        std::vector<InlinedCallSite> inlined_call_sites;
+        int64_t working_set = 0;
+    };
+
+    // Memoized features keyed on get_sites_key. The full key is
+    // stored (rather than a hash of it) so that a hit is always
+    // exact. Only populated for children of the root, and cleared
+    // once it holds kMemoizedFeaturesLimit entries.
+    mutable std::map<std::vector<uint64_t>, MemoizedFeatures> features_cache;
+
+    // Describe everything outside this subtree that its featurization
+    // depends on: the compute, store, and production sites of the
+    // stages it computes, and those of every stage it reads from.
+    void get_sites_key(const StageMap<Sites> &sites, std::vector<uint64_t> *key) const;
+
+    // Gather all loop nodes in this subtree, and every stage computed,
+    // stored, or inlined within it.
+    void collect_loops_and_stages(std::set<const LoopNest *> &loops,
+                                  std::set<const FunctionDAG::Node::Stage *> &stages) const;
+
     // Do a recursive walk over the loop nest computing features to feed the cost model.
+    // If memoize_features is set on the root, the features of its children are reused
+    // from features_cache where possible.
     void compute_features(const FunctionDAG &dag,
                           const MachineParams &params,
                           const StageMap<Sites> &sites,
@@ -132,7 +182,9 @@ struct LoopNest {
                           const LoopNest *grandparent,
                           const LoopNest &root,
                           int64_t *working_set,
-                          StageMap<ScheduleFeatures> *features) const;
+                          StageMap<ScheduleFeatures> *features,
+                          bool memoize_features,
+                          std::vector<InlinedCallSite> *inlined_call_sites = nullptr) const;
 
     bool is_root() const {
         // The root is the sole node without a Func associated with
@@ -0,0 +1,85 @@
+#include "AutoSchedule.h"
+#include "DefaultCostModel.h"
+#include "Halide.h"
+
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Internal;
+using namespace Halide::Internal::Autoscheduler;
+
+namespace {
+
+// A chain of 3x3 stencils, with enough stages that most states share
+// several children of the root with their parent.
+Func make_stencil_chain(const Var &x, const Var &y) {
+    const int N = 6;
+    Func f[N];
+    f[0](x, y) = (x + y) * (x + 2 * y) * (x + 3 * y);
+    for (int i = 1; i < N; i++) {
+        Expr e = 0;
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                e += f[i - 1](x + dx, y + dy);
+            }
+        }
+        f[i](x, y) = e;
+    }
+    f[N - 1].set_estimate(x, 0, 2048).set_estimate(y, 0, 2048);
+    return f[N - 1];
+}
+
+// Search for a schedule of a fresh copy of the pipeline, and return the
+// featurization of the chosen state in DAG order.
+std::vector<double> search(const MachineParams &params, const Target &target, bool memoize_features) {
+    Var x("x"), y("y");
+    Func out = make_stencil_chain(x, y);
+    std::vector<Function> outputs = {out.function()};
+
+    FunctionDAG dag(outputs, params, target);
+    std::unique_ptr<DefaultCostModel> cost_model = make_default_cost_model();
+    StageMapOfScheduleFeatures features;
+    find_and_apply_schedule(dag, outputs, params, cost_model.get(), 32, -1, &features, memoize_features);
+
+    std::vector<double> result;
+    for (const auto &n : dag.nodes) {
+        for (const auto &s : n.stages) {
+            if (!features.contains(&s)) {
+                continue;
+            }
+            const auto &feat = features.get(&s);
+            for (size_t i = 0; i < ScheduleFeatures::num_features(); i++) {
+                result.push_back(feat[i]);
+            }
+        }
+    }
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    // Use a fixed target for the analysis to get consistent results from this test.
+    MachineParams params(32, 16000000, 40);
+    Target target("x86-64-linux-sse41-avx-avx2");
+
+    // Reusing the features of unchanged loop nests across states must
+    // not change what the cost model sees, so the search should pick a
+    // state with exactly the same featurization with and without it.
+    std::vector<double> memoized = search(params, target, true);
+    std::vector<double> unmemoized = search(params, target, false);
+
+    if (memoized.empty() || memoized != unmemoized) {
+        fprintf(stderr, "Memoized featurization changed the chosen schedule (%d vs %d features)\n",
+                (int)memoized.size(), (int)unmemoized.size());
+        for (size_t i = 0; i < memoized.size() && i < unmemoized.size(); i++) {
+            if (memoized[i] != unmemoized[i]) {
+                fprintf(stderr, "  feature %d: %f vs %f\n", (int)i, memoized[i], unmemoized[i]);
+            }
+        }
+        return 1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
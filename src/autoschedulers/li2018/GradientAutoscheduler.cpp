@@ -565,6 +565,129 @@ void parallelize_vars_and_rvars(
     }
 }
 
+// Tiling scatters into private accumulators can be disabled with
+// HL_LI2018_TILED_REDUCTIONS=0, e.g. to compare against using atomics.
+bool tiled_reductions_enabled() {
+    return get_env_variable("HL_LI2018_TILED_REDUCTIONS") != "0";
+}
+
+// An update that scatters into a Func (i.e. whose left hand side is not
+// just pure variables) has little parallelism in its pure variables, so
+// by default we parallelize its RVars with atomics, which thrashes the
+// cache when many threads hit the same lines. If the Func is small enough
+// that every core can keep a copy of it in its share of the cache, we
+// instead split the outermost RVar into one tile per task, and rfactor the
+// tiles into private accumulators that are merged afterwards. Returns
+// true if the update was tiled, in which case rvars and rvar_bounds are
+// replaced with the RVar and extent of the merge.
+bool tile_scatter_reduction(const MachineParams &params,
+                            const Target &target,
+                            Func func,
+                            int update_id,
+                            const std::vector<int> &var_bounds,
+                            std::vector<RVar> &rvars,
+                            std::vector<int> &rvar_bounds,
+                            std::ostringstream &schedule_source) {
+    if (rvars.empty() || rvar_bounds.back() < 2) {
+        return false;
+    }
+
+    const std::vector<Expr> &update_args = func.update_args(update_id);
+    bool is_scatter = false;
+    int parallelism = 1;
+    for (int arg_id = 0; arg_id < (int)update_args.size(); arg_id++) {
+        const Variable *var = update_args[arg_id].as<Variable>();
+        if (var != nullptr &&
+            !var->param.defined() &&
+            !var->image.defined() &&
+            !var->reduction_domain.defined()) {
+            parallelism *= var_bounds[arg_id];
+        } else {
+            is_scatter = true;
+        }
+    }
+    // Same threshold as for parallelizing the pure variables below.
+    if (!is_scatter || parallelism >= 8 * params.parallelism * 16) {
+        return false;
+    }
+
+    uint64_t footprint = 1;
+    for (int b : var_bounds) {
+        footprint *= b;
+    }
+    int bytes_per_point = 0;
+    for (const Type &t : func.output_types()) {
+        bytes_per_point += t.bytes();
+    }
+    footprint *= bytes_per_point;
+    if (footprint * params.parallelism > params.last_level_cache_size) {
+        return false;
+    }
+
+    std::vector<Expr> values = func.update_values(update_id).as_vector();
+    if (!prove_associativity(func.name(), update_args, values).associative()) {
+        return false;
+    }
+
+    // Tile the outermost RVar, which is also valid for non-commutative
+    // reductions. Two tiles per core balances the load.
+    RVar tiled = rvars.back();
+    int bound = rvar_bounds.back();
+    int num_tiles = std::min(bound, 2 * params.parallelism);
+    int split_size = (bound + num_tiles - 1) / num_tiles;
+    num_tiles = (bound + split_size - 1) / split_size;
+
+    schedule_source << func.name() << ".update(" << update_id << ")\n";
+    RVar outer, inner;
+    func.update(update_id)
+        .split(tiled, outer, inner, split_size, TailStrategy::GuardWithIf);
+    schedule_source << "    .split("
+                    << tiled.name() << ","
+                    << outer.name() << ","
+                    << inner.name() << ","
+                    << split_size << ","
+                    << TailStrategy::GuardWithIf << ")\n";
+    schedule_source << ";\n";
+
+    Var tile;
+    Func interim =
+        func.update(update_id)
+            .rfactor(outer, tile)
+            .compute_root();
+    schedule_source << interim.name() << " = "
+                    << func.name() << ".update(" << update_id << ")\n";
+    schedule_source << "    .rfactor(" << outer.name() << "," << tile.name() << ")\n";
+    schedule_source << "    .compute_root()\n";
+
+    // Initialize the accumulators in parallel over all of their
+    // dimensions. The tile is the outermost one.
+    std::vector<int> interim_bounds = var_bounds;
+    interim_bounds.push_back(num_tiles);
+    parallelize_vars_and_rvars_cpu(
+        params,
+        interim,
+        natural_vector_size(target, interim.values()[0].type()),
+        true,  // is_pure_def
+        interim.args(),
+        interim_bounds,
+        {},  // rvars
+        {},  // rvar_bounds
+        TailStrategy::ShiftInwards,
+        schedule_source);
+    schedule_source << ";\n";
+
+    // Each task scatters its tile of the reduction domain into its own
+    // accumulator, so there is no need for atomics.
+    interim.update(0).parallel(tile);
+    schedule_source << interim.name() << ".update()\n";
+    schedule_source << "    .parallel(" << tile.name() << ")\n";
+    schedule_source << ";\n";
+
+    rvars = {outer};
+    rvar_bounds = {num_tiles};
+    return true;
+}
+
 void apply_schedule(const MachineParams &params,
                     const Target &target,
                     Func func,
@@ -726,6 +849,12 @@ void apply_schedule(const MachineParams &params,
                     }
                 }
             }
+        } else if (!is_gpu && tiled_reductions_enabled()) {
+            if (tile_scatter_reduction(params, target, func, update_id, var_bounds,
+                                       rvars, rvar_bounds, schedule_source)) {
+                checked_associative = true;
+                is_associative = true;
+            }
         }
         // Gather pure variables
         std::vector<Expr> update_args = func.update_args(update_id);
@@ -1,6 +1,59 @@
 #include "Halide.h"
+#include "halide_benchmark.h"
 
 using namespace Halide;
+using namespace Halide::Tools;
+
+namespace {
+
+void set_tiled_reductions(bool enabled) {
+    const char *value = enabled ? "1" : "0";
+#ifdef _WIN32
+    _putenv_s("HL_LI2018_TILED_REDUCTIONS", value);
+#else
+    setenv("HL_LI2018_TILED_REDUCTIONS", value, 1);
+#endif
+}
+
+// The adjoint of the weights of a convolution layer scatters into a Func
+// that is much smaller than the reduction domain. Schedule it with and
+// without tiling the reduction into per-task accumulators, realize it
+// into output, and return the runtime in seconds.
+double benchmark_weight_gradient(const MachineParams &params, bool tiled, Buffer<float> output) {
+    const int width = 128, height = 128, channels = 16;
+    Buffer<float> input(width + 2, height + 2, channels);
+    Buffer<float> weights(3, 3, channels, channels);
+    input.for_each_element([&](int x, int y, int c) {
+        input(x, y, c) = ((x * 7 + y * 13 + c) % 17) / 17.f;
+    });
+    weights.for_each_element([&](int x, int y, int ci, int co) {
+        weights(x, y, ci, co) = ((x + y * 3 + ci * 5 + co * 11) % 7) / 7.f;
+    });
+
+    Var x("x"), y("y"), c("c");
+    RDom r(0, 3, 0, 3, 0, channels);
+    Func conv("conv");
+    conv(x, y, c) += weights(r.x, r.y, r.z, c) * input(x + r.x, y + r.y, r.z);
+    RDom o(0, width, 0, height, 0, channels);
+    Func loss("loss");
+    loss() += conv(o.x, o.y, o.z) * conv(o.x, o.y, o.z);
+
+    Derivative d = propagate_adjoints(loss);
+    Func d_weights = d(weights);
+    for (int i = 0; i < d_weights.dimensions(); i++) {
+        d_weights.set_estimate(d_weights.args()[i], 0, weights.dim(i).extent());
+    }
+
+    Target target = get_jit_target_from_environment();
+    set_tiled_reductions(tiled);
+    Pipeline p(d_weights);
+    p.auto_schedule(target, params);
+    p.compile_jit(target);
+
+    return benchmark([&]() { p.realize(output); });
+}
+
+}  // namespace
 
 int main(int argc, char **argv) {
     if (argc != 2) {
@@ -151,5 +204,32 @@ int main(int argc, char **argv) {
         std::cout << "Schedule for 2D pointwise operations with small x dimension:\n"
                   << result.schedule_source << "\n\n";
     }
+
+    {  // Scatter-style adjoint reduction, with and without tiling.
+        const int channels = 16;
+        Buffer<float> untiled_output(3, 3, channels, channels);
+        Buffer<float> tiled_output(3, 3, channels, channels);
+        double untiled = benchmark_weight_gradient(params, false, untiled_output);
+        double tiled = benchmark_weight_gradient(params, true, tiled_output);
+        set_tiled_reductions(true);
+
+        // The schedules sum in different orders, so allow for rounding.
+        bool mismatch = false;
+        tiled_output.for_each_element([&](int x, int y, int ci, int co) {
+            float a = untiled_output(x, y, ci, co);
+            float b = tiled_output(x, y, ci, co);
+            if (std::abs(a - b) > 1e-3f * std::max(1.f, std::abs(a))) {
+                fprintf(stderr, "d_weights(%d, %d, %d, %d): atomics %f, tiled %f\n",
+                        x, y, ci, co, a, b);
+                mismatch = true;
+            }
+        });
+        if (mismatch) {
+            return 1;
+        }
+        std::cout << "Convolution weight gradient:\n"
+                  << "    atomics: " << untiled * 1e3 << " ms\n"
+                  << "    tiled: " << tiled * 1e3 << " ms\n\n";
+    }
     return 0;
 }
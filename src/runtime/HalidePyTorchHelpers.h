@@ -3,9 +3,11 @@
 
 /** \file
  * Set of utility functions to wrap PyTorch tensors into Halide buffers,
- * making sure the data in on the correct device (CPU/GPU).
+ * making sure the data in on the correct device (CPU/GPU), and to size
+ * Halide's thread pool to match ATen's.
  */
 
+#include <atomic>
 #include <exception>
 #include <iostream>
 #include <sstream>
@@ -15,6 +17,7 @@
 #include "torch/extension.h"
 
 #include "HalideBuffer.h"
+#include "HalideRuntime.h"
 
 #ifdef HL_PT_CUDA
 #include "HalideRuntimeCuda.h"
@@ -41,6 +44,16 @@ inline std::vector<int> get_dims(const at::Tensor tensor) {
     return dims;
 }
 
+// Same as get_dims, but with the strides of the tensor too.
+inline std::vector<halide_dimension_t> get_shape(const at::Tensor tensor) {
+    int ndims = tensor.ndimension();
+    std::vector<halide_dimension_t> shape(ndims);
+    for (int dim = 0; dim < ndims; ++dim) {
+        shape[dim] = halide_dimension_t(0, tensor.size(ndims - 1 - dim), tensor.stride(ndims - 1 - dim));
+    }
+    return shape;
+}
+
 template<class scalar_t>
 inline void check_type(at::Tensor &tensor) {
     AT_ERROR("Scalar type ", tensor.scalar_type(), " not handled by Halide's PyTorch wrapper");
@@ -98,6 +111,7 @@ inline Buffer<scalar_t> wrap(at::Tensor &tensor) {
     // TODO(mgharbi): force Halide to put input/output on GPU?
     if (tensor.is_cuda()) {
 #ifdef HL_PT_CUDA
+        AT_ASSERTM(tensor.is_contiguous(), "CUDA tensors must be contiguous");
         buffer = Buffer<scalar_t>(dims);
         const halide_device_interface_t *cuda_interface = halide_cuda_device_interface();
         int err = buffer.device_wrap_native(cuda_interface, (uint64_t)pData);
@@ -107,12 +121,37 @@ inline Buffer<scalar_t> wrap(at::Tensor &tensor) {
         AT_ERROR("Trying to wrap a CUDA tensor, but HL_PT_CUDA was not defined: cuda is not available");
 #endif
     } else {
-        buffer = Buffer<scalar_t>(pData, dims);
+        // Use the tensor's memory as is, whatever its strides, so that views
+        // and preallocated outputs (including ones that alias an input, for
+        // in-place ops) don't need to be copied. The pipeline itself rejects
+        // any strides its schedule can't handle.
+        std::vector<halide_dimension_t> shape = get_shape(tensor);
+        buffer = Buffer<scalar_t>(pData, (int)shape.size(), shape.data());
     }
 
     return buffer;
 }
 
+// Called by the generated wrappers before running a pipeline. If the
+// extension is compiled with HL_PT_CAP_HALIDE_NUM_THREADS defined, caps
+// Halide's thread pool at ATen's intra-op thread count, so that Halide ops
+// and PyTorch ops don't oversubscribe the cores between them. All of
+// Halide's parallelism (parallel loops, including nested ones, and async
+// and task-parallel work) runs on that pool, so the cap covers all of it.
+//
+// Halide's thread pool is shared by the whole process, so the cap also
+// applies to any other Halide pipeline running in it, which is why it is
+// opt-in. The pool is only resized when ATen's thread count changes.
+inline void set_num_threads_from_aten() {
+#ifdef HL_PT_CAP_HALIDE_NUM_THREADS
+    static std::atomic<int> num_threads{0};
+    const int n = at::get_num_threads();
+    if (num_threads.exchange(n) != n) {
+        halide_set_num_threads(n);
+    }
+#endif
+}
+
 }  // namespace PyTorch
 }  // namespace Halide
 
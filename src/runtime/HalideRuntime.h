@@ -361,6 +361,17 @@ extern halide_malloc_t halide_set_custom_malloc(halide_malloc_t user_malloc);
 extern halide_free_t halide_set_custom_free(halide_free_t user_free);
 //@}
 
+/** Pipelines compiled with the persistent_workspace target feature
+ * keep the buffers backing their heap allocations between calls, and
+ * reuse them whenever a call needs no more memory at an allocation
+ * site than a previous one did. This releases all of those buffers
+ * that are not currently in use by a running pipeline back to
+ * halide_free, using the given user context. Pipelines will reallocate
+ * them as needed. AOT-compiled pipelines keep their buffers until this
+ * is called; JIT-compiled pipelines also release theirs when their code
+ * is freed. */
+extern void halide_release_workspaces(void *user_context);
+
 /** Halide calls these functions to interact with the underlying
  * system runtime functions. To replace in AOT code on platforms that
  * support weak linking, define these functions yourself, or use
@@ -1335,6 +1346,8 @@ typedef enum halide_target_feature_t {
     halide_target_feature_egl,                    ///< Force use of EGL support.
     halide_target_feature_arm_dot_prod,           ///< Enable ARMv8.2-a dotprod extension (i.e. udot and sdot instructions)
     halide_llvm_large_code_model,                 ///< Use the LLVM large code model to compile
+    halide_target_feature_batch,                  ///< Generate a batched entry point that runs a pipeline over an array of argument sets.
+    halide_target_feature_persistent_workspace,   ///< Keep and reuse the buffers backing heap allocations across calls to the pipeline.
     halide_target_feature_end                     ///< A sentinel. Every target is considered to have this feature, and setting this feature does nothing.
 } halide_target_feature_t;
 
@@ -0,0 +1,114 @@
+#include "HalideRuntime.h"
+#include "printer.h"
+
+namespace Halide {
+namespace Runtime {
+namespace Internal {
+
+struct batch_closure_t {
+    int (*pipeline)(void **args);
+    int (*unchecked_pipeline)(void **args);
+    const halide_filter_metadata_t *metadata;
+    void ***batch_args;
+};
+
+WEAK bool is_bounds_query(const halide_buffer_t *buf) {
+    return buf->host == nullptr && buf->device == 0;
+}
+
+// Check that the arguments of an element would pass the same argument
+// checks as those of the first element, which has already run with them.
+WEAK bool same_shapes_and_scalars(const halide_filter_metadata_t *metadata, void **first, void **args) {
+    for (int i = 0; i < metadata->num_arguments; i++) {
+        const halide_filter_argument_t *arg = &metadata->arguments[i];
+        if (arg->kind == halide_argument_kind_input_scalar) {
+            // The user context doesn't take part in any checks.
+            if (strcmp(arg->name, "__user_context") == 0) {
+                continue;
+            }
+            size_t bytes = ((arg->type.bits + 7) / 8) * arg->type.lanes;
+            if (memcmp(first[i], args[i], bytes) != 0) {
+                return false;
+            }
+            continue;
+        }
+        const halide_buffer_t *a = (const halide_buffer_t *)first[i];
+        const halide_buffer_t *b = (const halide_buffer_t *)args[i];
+        if (is_bounds_query(a) || is_bounds_query(b) ||
+            a->type != b->type ||
+            a->dimensions != b->dimensions) {
+            return false;
+        }
+        for (int d = 0; d < a->dimensions; d++) {
+            if (a->dim[d] != b->dim[d]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+WEAK int batch_task(void *user_context, int idx, uint8_t *closure) {
+    const batch_closure_t *c = (const batch_closure_t *)closure;
+    void **args = c->batch_args[idx];
+    if (c->unchecked_pipeline &&
+        same_shapes_and_scalars(c->metadata, c->batch_args[0], args)) {
+        return c->unchecked_pipeline(args);
+    }
+    return c->pipeline(args);
+}
+
+}  // namespace Internal
+}  // namespace Runtime
+}  // namespace Halide
+
+using namespace Halide::Runtime::Internal;
+
+extern "C" {
+
+WEAK int halide_batch_call_pipeline(void *user_context,
+                                    int (*pipeline)(void **args), int (*unchecked_pipeline)(void **args),
+                                    const halide_filter_metadata_t *metadata,
+                                    void ***batch_args, int batch_size) {
+    if (batch_size == 0) {
+        return halide_error_code_success;
+    }
+    if (batch_size < 0 || batch_args == nullptr) {
+        error(user_context) << "Invalid batch passed to " << metadata->name << "_batch: "
+                            << "batch_args=" << (void *)batch_args << " batch_size=" << batch_size << "\n";
+        return halide_error_code_generic_error;
+    }
+
+    // Every element must supply a non-null buffer for every buffer
+    // argument; the per-element argv wrapper does not check this.
+    for (int b = 0; b < batch_size; b++) {
+        if (batch_args[b] == nullptr) {
+            error(user_context) << "Element " << b << " of the batch passed to "
+                                << metadata->name << "_batch is null\n";
+            return halide_error_code_generic_error;
+        }
+        for (int i = 0; i < metadata->num_arguments; i++) {
+            const halide_filter_argument_t *arg = &metadata->arguments[i];
+            if ((arg->kind == halide_argument_kind_input_buffer ||
+                 arg->kind == halide_argument_kind_output_buffer) &&
+                batch_args[b][i] == nullptr) {
+                error(user_context) << "Buffer argument " << arg->name << " of element " << b
+                                    << " of the batch passed to " << metadata->name << "_batch is null\n";
+                return halide_error_code_buffer_argument_is_null;
+            }
+        }
+    }
+
+    // Run the first element with all of the argument checks. Every
+    // other element whose buffers have the same shapes and whose scalar
+    // arguments have the same values would pass the same checks, so
+    // those run without them.
+    int result = pipeline(batch_args[0]);
+    if (result != halide_error_code_success || batch_size == 1) {
+        return result;
+    }
+    batch_closure_t closure = {pipeline, unchecked_pipeline, metadata, batch_args};
+    return halide_do_par_for(user_context, batch_task, 1, batch_size - 1, (uint8_t *)&closure);
+}
+
+}  // extern "C"
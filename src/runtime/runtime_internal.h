@@ -76,6 +76,9 @@ typedef int32_t intptr_t;
 extern "C" {
 void *halide_malloc(void *user_context, size_t x);
 void halide_free(void *user_context, void *ptr);
+WEAK void *halide_workspace_malloc(void *user_context, void **workspace, int slot_index, size_t size);
+WEAK void halide_workspace_free(void *user_context, void *ptr);
+WEAK void halide_release_workspace(void *user_context, void **workspace);
 WEAK int64_t halide_current_time_ns(void *user_context);
 WEAK void halide_print(void *user_context, const char *msg);
 WEAK void halide_error(void *user_context, const char *msg);
@@ -164,9 +167,15 @@ WEAK int halide_device_and_host_free(void *user_context, struct halide_buffer_t
 
 struct halide_filter_metadata_t;
 
+WEAK int halide_batch_call_pipeline(void *user_context,
+                                    int (*pipeline)(void **args), int (*unchecked_pipeline)(void **args),
+                                    const halide_filter_metadata_t *metadata,
+                                    void ***batch_args, int batch_size);
+
 struct mxArray;
 WEAK int halide_matlab_call_pipeline(void *user_context,
-                                     int (*pipeline)(void **args), const halide_filter_metadata_t *metadata,
+                                     int (*pipeline)(void **args), int (*unchecked_pipeline)(void **args),
+                                    const halide_filter_metadata_t *metadata,
                                      int nlhs, mxArray **plhs, int nrhs, const mxArray **prhs);
 
 WEAK int halide_trace_helper(void *user_context,
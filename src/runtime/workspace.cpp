@@ -0,0 +1,240 @@
+#include "HalideRuntime.h"
+#include "runtime_internal.h"
+#include "scoped_mutex_lock.h"
+
+// Persistent workspaces back the heap allocations of pipelines
+// compiled with Target::PersistentWorkspace. Each such pipeline owns
+// one workspace, with one slot per heap allocation site. A slot keeps
+// the buffer it last handed out, so a later call that asks for the
+// same amount of memory (or less) at the same site gets back the same,
+// already-faulted-in pages without going through halide_malloc. If the
+// slot is in use (because the pipeline is running concurrently, or the
+// allocation is inside a parallel loop), or the request is larger than
+// the slot, the allocation falls back to halide_malloc.
+//
+// Buffers are only freed when their owner asks, with a user context
+// that their allocator accepts: halide_release_workspaces frees the idle
+// buffers of every pipeline, and halide_release_workspace frees one
+// pipeline's workspace (JIT-compiled pipelines call it with their own
+// handlers before their code is unloaded). Neither frees a buffer that
+// a running pipeline is using.
+
+namespace Halide {
+namespace Runtime {
+namespace Internal {
+
+struct workspace_slot_t {
+    void *base;
+    size_t size;
+    int in_use;
+};
+
+#define WORKSPACE_CHUNK_SLOTS 16
+
+struct workspace_chunk_t {
+    workspace_slot_t slots[WORKSPACE_CHUNK_SLOTS];
+    workspace_chunk_t *next;
+};
+
+struct workspace_t {
+    workspace_chunk_t chunk;
+    workspace_t *next;
+};
+
+// Stored immediately before every pointer returned by
+// halide_workspace_malloc. slot is null for fallback allocations.
+struct workspace_header_t {
+    workspace_slot_t *slot;
+    void *base;
+};
+
+WEAK halide_mutex workspaces_lock;
+WEAK workspace_t *workspaces = nullptr;
+
+WEAK void *workspace_chunk_malloc(void *user_context, size_t size) {
+    void *p = halide_malloc(user_context, size);
+    if (p) {
+        memset(p, 0, size);
+    }
+    return p;
+}
+
+// Find the given slot of a workspace, creating the workspace and any
+// chunks needed along the way. Returns null if that fails.
+WEAK workspace_slot_t *find_workspace_slot(void *user_context, void **workspace, int slot) {
+    workspace_t *ws = (workspace_t *)__atomic_load_n(workspace, __ATOMIC_ACQUIRE);
+    if (ws == nullptr) {
+        ScopedMutexLock lock(&workspaces_lock);
+        ws = (workspace_t *)__atomic_load_n(workspace, __ATOMIC_ACQUIRE);
+        if (ws == nullptr) {
+            ws = (workspace_t *)workspace_chunk_malloc(user_context, sizeof(workspace_t));
+            if (ws == nullptr) {
+                return nullptr;
+            }
+            ws->next = workspaces;
+            workspaces = ws;
+            __atomic_store_n(workspace, (void *)ws, __ATOMIC_RELEASE);
+        }
+    }
+
+    workspace_chunk_t *chunk = &ws->chunk;
+    while (slot >= WORKSPACE_CHUNK_SLOTS) {
+        workspace_chunk_t *next = __atomic_load_n(&chunk->next, __ATOMIC_ACQUIRE);
+        if (next == nullptr) {
+            ScopedMutexLock lock(&workspaces_lock);
+            next = __atomic_load_n(&chunk->next, __ATOMIC_ACQUIRE);
+            if (next == nullptr) {
+                next = (workspace_chunk_t *)workspace_chunk_malloc(user_context, sizeof(workspace_chunk_t));
+                if (next == nullptr) {
+                    return nullptr;
+                }
+                __atomic_store_n(&chunk->next, next, __ATOMIC_RELEASE);
+            }
+        }
+        chunk = next;
+        slot -= WORKSPACE_CHUNK_SLOTS;
+    }
+    return &chunk->slots[slot];
+}
+
+WEAK void *workspace_allocate(void *user_context, workspace_slot_t *slot, size_t size, void **base) {
+    const size_t header_size = halide_malloc_alignment();
+    *base = halide_malloc(user_context, size + header_size);
+    if (*base == nullptr) {
+        return nullptr;
+    }
+    void *ptr = (uint8_t *)(*base) + header_size;
+    workspace_header_t *header = (workspace_header_t *)ptr - 1;
+    header->slot = slot;
+    header->base = *base;
+    return ptr;
+}
+
+// Mark every slot of a workspace as in use. If one already is, unmark
+// the ones marked so far and return false.
+WEAK bool claim_workspace_slots(workspace_t *ws) {
+    int claimed = 0;
+    for (workspace_chunk_t *chunk = &ws->chunk; chunk != nullptr; chunk = chunk->next) {
+        for (int i = 0; i < WORKSPACE_CHUNK_SLOTS; i++) {
+            if (!__atomic_exchange_n(&chunk->slots[i].in_use, 1, __ATOMIC_ACQUIRE)) {
+                claimed++;
+                continue;
+            }
+            for (workspace_chunk_t *c = &ws->chunk; claimed > 0; c = c->next) {
+                for (int j = 0; j < WORKSPACE_CHUNK_SLOTS && claimed > 0; j++, claimed--) {
+                    __atomic_store_n(&c->slots[j].in_use, 0, __ATOMIC_RELEASE);
+                }
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace Internal
+}  // namespace Runtime
+}  // namespace Halide
+
+using namespace Halide::Runtime::Internal;
+
+extern "C" {
+
+WEAK void *halide_workspace_malloc(void *user_context, void **workspace, int slot_index, size_t size) {
+    workspace_slot_t *slot = find_workspace_slot(user_context, workspace, slot_index);
+    if (slot == nullptr || __atomic_exchange_n(&slot->in_use, 1, __ATOMIC_ACQUIRE)) {
+        void *base;
+        return workspace_allocate(user_context, nullptr, size, &base);
+    }
+
+    if (slot->base != nullptr && slot->size >= size) {
+        return (uint8_t *)slot->base + halide_malloc_alignment();
+    }
+
+    // The slot is empty or too small for this request (e.g. because the
+    // input shapes have grown), so replace its buffer.
+    if (slot->base != nullptr) {
+        halide_free(user_context, slot->base);
+        slot->base = nullptr;
+        slot->size = 0;
+    }
+    void *ptr = workspace_allocate(user_context, slot, size, &slot->base);
+    if (ptr == nullptr) {
+        slot->base = nullptr;
+        __atomic_store_n(&slot->in_use, 0, __ATOMIC_RELEASE);
+        return nullptr;
+    }
+    slot->size = size;
+    return ptr;
+}
+
+WEAK void halide_workspace_free(void *user_context, void *ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    workspace_header_t *header = (workspace_header_t *)ptr - 1;
+    if (header->slot) {
+        // Keep the buffer for the next call.
+        __atomic_store_n(&header->slot->in_use, 0, __ATOMIC_RELEASE);
+    } else {
+        halide_free(user_context, header->base);
+    }
+}
+
+WEAK void halide_release_workspaces(void *user_context) {
+    ScopedMutexLock lock(&workspaces_lock);
+    for (workspace_t *ws = workspaces; ws != nullptr; ws = ws->next) {
+        for (workspace_chunk_t *chunk = &ws->chunk; chunk != nullptr; chunk = chunk->next) {
+            for (int i = 0; i < WORKSPACE_CHUNK_SLOTS; i++) {
+                workspace_slot_t *slot = &chunk->slots[i];
+                // Skip slots that a running pipeline is using.
+                if (__atomic_exchange_n(&slot->in_use, 1, __ATOMIC_ACQUIRE)) {
+                    continue;
+                }
+                if (slot->base != nullptr) {
+                    halide_free(user_context, slot->base);
+                    slot->base = nullptr;
+                    slot->size = 0;
+                }
+                __atomic_store_n(&slot->in_use, 0, __ATOMIC_RELEASE);
+            }
+        }
+    }
+}
+
+WEAK void halide_release_workspace(void *user_context, void **workspace) {
+    ScopedMutexLock lock(&workspaces_lock);
+    workspace_t *ws = (workspace_t *)__atomic_load_n(workspace, __ATOMIC_ACQUIRE);
+    if (ws == nullptr) {
+        return;
+    }
+
+    // Claim every slot, so that no call can start using one. If a call
+    // is still using any of them, leave the workspace on the list for
+    // halide_release_workspaces instead.
+    if (!claim_workspace_slots(ws)) {
+        return;
+    }
+
+    __atomic_store_n(workspace, nullptr, __ATOMIC_RELEASE);
+    for (workspace_t **prev = &workspaces; *prev != nullptr; prev = &(*prev)->next) {
+        if (*prev == ws) {
+            *prev = ws->next;
+            break;
+        }
+    }
+    workspace_chunk_t *chunk = &ws->chunk;
+    while (chunk != nullptr) {
+        for (int i = 0; i < WORKSPACE_CHUNK_SLOTS; i++) {
+            if (chunk->slots[i].base != nullptr) {
+                halide_free(user_context, chunk->slots[i].base);
+            }
+        }
+        workspace_chunk_t *next = chunk->next;
+        if (chunk != &ws->chunk) {
+            halide_free(user_context, chunk);
+        }
+        chunk = next;
+    }
+    halide_free(user_context, ws);
+}
+}
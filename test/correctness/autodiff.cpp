@@ -1417,6 +1417,95 @@ void test_random_float() {
     check(__LINE__, d_input(), o(0));
 }
 
+void test_checkpoint() {
+    Var x("x");
+    Buffer<float> input(4);
+    for (int i = 0; i < 4; i++) {
+        input(i) = i + 1.f;
+    }
+    Func f("f");
+    f(x) = input(x) * input(x);
+    Func g("g");
+    g(x) = sin(f(x));
+    RDom r(0, 4);
+    Func loss("loss");
+    loss() += g(r.x);
+
+    // The adjoint of g reads f, which is checkpointed by default.
+    auto find_checkpoint = [&](const Derivative &d) {
+        for (const Checkpoint &c : d.checkpoints()) {
+            if (c.name == f.name()) {
+                return c;
+            }
+        }
+        _halide_user_assert(false) << "No checkpoint for f\n";
+        return Checkpoint();
+    };
+    Derivative d = propagate_adjoints(loss);
+    Checkpoint c = find_checkpoint(d);
+    _halide_user_assert(!c.recomputed && c.bytes == 16);
+    _halide_user_assert(d.checkpointed_bytes() == 16);
+
+    // Recomputing f must not change the gradient.
+    CheckpointPolicy policy;
+    policy.recompute = {f};
+    Derivative d_recompute = propagate_adjoints(loss, policy);
+    c = find_checkpoint(d_recompute);
+    _halide_user_assert(c.recomputed && c.bytes == 16);
+    _halide_user_assert(d_recompute.checkpointed_bytes() == 0);
+
+    // A budget too small for f recomputes it automatically.
+    CheckpointPolicy budget;
+    budget.memory_budget = 8;
+    Derivative d_budget = propagate_adjoints(loss, budget);
+    _halide_user_assert(find_checkpoint(d_budget).recomputed);
+
+    Buffer<float> d_input = d(input).realize(4);
+    Buffer<float> d_input_recompute = d_recompute(input).realize(4);
+    Buffer<float> d_input_budget = d_budget(input).realize(4);
+    for (int i = 0; i < 4; i++) {
+        float in = i + 1.f;
+        // d loss / d input = cos(input^2) * 2 input
+        float expected = std::cos(in * in) * 2.f * in;
+        check(__LINE__, d_input(i), expected, 1e-5f);
+        check(__LINE__, d_input_recompute(i), expected, 1e-5f);
+        check(__LINE__, d_input_budget(i), expected, 1e-5f);
+    }
+}
+
+void test_checkpoint_net_savings() {
+    Var x("x");
+    Buffer<float> input(8);
+    for (int i = 0; i < 8; i++) {
+        input(i) = i + 1.f;
+    }
+    // wide has an update, so it can't be recomputed. Recomputing narrow
+    // would checkpoint wide instead, which is twice as large.
+    Func wide("wide");
+    wide(x) = input(x);
+    wide(x) += 1.f;
+    Func narrow("narrow");
+    narrow(x) = wide(2 * x) + wide(2 * x + 1);
+    RDom r(0, 4);
+    Func loss("loss");
+    loss() += sin(narrow(r.x));
+
+    CheckpointPolicy budget;
+    budget.memory_budget = 8;
+    Derivative d = propagate_adjoints(loss, budget);
+    for (const Checkpoint &c : d.checkpoints()) {
+        _halide_user_assert(c.name != wide.name() && !c.recomputed)
+            << c.name << " should not be in the checkpoint plan\n";
+    }
+    _halide_user_assert(d.checkpointed_bytes() == 16);
+
+    Buffer<float> d_input = d(input).realize(8);
+    for (int i = 0; i < 8; i++) {
+        float n = input(i / 2 * 2) + input(i / 2 * 2 + 1) + 2.f;
+        check(__LINE__, d_input(i), std::cos(n), 1e-5f);
+    }
+}
+
 int main(int argc, char **argv) {
     test_scalar<float>();
     test_scalar<double>();
@@ -1459,6 +1548,8 @@ int main(int argc, char **argv) {
     test_custom_adjoint_buffer();
     test_print();
     test_random_float();
+    test_checkpoint();
+    test_checkpoint_net_savings();
     printf("[autodiff] Success!\n");
     return 0;
 }
@@ -0,0 +1,117 @@
+#include "Halide.h"
+#include "halide_test_dirs.h"
+
+#include <cstdio>
+#include <string>
+
+using namespace Halide;
+using namespace Halide::ConciseCasts;
+
+// The C backend lowers vector widening multiplies, saturating add/sub and
+// absd to the <T>_ops helpers in its own prelude. The GPU backends that
+// derive from it (OpenCL, Metal, D3D12) must not emit those, since they
+// don't exist in the kernel language.
+
+struct VectorOps {
+    ImageParam a{UInt(8), 2, "a"}, b{UInt(8), 2, "b"};
+    Func widening_mul{"widening_mul"}, abs_diff{"abs_diff"};
+    Func sat_add{"sat_add"}, sat_sub{"sat_sub"};
+
+    VectorOps() {
+        Var x("x"), y("y"), xo("xo"), xi("xi"), bx("bx"), by("by"), tx("tx"), ty("ty");
+
+        widening_mul(x, y) = u16(a(x, y)) * u16(b(x, y));
+        abs_diff(x, y) = absd(a(x, y), b(x, y));
+        sat_add(x, y) = u8_sat(u16(a(x, y)) + u16(b(x, y)));
+        sat_sub(x, y) = u8(max(i16(a(x, y)) - i16(b(x, y)), 0));
+
+        for (Func f : {widening_mul, abs_diff, sat_add, sat_sub}) {
+            f.split(x, xo, xi, 4)
+                .vectorize(xi)
+                .gpu_tile(xo, y, bx, by, tx, ty, 8, 8);
+        }
+    }
+
+    Pipeline pipeline() {
+        return Pipeline({widening_mul, abs_diff, sat_add, sat_sub});
+    }
+};
+
+bool check_source(const Target &t) {
+    VectorOps ops;
+    std::string ll = Internal::get_test_tmp_dir() + "gpu_vector_ops_" + t.to_string() + ".ll";
+    Internal::ensure_no_file_exists(ll);
+    ops.pipeline().compile_to({{Output::llvm_assembly, ll}}, {ops.a, ops.b}, "gpu_vector_ops", t);
+    Internal::assert_file_exists(ll);
+
+    // The kernel source is embedded in the host module as a string.
+    std::vector<char> contents = Internal::read_entire_file(ll);
+    std::string src(contents.begin(), contents.end());
+    if (src.find("_ops::") != std::string::npos) {
+        printf("Kernel source for %s uses the C backend's vector ops:\n%s\n",
+               t.to_string().c_str(), src.c_str());
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    for (const char *t : {"x86-64-linux-opencl", "x86-64-osx-metal", "x86-64-windows-d3d12compute"}) {
+        if (!check_source(Target(t))) {
+            return -1;
+        }
+    }
+
+    Target t = get_jit_target_from_environment();
+    if (!t.has_gpu_feature()) {
+        printf("Not running the kernels: no GPU target enabled.\n");
+        printf("Success!\n");
+        return 0;
+    }
+
+    if (t.has_feature(Target::OpenGLCompute)) {
+        printf("[SKIP] No support for vector loads and stores in OpenGLCompute yet\n");
+        return 0;
+    }
+
+    const int W = 256, H = 64;
+    Buffer<uint8_t> in_a(W, H), in_b(W, H);
+    in_a.for_each_element([&](int x, int y) { in_a(x, y) = (uint8_t)(x * 7 + y * 13); });
+    in_b.for_each_element([&](int x, int y) { in_b(x, y) = (uint8_t)(x * 3 - y * 29); });
+
+    VectorOps ops;
+    ops.a.set(in_a);
+    ops.b.set(in_b);
+    Buffer<uint16_t> mul_out(W, H);
+    Buffer<uint8_t> absd_out(W, H), add_out(W, H), sub_out(W, H);
+    ops.pipeline().realize({mul_out, absd_out, add_out, sub_out}, t);
+    mul_out.copy_to_host();
+    absd_out.copy_to_host();
+    add_out.copy_to_host();
+    sub_out.copy_to_host();
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            int va = in_a(x, y), vb = in_b(x, y);
+            int mul = va * vb;
+            int diff = va > vb ? va - vb : vb - va;
+            int add = va + vb > 255 ? 255 : va + vb;
+            int sub = va > vb ? va - vb : 0;
+            if (mul_out(x, y) != mul || absd_out(x, y) != diff ||
+                add_out(x, y) != add || sub_out(x, y) != sub) {
+                printf("Mismatch at (%d, %d) for a = %d, b = %d:\n"
+                       "  widening_mul = %d instead of %d\n"
+                       "  absd = %d instead of %d\n"
+                       "  saturating_add = %d instead of %d\n"
+                       "  saturating_sub = %d instead of %d\n",
+                       x, y, va, vb,
+                       mul_out(x, y), mul, absd_out(x, y), diff,
+                       add_out(x, y), add, sub_out(x, y), sub);
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -185,7 +185,7 @@ void do_test() {
     luma_buf.copy_from(color_buf);
     luma_buf.slice(2);
 
-    std::vector<std::string> formats = {"ppm", "pgm", "tmp", "mat", "tiff"};
+    std::vector<std::string> formats = {"ppm", "pgm", "tmp", "mat", "npy", "tiff"};
 #ifndef HALIDE_NO_JPEG
     formats.push_back("jpg");
 #endif
@@ -255,10 +255,57 @@ void test_mat_header() {
     }
 }
 
+template<typename T>
+void test_map_image(Buffer<T> buf, std::string format) {
+    std::cout << "Testing map_image for format: " << format << " for " << halide_type_of<T>() << "\n";
+
+    std::string filename = Internal::get_test_tmp_dir() + "test_map_image." + format;
+    Tools::save_image(buf, filename);
+
+    Tools::MappedFile mapping;
+    Buffer<T> mapped;
+    if (!Tools::map_image<Buffer<T>, Tools::Internal::CheckFail>(filename, &mapping, &mapped)) {
+        printf("test_map_image: Could not map %s\n", filename.c_str());
+        abort();
+    }
+
+    // Raw formats should be wrapped in place rather than copied.
+    const uint8_t *host = (const uint8_t *)mapped.data();
+    if (mapping.data() == nullptr || host < mapping.data() || host >= mapping.data() + mapping.size()) {
+        printf("test_map_image: %s was not mapped in place\n", filename.c_str());
+        abort();
+    }
+
+    RDom r(mapped);
+    std::vector<Expr> args;
+    for (int i = 0; i < r.dimensions(); ++i) {
+        args.push_back(r[i]);
+    }
+    uint32_t diff = evaluate<uint32_t>(maximum(abs(cast<int>(buf(args)) - cast<int>(mapped(args)))));
+    if (diff > 0) {
+        printf("test_map_image: Difference of %d when mapped as %s\n", diff, format.c_str());
+        abort();
+    }
+}
+
+void test_map_image() {
+    Func f;
+    Var x, y, c, w;
+    f(x, y, c, w) = cast<uint8_t>(x + 3 * y + 7 * c);
+    Buffer<uint8_t> buf4 = f.realize(16, 12, 3, 1);
+    Buffer<uint8_t> buf3 = buf4.sliced(3);
+
+    test_map_image(buf4, "tmp");
+    test_map_image(buf3, "mat");
+    test_map_image(buf3, "npy");
+    test_map_image(buf3, "ppm");
+}
+
 int main(int argc, char **argv) {
     do_test<uint8_t>();
     do_test<uint16_t>();
     test_mat_header();
+    test_map_image();
     printf("Success!\n");
     return 0;
 }
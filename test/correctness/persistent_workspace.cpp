@@ -0,0 +1,140 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+// Check that with Target::PersistentWorkspace, heap allocations are
+// only made through halide_malloc when a call needs more memory than
+// any previous one.
+
+int mallocs = 0, frees = 0;
+int other_mallocs = 0, other_frees = 0;
+
+void *aligned_malloc(size_t x) {
+    void *orig = malloc(x + 64);
+    void *ptr = (void *)((((size_t)orig + 64) >> 6) << 6);
+    ((void **)ptr)[-1] = orig;
+    return ptr;
+}
+
+void aligned_free(void *ptr) {
+    free(((void **)ptr)[-1]);
+}
+
+void *my_malloc(void *user_context, size_t x) {
+    mallocs++;
+    return aligned_malloc(x);
+}
+
+void my_free(void *user_context, void *ptr) {
+    frees++;
+    aligned_free(ptr);
+}
+
+void *other_malloc(void *user_context, size_t x) {
+    other_mallocs++;
+    return aligned_malloc(x);
+}
+
+void other_free(void *user_context, void *ptr) {
+    other_frees++;
+    aligned_free(ptr);
+}
+
+int main(int argc, char **argv) {
+    Target t = get_jit_target_from_environment();
+    if (t.arch == Target::WebAssembly) {
+        printf("[SKIP] WebAssembly JIT does not support set_custom_allocator().\n");
+        return 0;
+    }
+
+    {
+        Func f, g, h;
+        Var x;
+
+        f(x) = x;
+        g(x) = f(x) * 2;
+        h(x) = g(x) + f(x);
+        f.compute_root();
+        g.compute_root();
+
+        h.set_custom_allocator(my_malloc, my_free);
+        h.compile_jit(t.with_feature(Target::PersistentWorkspace));
+
+        auto check = [&](int size) {
+            Buffer<int> im = h.realize(size);
+            for (int i = 0; i < size; i++) {
+                if (im(i) != i * 3) {
+                    printf("im(%d) = %d instead of %d\n", i, im(i), i * 3);
+                    exit(-1);
+                }
+            }
+        };
+
+        // The first call allocates the workspace and a buffer for each of f and g.
+        check(100000);
+        int first_mallocs = mallocs;
+        if (first_mallocs == 0 || frees != 0) {
+            printf("Expected the first call to allocate and keep its buffers (%d mallocs, %d frees)\n", mallocs, frees);
+            return -1;
+        }
+
+        // Calls of the same or smaller size reuse them.
+        check(100000);
+        check(1000);
+        if (mallocs != first_mallocs || frees != 0) {
+            printf("Expected smaller calls to reuse the workspace (%d mallocs, %d frees)\n", mallocs, frees);
+            return -1;
+        }
+
+        // A larger call replaces them, after which they're reused again.
+        check(200000);
+        int grown_mallocs = mallocs;
+        if (grown_mallocs != first_mallocs + 2 || frees != 2) {
+            printf("Expected a larger call to replace both buffers (%d mallocs, %d frees)\n", mallocs, frees);
+            return -1;
+        }
+        check(150000);
+        if (mallocs != grown_mallocs) {
+            printf("Expected the grown workspace to be reused (%d mallocs)\n", mallocs);
+            return -1;
+        }
+    }
+
+    // Freeing the pipeline gives back the workspace and its buffers.
+    if (frees != mallocs) {
+        printf("Expected freeing the pipeline to release the workspace (%d mallocs, %d frees)\n", mallocs, frees);
+        return -1;
+    }
+
+    // Changing the allocator of a pipeline gives its buffers back to
+    // the allocator that made them.
+    {
+        mallocs = frees = 0;
+        Func f, g;
+        Var x;
+        f(x) = x;
+        g(x) = f(x) + 1;
+        f.compute_root();
+
+        g.set_custom_allocator(my_malloc, my_free);
+        g.compile_jit(t.with_feature(Target::PersistentWorkspace));
+        g.realize(10000);
+        g.set_custom_allocator(other_malloc, other_free);
+        if (mallocs == 0 || frees != mallocs || other_frees != 0) {
+            printf("Expected the old allocator to free everything it allocated (%d mallocs, %d frees, %d other frees)\n",
+                   mallocs, frees, other_frees);
+            return -1;
+        }
+        g.compile_jit(t.with_feature(Target::PersistentWorkspace));
+        g.realize(10000);
+    }
+    if (other_mallocs == 0 || other_frees != other_mallocs || frees != mallocs) {
+        printf("Expected the new allocator to free everything it allocated (%d mallocs, %d frees)\n",
+               other_mallocs, other_frees);
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -2,6 +2,8 @@
 #include "halide_test_dirs.h"
 
 #include <cstdio>
+#include <fstream>
+#include <sstream>
 
 using namespace Halide;
 
@@ -44,6 +46,28 @@ int main() {
     tuple_func.compile_to_lowered_stmt(result_file_3, {}, Halide::HTML);
     Internal::assert_file_exists(result_file_3);
 
+    // Check annotating the loop nest with a profiler report.
+    std::string report_file = Internal::get_test_tmp_dir() + "stmt_to_html_profile.txt";
+    {
+        std::ofstream report(report_file);
+        report << "gradient_fast\n"
+               << " total time: 20.000000 ms  samples: 20  runs: 10  time/run: 2.000000 ms\n"
+               << " heap allocations: 0  peak heap usage: 0 bytes\n"
+               << "  gradient_fast:         1.500ms   (75%)   \n";
+    }
+    std::string result_file_4 = Internal::get_test_tmp_dir() + "stmt_to_html_dump_4.html";
+    Internal::ensure_no_file_exists(result_file_4);
+    Module m = gradient_fast.compile_to_module({}, "gradient_fast");
+    Internal::print_to_html(result_file_4, m, report_file);
+    Internal::assert_file_exists(result_file_4);
+    std::ifstream html(result_file_4);
+    std::stringstream contents;
+    contents << html.rdbuf();
+    if (contents.str().find("1.500ms (75.0%)") == std::string::npos) {
+        printf("Profiler report was not rendered into %s\n", result_file_4.c_str());
+        return -1;
+    }
+
     printf("Success!\n");
     return 0;
 }
@@ -0,0 +1,88 @@
+#include "HalideBuffer.h"
+#include "HalideRuntime.h"
+#include "batch.h"
+
+#include <stdio.h>
+#include <vector>
+
+using namespace Halide::Runtime;
+
+// Run the pipeline over a batch of 64x64 patches via batch_batch() and
+// check each element against its own inputs. Element i gets an offset of
+// i * offset_step.
+int check(const std::vector<int> &widths, int offset_step, bool expect_failure) {
+    const int n = (int)widths.size();
+    std::vector<Buffer<int32_t>> inputs, outputs;
+    std::vector<int32_t> offsets(n);
+    std::vector<std::vector<void *>> argvs(n);
+    std::vector<void **> batch_args(n);
+    for (int i = 0; i < n; i++) {
+        inputs.emplace_back(widths[i], 64);
+        outputs.emplace_back(64, 64);
+        inputs[i].for_each_element([&](int x, int y) { inputs[i](x, y) = x + y * 64 + i; });
+        offsets[i] = i * offset_step;
+    }
+    for (int i = 0; i < n; i++) {
+        argvs[i] = {inputs[i].raw_buffer(), &offsets[i], outputs[i].raw_buffer()};
+        batch_args[i] = argvs[i].data();
+    }
+
+    int result = batch_batch(batch_args.data(), n);
+    if (expect_failure) {
+        if (result == 0) {
+            printf("Expected batch of %d to fail\n", n);
+            return -1;
+        }
+        return 0;
+    }
+    if (result != 0) {
+        printf("Error %d for batch of %d\n", result, n);
+        return -1;
+    }
+    for (int i = 0; i < n; i++) {
+        bool ok = true;
+        outputs[i].for_each_element([&](int x, int y) {
+            int32_t correct = inputs[i](x, y) * 2 + offsets[i];
+            if (ok && outputs[i](x, y) != correct) {
+                printf("output[%d](%d, %d) = %d instead of %d\n", i, x, y, outputs[i](x, y), correct);
+                ok = false;
+            }
+        });
+        if (!ok) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    halide_set_error_handler([](void *, const char *) {});
+
+    // Homogeneous batches, which skip the argument checks after the
+    // first element.
+    if (check({}, 0, false) != 0 ||
+        check({64}, 0, false) != 0 ||
+        check(std::vector<int>(2, 64), 0, false) != 0 ||
+        check(std::vector<int>(100, 64), 0, false) != 0) {
+        return -1;
+    }
+
+    // Heterogeneous batches, which check every element that differs from
+    // the first: wider inputs are fine, since only the region needed by
+    // the output is read, and so are differing scalar arguments.
+    if (check({64, 80, 64, 96}, 0, false) != 0 ||
+        check(std::vector<int>(100, 64), 3, false) != 0) {
+        return -1;
+    }
+
+    // An element whose input is too small must fail the whole batch,
+    // whether it is the first element or a later one.
+    if (check(std::vector<int>(8, 32), 0, true) != 0 ||
+        check({64, 64, 32, 64}, 0, true) != 0 ||
+        check({32, 64, 64, 64}, 0, true) != 0) {
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
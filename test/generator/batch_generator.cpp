@@ -0,0 +1,23 @@
+#include "Halide.h"
+
+using namespace Halide;
+
+namespace {
+
+class Batch : public Halide::Generator<Batch> {
+public:
+    Input<Buffer<int32_t>> input{"input", 2};
+    Input<int32_t> offset{"offset"};
+
+    Output<Buffer<int32_t>> output{"output", 2};
+
+    void generate() {
+        Var x, y;
+        output(x, y) = input(x, y) * 2 + offset;
+        output.parallel(y);
+    }
+};
+
+}  // namespace
+
+HALIDE_REGISTER_GENERATOR(Batch, batch)
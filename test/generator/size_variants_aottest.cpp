@@ -0,0 +1,46 @@
+#include "HalideBuffer.h"
+#include "HalideRuntime.h"
+#include "size_variants.h"
+
+#include <stdio.h>
+
+using namespace Halide::Runtime;
+
+// The library is built with dispatch_sizes=64,4096, so outputs of at
+// most 64 elements use variant 0, at most 4096 use variant 1, and
+// anything larger uses variant 2.
+int check(int width, int height, int expected_variant) {
+    Buffer<int32_t> input(width, height), output(width, height);
+    input.for_each_element([&](int x, int y) { input(x, y) = x + y * width; });
+
+    int result = size_variants(input, output);
+    if (result != 0) {
+        printf("Error %d for %dx%d\n", result, width, height);
+        return -1;
+    }
+    bool ok = true;
+    output.for_each_element([&](int x, int y) {
+        if (ok && output(x, y) != input(x, y) + expected_variant) {
+            printf("output(%d, %d) = %d for %dx%d instead of %d\n",
+                   x, y, output(x, y), width, height, input(x, y) + expected_variant);
+            ok = false;
+        }
+    });
+    return ok ? 0 : -1;
+}
+
+int main(int argc, char **argv) {
+    // Alternate between sizes to check the variant is chosen per call.
+    for (int i = 0; i < 2; i++) {
+        if (check(8, 8, 0) != 0 ||
+            check(8, 9, 1) != 0 ||
+            check(64, 64, 1) != 0 ||
+            check(64, 65, 2) != 0 ||
+            check(4, 2, 0) != 0) {
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,27 @@
+#include "Halide.h"
+
+namespace {
+
+class SizeVariants : public Halide::Generator<SizeVariants> {
+public:
+    // Built with a different value for each size variant, so the
+    // test can tell which variant was called.
+    GeneratorParam<int> variant{"variant", -1};
+
+    Input<Buffer<int32_t>> input{"input", 2};
+    Output<Buffer<int32_t>> output{"output", 2};
+
+    void generate() {
+        Var x, y;
+        output(x, y) = input(x, y) + variant;
+    }
+
+    void schedule() {
+        input.set_estimates({{0, 1024}, {0, 1024}});
+        output.set_estimates({{0, 1024}, {0, 1024}});
+    }
+};
+
+}  // namespace
+
+HALIDE_REGISTER_GENERATOR(SizeVariants, size_variants)
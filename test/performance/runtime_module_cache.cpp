@@ -0,0 +1,72 @@
+#include "Halide.h"
+#include "halide_test_dirs.h"
+
+#include <chrono>
+#include <cstdio>
+#include <set>
+#include <sstream>
+#include <string>
+
+using namespace Halide;
+
+// Compiling for the same target repeatedly reuses the linked runtime
+// module: the first compile links it, the second links it and keeps a
+// copy as bitcode, and the rest parse that copy. Check that every
+// compile produces the same functions, and report how long each took.
+
+// Compile a small pipeline to LLVM assembly and return the names of the
+// functions it defines.
+std::set<std::string> compile(const Target &t, const std::string &ll, double *ms) {
+    Func f("f");
+    Var x("x"), y("y");
+    f(x, y) = x + y;
+    f.parallel(y).vectorize(x, 8);
+
+    Internal::ensure_no_file_exists(ll);
+    auto start = std::chrono::high_resolution_clock::now();
+    f.compile_to_llvm_assembly(ll, {}, "runtime_module_cache", t);
+    auto end = std::chrono::high_resolution_clock::now();
+    *ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    std::vector<char> contents = Internal::read_entire_file(ll);
+    std::istringstream lines(std::string(contents.begin(), contents.end()));
+    std::set<std::string> defined;
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.compare(0, 7, "define ") == 0) {
+            size_t at = line.find('@');
+            defined.insert(line.substr(at, line.find('(', at) - at));
+        }
+    }
+    return defined;
+}
+
+int main(int argc, char **argv) {
+    Target t = get_target_from_environment();
+    if (t.arch == Target::WebAssembly) {
+        printf("[SKIP] Performance tests are meaningless and/or misleading under WebAssembly interpreter.\n");
+        return 0;
+    }
+
+    const std::string ll = Internal::get_test_tmp_dir() + "runtime_module_cache.ll";
+    const int compiles = 5;
+    std::set<std::string> first;
+    for (int i = 0; i < compiles; i++) {
+        double ms;
+        std::set<std::string> defined = compile(t, ll, &ms);
+        printf("Compile %d for %s: %g ms, %d functions\n", i, t.to_string().c_str(), ms, (int)defined.size());
+        if (i == 0) {
+            first = defined;
+            if (first.empty()) {
+                printf("Found no function definitions in %s\n", ll.c_str());
+                return -1;
+            }
+        } else if (defined != first) {
+            printf("Compile %d defined different functions than the first one\n", i);
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -5,28 +5,37 @@
 #define HALIDE_IMAGE_IO_H
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cstdarg>
 #include <cstddef>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <functional>
 #include <map>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
-#ifndef HALIDE_NO_PNG
-#include "png.h"
-#endif
-
-#ifndef HALIDE_NO_JPEG
 #ifdef _WIN32
 #ifndef NOMINMAX
 #define NOMINMAX
 #endif
 #include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
+
+#ifndef HALIDE_NO_PNG
+#include "png.h"
+#endif
+
+#ifndef HALIDE_NO_JPEG
 #include "jpeglib.h"
 #endif
 
@@ -59,6 +68,111 @@ struct FormatInfo {
     }
 };
 
+// A copy-on-write mapping of an entire file into memory. Pages are
+// only read from disk when they are first touched, and writes through
+// the mapping are private to this process: they are never written back
+// to the file. Used by map_image() below; the mapping must outlive any
+// image that wraps it.
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&other) noexcept
+        : addr(other.addr), length(other.length) {
+        other.addr = nullptr;
+        other.length = 0;
+    }
+
+    MappedFile &operator=(MappedFile &&other) noexcept {
+        if (this != &other) {
+            unmap();
+            std::swap(addr, other.addr);
+            std::swap(length, other.length);
+        }
+        return *this;
+    }
+
+    ~MappedFile() {
+        unmap();
+    }
+
+    // Map the given file, replacing any existing mapping. Returns false
+    // if the file can't be opened or is empty.
+    bool map(const std::string &filename) {
+        unmap();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0) {
+            CloseHandle(file);
+            return false;
+        }
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr) {
+            return false;
+        }
+        // The view keeps the mapping object alive.
+        void *p = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+        CloseHandle(mapping);
+        if (p == nullptr) {
+            return false;
+        }
+        length = (size_t)file_size.QuadPart;
+#else
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            close(fd);
+            return false;
+        }
+        // The mapping keeps the file alive.
+        void *p = mmap(nullptr, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) {
+            return false;
+        }
+        length = (size_t)st.st_size;
+#endif
+        addr = (uint8_t *)p;
+        return true;
+    }
+
+    void unmap() {
+        if (addr == nullptr) {
+            return;
+        }
+#ifdef _WIN32
+        UnmapViewOfFile(addr);
+#else
+        munmap(addr, length);
+#endif
+        addr = nullptr;
+        length = 0;
+    }
+
+    uint8_t *data() const {
+        return addr;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+private:
+    uint8_t *addr = nullptr;
+    size_t length = 0;
+};
+
 namespace Internal {
 
 // Must be constexpr to allow use in case clauses.
@@ -1194,12 +1308,9 @@ bool buffer_is_compact_planar(ImageType &im) {
     return true;
 }
 
-// ".tmp" is a file format used by the ImageStack tool (see https://github.com/abadams/ImageStack)
-template<typename ImageType, CheckFunc check = CheckReturn>
-bool load_tmp(const std::string &filename, ImageType *im) {
-    static_assert(!ImageType::has_static_halide_type, "");
-
-    FileOpener f(filename, "rb");
+// Read the header of a .tmp file, leaving f positioned at the start of the payload.
+template<CheckFunc check>
+bool read_tmp_header(FileOpener &f, halide_type_t *type, std::vector<int> *extents) {
     if (!check(f.f != nullptr, "File could not be opened for reading")) {
         return false;
     }
@@ -1215,8 +1326,22 @@ bool load_tmp(const std::string &filename, ImageType *im) {
         return false;
     }
 
-    const halide_type_t im_type = tmp_code_to_halide_type()[header[4]];
-    std::vector<int> im_dimensions = {header[0], header[1], header[2], header[3]};
+    *type = tmp_code_to_halide_type()[header[4]];
+    *extents = {header[0], header[1], header[2], header[3]};
+    return true;
+}
+
+// ".tmp" is a file format used by the ImageStack tool (see https://github.com/abadams/ImageStack)
+template<typename ImageType, CheckFunc check = CheckReturn>
+bool load_tmp(const std::string &filename, ImageType *im) {
+    static_assert(!ImageType::has_static_halide_type, "");
+
+    FileOpener f(filename, "rb");
+    halide_type_t im_type;
+    std::vector<int> im_dimensions;
+    if (!read_tmp_header<check>(f, &im_type, &im_dimensions)) {
+        return false;
+    }
     *im = ImageType(im_type, im_dimensions);
 
     // This should never fail unless the default Buffer<> constructor behavior changes.
@@ -1341,11 +1466,10 @@ enum MatlabClassCode {
     mxUINT64_CLASS = 15
 };
 
-template<typename ImageType, CheckFunc check = CheckReturn>
-bool load_mat(const std::string &filename, ImageType *im) {
-    static_assert(!ImageType::has_static_halide_type, "");
-
-    FileOpener f(filename, "rb");
+// Read the header of a .mat file holding a single uncompressed numeric
+// array, leaving f positioned at the start of the payload.
+template<CheckFunc check>
+bool read_mat_header(FileOpener &f, halide_type_t *type, std::vector<int> *extents) {
     if (!check(f.f != nullptr, "File could not be opened for reading")) {
         return false;
     }
@@ -1382,8 +1506,8 @@ bool load_mat(const std::string &filename, ImageType *im) {
         return false;
     }
     int dims = shape_header[1] / 4;
-    std::vector<int> extents(dims);
-    if (!check(f.read_vector(&extents), "Could not read .mat header\n")) {
+    extents->resize(dims);
+    if (!check(f.read_vector(extents), "Could not read .mat header\n")) {
         return false;
     }
     if (dims & 1) {
@@ -1417,38 +1541,53 @@ bool load_mat(const std::string &filename, ImageType *im) {
     if (!check(f.read_array(payload_header), "Could not read .mat header\n")) {
         return false;
     }
-    halide_type_t type;
     switch (payload_header[0]) {
     case miINT8:
-        type = halide_type_of<int8_t>();
+        *type = halide_type_of<int8_t>();
         break;
     case miINT16:
-        type = halide_type_of<int16_t>();
+        *type = halide_type_of<int16_t>();
         break;
     case miINT32:
-        type = halide_type_of<int32_t>();
+        *type = halide_type_of<int32_t>();
         break;
     case miINT64:
-        type = halide_type_of<int64_t>();
+        *type = halide_type_of<int64_t>();
         break;
     case miUINT8:
-        type = halide_type_of<uint8_t>();
+        *type = halide_type_of<uint8_t>();
         break;
     case miUINT16:
-        type = halide_type_of<uint16_t>();
+        *type = halide_type_of<uint16_t>();
         break;
     case miUINT32:
-        type = halide_type_of<uint32_t>();
+        *type = halide_type_of<uint32_t>();
         break;
     case miUINT64:
-        type = halide_type_of<uint64_t>();
+        *type = halide_type_of<uint64_t>();
         break;
     case miSINGLE:
-        type = halide_type_of<float>();
+        *type = halide_type_of<float>();
         break;
     case miDOUBLE:
-        type = halide_type_of<double>();
+        *type = halide_type_of<double>();
         break;
+    default:
+        return check(false, "Could not parse this .mat file: unsupported payload type\n");
+    }
+
+    return true;
+}
+
+template<typename ImageType, CheckFunc check = CheckReturn>
+bool load_mat(const std::string &filename, ImageType *im) {
+    static_assert(!ImageType::has_static_halide_type, "");
+
+    FileOpener f(filename, "rb");
+    halide_type_t type;
+    std::vector<int> extents;
+    if (!read_mat_header<check>(f, &type, &extents)) {
+        return false;
     }
 
     *im = ImageType(type, extents);
@@ -1679,6 +1818,348 @@ bool save_mat(ImageType &im, const std::string &filename) {
     return true;
 }
 
+// ".npy" is the NumPy array format documented here:
+// https://numpy.org/doc/stable/reference/generated/numpy.lib.format.html
+//
+// C-order arrays are loaded with their dimensions reversed, so that the
+// last (innermost) axis of the array becomes dimension 0 of the image.
+// Fortran-order arrays keep their dimension order. Images are always
+// saved in C order.
+
+inline bool host_is_little_endian() {
+    const uint16_t one = 1;
+    return *(const uint8_t *)&one == 1;
+}
+
+// Parse a descr string like "<f4". Returns false for anything other than
+// a scalar int, uint, or float type.
+inline bool npy_descr_to_halide_type(const std::string &descr, halide_type_t *type, bool *byte_swapped) {
+    if (descr.size() != 3 || std::strchr("<>|=", descr[0]) == nullptr) {
+        return false;
+    }
+    halide_type_code_t code;
+    switch (descr[1]) {
+    case 'i':
+        code = halide_type_int;
+        break;
+    case 'u':
+        code = halide_type_uint;
+        break;
+    case 'f':
+        code = halide_type_float;
+        break;
+    default:
+        return false;
+    }
+    const int bytes = descr[2] - '0';
+    if (!(bytes == 1 || bytes == 2 || bytes == 4 || bytes == 8) ||
+        (code == halide_type_float && bytes < 4)) {
+        return false;
+    }
+    *type = halide_type_t(code, bytes * 8);
+    *byte_swapped = bytes > 1 && ((descr[0] == '<' && !host_is_little_endian()) ||
+                                  (descr[0] == '>' && host_is_little_endian()));
+    return true;
+}
+
+// Returns the empty string if the type can't be stored in a .npy file.
+inline std::string halide_type_to_npy_descr(const halide_type_t &type) {
+    char kind;
+    switch (type.code) {
+    case halide_type_int:
+        kind = 'i';
+        break;
+    case halide_type_uint:
+        kind = 'u';
+        break;
+    case halide_type_float:
+        kind = 'f';
+        break;
+    default:
+        return "";
+    }
+    const int bytes = type.bits / 8;
+    if (type.lanes != 1 || bytes * 8 != type.bits ||
+        !(bytes == 1 || bytes == 2 || bytes == 4 || bytes == 8) ||
+        (kind == 'f' && bytes < 4)) {
+        return "";
+    }
+    const char order = bytes == 1 ? '|' : (host_is_little_endian() ? '<' : '>');
+    return std::string{order, kind, (char)('0' + bytes)};
+}
+
+inline void swap_bytes_in_place(uint8_t *data, size_t count, int elem_size) {
+    for (size_t i = 0; i < count; i++, data += elem_size) {
+        std::reverse(data, data + elem_size);
+    }
+}
+
+// Read the header of a .npy file, leaving f positioned at the start of the payload.
+// *byte_swapped is set if the payload is not in the host's byte order.
+template<CheckFunc check>
+bool read_npy_header(FileOpener &f, halide_type_t *type, std::vector<int> *extents, bool *byte_swapped) {
+    if (!check(f.f != nullptr, "File could not be opened for reading")) {
+        return false;
+    }
+
+    uint8_t preamble[8];
+    if (!check(f.read_array(preamble), "Could not read .npy header")) {
+        return false;
+    }
+    if (!check(memcmp(preamble, "\x93NUMPY", 6) == 0, "Bad magic number in .npy file")) {
+        return false;
+    }
+
+    // Version 1.0 has a 2-byte header length; 2.0 and 3.0 have a 4-byte one.
+    uint32_t header_len = 0;
+    if (preamble[6] == 1) {
+        uint8_t len[2];
+        if (!check(f.read_array(len), "Could not read .npy header")) {
+            return false;
+        }
+        header_len = len[0] | (len[1] << 8);
+    } else if (preamble[6] == 2 || preamble[6] == 3) {
+        uint8_t len[4];
+        if (!check(f.read_array(len), "Could not read .npy header")) {
+            return false;
+        }
+        header_len = len[0] | (len[1] << 8) | (len[2] << 16) | ((uint32_t)len[3] << 24);
+    } else {
+        return check(false, "Unsupported .npy format version");
+    }
+
+    std::string header(header_len, ' ');
+    if (!check(f.read_bytes(&header[0], header_len), "Could not read .npy header")) {
+        return false;
+    }
+
+    // The header is a Python dict literal, e.g.
+    // {'descr': '<f4', 'fortran_order': False, 'shape': (3, 4), }
+    auto find_value = [&](const char *key) -> size_t {
+        size_t pos = header.find(key);
+        if (pos == std::string::npos) {
+            return pos;
+        }
+        pos = header.find(':', pos + strlen(key));
+        if (pos == std::string::npos) {
+            return pos;
+        }
+        return header.find_first_not_of(' ', pos + 1);
+    };
+
+    const size_t descr_pos = find_value("'descr'");
+    const size_t fortran_pos = find_value("'fortran_order'");
+    const size_t shape_pos = find_value("'shape'");
+    if (!check(descr_pos != std::string::npos && fortran_pos != std::string::npos &&
+                   shape_pos != std::string::npos && header[shape_pos] == '(',
+               "Could not parse .npy header")) {
+        return false;
+    }
+
+    const char quote = header[descr_pos];
+    const size_t descr_end = header.find(quote, descr_pos + 1);
+    if (!check(descr_end != std::string::npos &&
+                   npy_descr_to_halide_type(header.substr(descr_pos + 1, descr_end - descr_pos - 1), type, byte_swapped),
+               "Unsupported dtype in .npy file")) {
+        return false;
+    }
+
+    const bool fortran_order = header.compare(fortran_pos, 4, "True") == 0;
+
+    const size_t shape_end = header.find(')', shape_pos);
+    if (!check(shape_end != std::string::npos, "Could not parse .npy header")) {
+        return false;
+    }
+    extents->clear();
+    const char *p = header.c_str() + shape_pos + 1;
+    const char *end = header.c_str() + shape_end;
+    while (true) {
+        while (p < end && (*p == ' ' || *p == ',' || *p == 'L')) {
+            p++;
+        }
+        if (p >= end) {
+            break;
+        }
+        char *next = nullptr;
+        const long long extent = strtoll(p, &next, 10);
+        if (!check(next != p && extent > 0 && extent <= 0x7fffffff, "Bad shape in .npy header")) {
+            return false;
+        }
+        extents->push_back((int)extent);
+        p = next;
+    }
+    if (!fortran_order) {
+        std::reverse(extents->begin(), extents->end());
+    }
+
+    return true;
+}
+
+template<typename ImageType, CheckFunc check = CheckReturn>
+bool load_npy(const std::string &filename, ImageType *im) {
+    static_assert(!ImageType::has_static_halide_type, "");
+
+    FileOpener f(filename, "rb");
+    halide_type_t type;
+    std::vector<int> extents;
+    bool byte_swapped = false;
+    if (!read_npy_header<check>(f, &type, &extents, &byte_swapped)) {
+        return false;
+    }
+
+    *im = ImageType(type, extents);
+
+    // This should never fail unless the default Buffer<> constructor behavior changes.
+    if (!check(buffer_is_compact_planar(*im), "load_npy() requires compact planar images")) {
+        return false;
+    }
+
+    if (!check(f.read_bytes(im->begin(), im->size_in_bytes()), "Could not read .npy payload")) {
+        return false;
+    }
+
+    if (byte_swapped) {
+        swap_bytes_in_place((uint8_t *)im->begin(), im->number_of_elements(), type.bits / 8);
+    }
+
+    im->set_host_dirty();
+    return true;
+}
+
+inline const std::set<FormatInfo> &query_npy() {
+    // Like MAT files, our support arbitrarily stops at 16 dimensions.
+    static std::set<FormatInfo> info = []() {
+        std::set<FormatInfo> s;
+        for (int i = 0; i < 16; i++) {
+            s.insert({halide_type_t(halide_type_float, 32), i});
+            s.insert({halide_type_t(halide_type_float, 64), i});
+            s.insert({halide_type_t(halide_type_uint, 8), i});
+            s.insert({halide_type_t(halide_type_int, 8), i});
+            s.insert({halide_type_t(halide_type_uint, 16), i});
+            s.insert({halide_type_t(halide_type_int, 16), i});
+            s.insert({halide_type_t(halide_type_uint, 32), i});
+            s.insert({halide_type_t(halide_type_int, 32), i});
+            s.insert({halide_type_t(halide_type_uint, 64), i});
+            s.insert({halide_type_t(halide_type_int, 64), i});
+        }
+        return s;
+    }();
+    return info;
+}
+
+template<typename ImageType, CheckFunc check = CheckReturn>
+bool save_npy(ImageType &im, const std::string &filename) {
+    static_assert(!ImageType::has_static_halide_type, "");
+
+    im.copy_to_host();
+
+    const std::string descr = halide_type_to_npy_descr(im.type());
+    if (!check(!descr.empty(), "Unsupported type for .npy file")) {
+        return false;
+    }
+
+    // In C order, the outermost dimension comes first.
+    std::string header = "{'descr': '" + descr + "', 'fortran_order': False, 'shape': (";
+    for (int d = im.dimensions() - 1; d >= 0; d--) {
+        header += std::to_string(im.dim(d).extent());
+        if (d > 0) {
+            header += ", ";
+        }
+    }
+    if (im.dimensions() == 1) {
+        header += ",";
+    }
+    header += "), }";
+
+    // Pad the header with spaces and a newline so that the payload
+    // starts on a 64-byte boundary.
+    const size_t preamble_size = 10;
+    header.append((64 - (preamble_size + header.size() + 1) % 64) % 64, ' ');
+    header += '\n';
+
+    const uint8_t preamble[preamble_size] = {
+        0x93, 'N', 'U', 'M', 'P', 'Y', 1, 0,
+        (uint8_t)(header.size() & 0xff), (uint8_t)(header.size() >> 8)};
+
+    FileOpener f(filename, "wb");
+    if (!check(f.f != nullptr, "File could not be opened for writing")) {
+        return false;
+    }
+    if (!check(f.write_array(preamble) && f.write_bytes(header.data(), header.size()),
+               "Could not write .npy header")) {
+        return false;
+    }
+
+    if (!write_planar_payload<ImageType, check>(im, f)) {
+        return false;
+    }
+
+    return true;
+}
+
+// Find the payload of a raw image file that map_image() can wrap in
+// place: its type, its offset into the file, and the shape to wrap it
+// with. Returns false if the file has to be copied by load() instead,
+// because it is in some other format, its payload is in a non-native
+// byte order (including 16-bit pnm files, which are big-endian), or its
+// header is bad. Errors are not reported here; load() reports them.
+inline bool find_mappable_payload(const std::string &filename, halide_type_t *type, size_t *offset,
+                                  std::vector<halide_dimension_t> *shape) {
+    const std::string ext = get_lowercase_extension(filename);
+    FileOpener f(filename, "rb");
+    std::vector<int> extents;
+    shape->clear();
+    if (ext == "tmp") {
+        if (!read_tmp_header<CheckReturn>(f, type, &extents)) {
+            return false;
+        }
+    } else if (ext == "mat") {
+        if (!read_mat_header<CheckReturn>(f, type, &extents)) {
+            return false;
+        }
+    } else if (ext == "npy") {
+        bool byte_swapped = false;
+        if (!read_npy_header<CheckReturn>(f, type, &extents, &byte_swapped) || byte_swapped) {
+            return false;
+        }
+    } else if (ext == "pgm" || ext == "ppm") {
+        const int channels = ext == "ppm" ? 3 : 1;
+        int width, height, bit_depth;
+        if (!read_pnm_header<CheckReturn>(f, channels == 3 ? "P6" : "P5", &width, &height, &bit_depth) ||
+            bit_depth != 8 || width <= 0 || height <= 0 ||
+            (int64_t)width * height * channels > 0x7fffffff) {
+            return false;
+        }
+        // pnm payloads are interleaved, so the channel dimension is innermost in memory.
+        *type = halide_type_t(halide_type_uint, 8);
+        shape->push_back(halide_dimension_t(0, width, channels));
+        shape->push_back(halide_dimension_t(0, height, width * channels));
+        if (channels > 1) {
+            shape->push_back(halide_dimension_t(0, channels, 1));
+        }
+    } else {
+        return false;
+    }
+
+    if (shape->empty()) {
+        int64_t stride = 1;
+        for (int extent : extents) {
+            if (stride * extent > 0x7fffffff) {
+                return false;
+            }
+            shape->push_back(halide_dimension_t(0, extent, (int32_t)stride));
+            stride *= extent;
+        }
+    }
+
+    const long pos = ftell(f.f);
+    if (pos < 0) {
+        return false;
+    }
+    *offset = (size_t)pos;
+    return true;
+}
+
 template<typename ImageType, Internal::CheckFunc check = Internal::CheckReturn>
 bool load_tiff(const std::string &filename, ImageType *im) {
     static_assert(!ImageType::has_static_halide_type, "");
@@ -1991,6 +2472,7 @@ bool find_imageio(const std::string &filename, ImageIO<ImageType, check> *result
         {"ppm", {load_ppm<ImageType, check>, save_ppm<ConstImageType, check>, query_ppm}},
         {"tmp", {load_tmp<ImageType, check>, save_tmp<ConstImageType, check>, query_tmp}},
         {"mat", {load_mat<ImageType, check>, save_mat<ConstImageType, check>, query_mat}},
+        {"npy", {load_npy<ImageType, check>, save_npy<ConstImageType, check>, query_npy}},
         {"tiff", {load_tiff<ImageType, check>, save_tiff<ConstImageType, check>, query_tiff}},
     };
     std::string ext = Internal::get_lowercase_extension(filename);
@@ -2036,6 +2518,29 @@ FormatInfo best_save_format(const ImageType &im, const std::set<FormatInfo> &inf
     return best;
 }
 
+// Call f(0) ... f(n - 1) from up to num_threads threads (one per
+// hardware thread if num_threads is zero or negative).
+inline void parallel_for_each_index(size_t n, int num_threads, const std::function<void(size_t)> &f) {
+    if (num_threads <= 0) {
+        num_threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    }
+    const size_t thread_count = std::min((size_t)num_threads, n);
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < n; i = next++) {
+            f(i);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < thread_count; t++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &t : threads) {
+        t.join();
+    }
+}
+
 }  // namespace Internal
 
 struct ImageTypeConversion {
@@ -2239,6 +2744,55 @@ bool load(const std::string &filename, ImageType *im) {
     return true;
 }
 
+// Load the Image from a raw .tmp, .mat, .npy, or 8-bit .pgm/.ppm file by
+// mapping the file into memory and wrapping its payload in place, so no
+// data is read or copied up front. The Image aliases *mapping, which
+// must outlive it; writes to the Image go to private copy-on-write pages
+// and never reach the file. Note that pgm/ppm Images are wrapped with
+// interleaved strides (dimension 2 has stride 1), unlike those from
+// load(). Files that can't be wrapped in place (other formats, 16-bit
+// pnm files, payloads in a non-native byte order, or misaligned
+// payloads) are read with load() instead, leaving *mapping empty.
+// Returns false upon failure.
+template<typename ImageType, Internal::CheckFunc check = Internal::CheckReturn>
+bool map_image(const std::string &filename, MappedFile *mapping, ImageType *im) {
+    mapping->unmap();
+
+    halide_type_t type;
+    size_t offset = 0;
+    std::vector<halide_dimension_t> shape;
+    if (!Internal::find_mappable_payload(filename, &type, &offset, &shape)) {
+        return load<ImageType, check>(filename, im);
+    }
+
+    const size_t elem_size = type.bits / 8;
+    size_t payload_bytes = elem_size;
+    for (const auto &d : shape) {
+        payload_bytes *= d.extent;
+    }
+    if (offset % elem_size != 0 ||
+        !mapping->map(filename) ||
+        mapping->size() < offset + payload_bytes) {
+        mapping->unmap();
+        return load<ImageType, check>(filename, im);
+    }
+
+    // Allow statically-typed images to be passed as the out-param, but do
+    // a runtime check to ensure
+    if (ImageType::has_static_halide_type) {
+        const halide_type_t expected_type = ImageType::static_halide_type();
+        if (!check(type == expected_type, "Image loaded did not match the expected type")) {
+            mapping->unmap();
+            return false;
+        }
+    }
+    using DynamicImageType = typename Internal::ImageTypeWithElemType<ImageType, void>::type;
+    DynamicImageType im_d(type, mapping->data() + offset, (int)shape.size(), shape.data());
+    *im = im_d.template as<typename ImageType::ElemType>();
+    im->set_host_dirty();
+    return true;
+}
+
 // Save the Image in the format associated with the filename's extension.
 // If the format can't represent the Image without losing data, fail.
 // Returns false upon failure.
@@ -2273,6 +2827,43 @@ bool save_query(const std::string &filename, std::set<FormatInfo> *info) {
     return true;
 }
 
+// Load a batch of Images, running up to num_threads calls to load()
+// concurrently (one per hardware thread if num_threads is zero).
+// Decoding a single PNG or JPEG is inherently serial, so this is the way
+// to use more than one core when loading many of them.
+// (*images)[i] is loaded from filenames[i].
+// Returns false if any Image failed to load.
+template<typename ImageType, Internal::CheckFunc check = Internal::CheckReturn>
+bool load_images(const std::vector<std::string> &filenames, std::vector<ImageType> *images, int num_threads = 0) {
+    images->clear();
+    images->resize(filenames.size());
+    std::atomic<bool> success{true};
+    Internal::parallel_for_each_index(filenames.size(), num_threads, [&](size_t i) {
+        if (!load<ImageType, check>(filenames[i], &(*images)[i])) {
+            success = false;
+        }
+    });
+    return success;
+}
+
+// Save a batch of Images, running up to num_threads calls to save()
+// concurrently (one per hardware thread if num_threads is zero).
+// images[i] is saved to filenames[i].
+// Returns false if any Image failed to save.
+template<typename ImageType, Internal::CheckFunc check = Internal::CheckReturn>
+bool save_images(std::vector<ImageType> &images, const std::vector<std::string> &filenames, int num_threads = 0) {
+    if (!check(images.size() == filenames.size(), "save_images() needs one filename per Image")) {
+        return false;
+    }
+    std::atomic<bool> success{true};
+    Internal::parallel_for_each_index(images.size(), num_threads, [&](size_t i) {
+        if (!save<ImageType, check>(images[i], filenames[i])) {
+            success = false;
+        }
+    });
+    return success;
+}
+
 // Fancy wrapper to call load() with CheckFail, inferring the return type;
 // this allows you to simply use
 //
@@ -1,13 +1,18 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <condition_variable>
 #include <cstring>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <list>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 #ifdef _MSC_VER
@@ -157,17 +162,32 @@ T get_value_as(const halide_trace_packet_t &p, int idx) {
 struct PacketAndPayload : public halide_trace_packet_t {
     uint8_t payload[4096];
 
+    // Packets are small, so read stdin in large chunks rather than
+    // making two read calls per packet.
+    struct InputBuffer {
+        std::vector<char> data = std::vector<char>(1 << 20);
+        size_t begin = 0, end = 0;
+    };
+
     static bool read_or_die(void *buf, size_t count) {
+        static InputBuffer in;
         char *p = (char *)buf;
         char *p_end = p + count;
         while (p < p_end) {
-            int64_t bytes_read = ::read(STDIN_FILENO, p, p_end - p);
-            if (bytes_read == 0) {
-                return false;  // EOF
-            } else if (bytes_read < 0) {
-                fail() << "Unable to read packet";
+            if (in.begin == in.end) {
+                int64_t bytes_read = ::read(STDIN_FILENO, in.data.data(), in.data.size());
+                if (bytes_read == 0) {
+                    return false;  // EOF
+                } else if (bytes_read < 0) {
+                    fail() << "Unable to read packet";
+                }
+                in.begin = 0;
+                in.end = bytes_read;
             }
-            p += bytes_read;
+            size_t n = std::min((size_t)(p_end - p), in.end - in.begin);
+            memcpy(p, in.data.data() + in.begin, n);
+            in.begin += n;
+            p += n;
         }
         assert(p == p_end);
         return true;
@@ -279,8 +299,19 @@ struct FuncInfo {
     } stats;
 };
 
+// Options that control how the frames are rendered, rather than what
+// is drawn in them.
+struct RenderOptions {
+    // Number of threads used to draw and composite each frame.
+    int num_threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    // Only frames in [first_frame, end_frame) are written.
+    int64_t first_frame = 0;
+    int64_t end_frame = std::numeric_limits<int64_t>::max();
+};
+
 struct VizState {
     GlobalConfig globals;
+    RenderOptions options;
     std::map<std::string, FuncInfo> funcs;
 };
 
@@ -416,6 +447,13 @@ Funcs.
      tags in the trace data, overriding the auto-generated layouts.  This is
      the default.
 
+ --threads n: Use n threads to draw and composite each frame. The default
+     is the number of hardware threads.
+
+ --window start end: Only output frames [start, end). Frames before start
+     are still simulated, but not rendered; reading of the trace stops once
+     frame end is reached. The default is to output every frame.
+
  --help: Write this usage information to stdout, and exit.
 
  --verbose: Write additional informational messages to stderr.
@@ -852,6 +890,15 @@ void process_args(int argc, char **argv, VizState *state) {
             int g = parse_int(argv[++i]);
             int b = parse_int(argv[++i]);
             globals.default_uninitialized_memory_color = ((b & 255) << 16) | ((g & 255) << 8) | (r & 255);
+        } else if (next == "--threads") {
+            expect(i + 1 < argc, i);
+            state->options.num_threads = parse_int(argv[++i]);
+            expect(state->options.num_threads > 0, i);
+        } else if (next == "--window") {
+            expect(i + 2 < argc, i);
+            state->options.first_frame = parse_int(argv[++i]);
+            state->options.end_frame = parse_int(argv[++i]);
+            expect(0 <= state->options.first_frame && state->options.first_frame <= state->options.end_frame, i);
         } else if (next == "--ignore_tags" || next == "--no-ignore_tags") {
             // Already processed, just continue
         } else if (next == "--verbose" || next == "--no-verbose") {
@@ -863,12 +910,118 @@ void process_args(int argc, char **argv, VizState *state) {
     }
 }
 
+// Runs a function over a fixed number of bands on a persistent set of
+// threads. Band 0 runs on the calling thread.
+class BandPool {
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    const std::function<void(int)> *task = nullptr;
+    uint64_t generation = 0;
+    int remaining = 0;
+    bool shutting_down = false;
+
+    void worker(int band) {
+        uint64_t seen = 0;
+        for (;;) {
+            const std::function<void(int)> *f;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&]() { return shutting_down || generation != seen; });
+                if (shutting_down) {
+                    return;
+                }
+                seen = generation;
+                f = task;
+            }
+            (*f)(band);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--remaining == 0) {
+                    done.notify_one();
+                }
+            }
+        }
+    }
+
+public:
+    explicit BandPool(int num_bands) {
+        for (int i = 1; i < num_bands; i++) {
+            workers.emplace_back([this, i]() { worker(i); });
+        }
+    }
+
+    BandPool(const BandPool &) = delete;
+    void operator=(const BandPool &) = delete;
+
+    ~BandPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            shutting_down = true;
+        }
+        wake.notify_all();
+        for (auto &t : workers) {
+            t.join();
+        }
+    }
+
+    int size() const {
+        return (int)workers.size() + 1;
+    }
+
+    // Call f(0) ... f(size() - 1) in parallel, and wait for all of them.
+    void run(const std::function<void(int)> &f) {
+        if (workers.empty()) {
+            f(0);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task = &f;
+            remaining = (int)workers.size();
+            generation++;
+        }
+        wake.notify_all();
+        f(0);
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&]() { return remaining == 0; });
+    }
+};
+
 // There are three layers - image data, an animation on top of
 // it, and text labels. These layers get composited.
-struct Surface {
+//
+// Drawing into the image and animation layers is deferred: each draw
+// is recorded as a DrawOp, and the ops are replayed at the next frame,
+// or sooner if too many are pending, by a pool of threads, each owning
+// a horizontal band of the frame and replaying (in trace order) only
+// the ops that touch its rows. Trace packets are still processed
+// serially; only the drawing is split across threads. This
+// gives exactly the same pixels as drawing every op in order on a
+// single thread, however the Funcs overlap on screen. Compositing and
+// decay are split into the same bands.
+class Surface {
     const Point frame_size;
     std::vector<uint32_t> image, anim, anim_decay, text_buf, blend;
 
+    // A rectangle of pixels to update in the image or anim layer. Each
+    // pixel p becomes (p & mask) | bits, or part of a checkerboard.
+    struct DrawOp {
+        int x_min, y_min, x_end, y_end;
+        uint32_t mask, bits;
+        bool to_anim, checkerboard;
+    };
+
+    BandPool pool;
+    std::vector<int> band_start;                 // First row of each band, plus frame_size.y
+    std::vector<std::vector<DrawOp>> band_ops;  // Ops not yet drawn, by band
+
+    // The number of ops recorded since the last flush. Many packets can
+    // arrive between frames (e.g. with a large --timestep), so ops are
+    // drawn early once there are this many, to bound their memory.
+    size_t pending_ops = 0;
+    static constexpr size_t max_pending_ops = 1 << 16;
+
     // Composite a single pixel of 'over' over a single pixel of 'under', writing the result into dst.
     // Note that under or over might be dst.
     static void composite_one(const uint32_t *under, const uint32_t *over, uint32_t *dst) {
@@ -891,10 +1044,10 @@ struct Surface {
         }
     }
 
-    void do_decay(int decay_factor, uint32_t *dst) {
+    static void do_decay(int decay_factor, uint32_t *dst, uint32_t *dst_end) {
         if (decay_factor != 1) {
             const uint32_t inv_d1 = (1 << 24) / std::max(1, decay_factor);
-            for (uint32_t *dst_end = dst + frame_elems(); dst < dst_end; ++dst) {
+            for (; dst < dst_end; ++dst) {
                 uint32_t color = *dst;
                 uint32_t rgb = color & 0x00ffffff;
                 uint32_t alpha = (color >> 24);
@@ -905,58 +1058,71 @@ struct Surface {
         }
     }
 
-    // TODO this doesn't bounds-check against frame_size
-    void do_draw_pixel(const float zoom, const int x, const int y, const uint32_t color, uint32_t *dst) {
-        const int izoom = (int)std::ceil(zoom);
-        const int y_advance = frame_size.x - izoom;
-        dst += frame_size.x * y + x;
-        for (int dy = 0; dy < izoom; dy++) {
-            for (int dx = 0; dx < izoom; dx++) {
-                *dst++ = color;
-            }
-            dst += y_advance;
-        }
-    }
-
-    // Fill a rectangle in dst with color.
-    // opaque RGB(1,1,1) is a "magic" color that means "fill with checkerboard".
-    // dst is assumed to point to the start of a frame_size buffer.
-    void fill_rect(int left, int top, int width, int height, uint32_t color, uint32_t *dst) {
-        const int x_min = std::max(left, 0);
-        const int x_end = std::min(left + width, frame_size.x);
-        const int y_min = std::max(top, 0);
-        const int y_end = std::min(top + height, frame_size.y);
-        const int y_stride = frame_size.x - (x_end - x_min);
-        dst += y_min * frame_size.x + x_min;
-        if (color == 0xff010101) {
-            for (int y = y_min; y < y_end; y++) {
-                for (int x = x_min; x < x_end; x++) {
+    void draw_op(const DrawOp &op, int y_min, int y_end) {
+        uint32_t *dst = op.to_anim ? anim.data() : image.data();
+        for (int y = std::max(op.y_min, y_min); y < std::min(op.y_end, y_end); y++) {
+            uint32_t *row = dst + (size_t)y * frame_size.x;
+            if (op.checkerboard) {
+                for (int x = op.x_min; x < op.x_end; x++) {
                     const int check = ((x / 16) % 2) ^ ((y / 16) % 2);
-                    *dst++ = check ? 0xff808080 : 0xffffffff;
+                    row[x] = check ? 0xff808080 : 0xffffffff;
                 }
-                dst += y_stride;
-            }
-        } else {
-            for (int y = y_min; y < y_end; y++) {
-                for (int x = x_min; x < x_end; x++) {
-                    *dst++ = color;
+            } else {
+                for (int x = op.x_min; x < op.x_end; x++) {
+                    row[x] = (row[x] & op.mask) | op.bits;
                 }
-                dst += y_stride;
             }
         }
     }
 
+    // Record an op, clipped to the frame, in every band it touches.
+    void add_op(int left, int top, int width, int height, uint32_t mask, uint32_t bits,
+                bool to_anim, bool checkerboard = false) {
+        DrawOp op;
+        op.x_min = std::max(left, 0);
+        op.x_end = std::min(left + width, frame_size.x);
+        op.y_min = std::max(top, 0);
+        op.y_end = std::min(top + height, frame_size.y);
+        if (op.x_min >= op.x_end || op.y_min >= op.y_end) {
+            return;
+        }
+        op.mask = mask;
+        op.bits = bits;
+        op.to_anim = to_anim;
+        op.checkerboard = checkerboard;
+        const int first_band = std::upper_bound(band_start.begin(), band_start.end(), op.y_min) - band_start.begin() - 1;
+        for (int b = first_band; b < pool.size() && band_start[b] < op.y_end; b++) {
+            band_ops[b].push_back(op);
+        }
+        if (++pending_ops >= max_pending_ops) {
+            flush();
+        }
+    }
+
+    // Run f(begin, end) over the pixel range of every band in parallel.
+    void for_each_band(const std::function<void(size_t, size_t)> &f) {
+        pool.run([&](int b) {
+            f((size_t)band_start[b] * frame_size.x, (size_t)band_start[b + 1] * frame_size.x);
+        });
+    }
+
+    // Fill a rectangle in the image layer with color.
+    // opaque RGB(1,1,1) is a "magic" color that means "fill with checkerboard".
+    void fill_rect(int left, int top, int width, int height, uint32_t color) {
+        add_op(left, top, width, height, 0, color, false, color == 0xff010101);
+    }
+
     // Set all boxes corresponding to positions in a Func's allocation to
     // the given color. Recursive to handle arbitrary
     // dimensionalities. Used by begin and end realization events.
-    void do_fill_realization(uint32_t *dst, uint32_t color,
+    void do_fill_realization(uint32_t color,
                              const FuncInfo &fi, const halide_trace_packet_t &p,
                              int current_dimension = 0, int x_off = 0, int y_off = 0) {
         if (2 * current_dimension == p.dimensions) {
             const int x_min = x_off * fi.config.zoom + fi.config.pos.x;
             const int y_min = y_off * fi.config.zoom + fi.config.pos.y;
             const int izoom = (int)std::ceil(fi.config.zoom);
-            fill_rect(x_min, y_min, izoom, izoom, color, dst);
+            fill_rect(x_min, y_min, izoom, izoom, color);
         } else {
             const int *coords = p.coordinates();
             const int min = coords[current_dimension * 2 + 0];
@@ -966,7 +1132,7 @@ struct Surface {
             x_off += pt.x * min;
             y_off += pt.y * min;
             for (int i = 0; i < extent; i++) {
-                do_fill_realization(dst, color, fi, p, current_dimension + 1, x_off, y_off);
+                do_fill_realization(color, fi, p, current_dimension + 1, x_off, y_off);
                 x_off += pt.x;
                 y_off += pt.y;
             }
@@ -974,13 +1140,18 @@ struct Surface {
     }
 
 public:
-    Surface(const Point &fs)
+    Surface(const Point &fs, int num_threads)
         : frame_size(fs),
           image(frame_elems()),
           anim(frame_elems()),
           anim_decay(frame_elems()),
           text_buf(frame_elems()),
-          blend(frame_elems()) {
+          blend(frame_elems()),
+          pool(std::max(1, std::min(num_threads, fs.y))) {
+        for (int b = 0; b <= pool.size(); b++) {
+            band_start.push_back((int)(((int64_t)frame_size.y * b) / pool.size()));
+        }
+        band_ops.resize(pool.size());
     }
 
     Surface(const Surface &) = delete;
@@ -994,10 +1165,6 @@ public:
         return this->blend.data();
     }
 
-    uint32_t get_image_pixel(const int x, const int y) const {
-        return image[frame_size.x * y + x];
-    }
-
     void draw_text(const std::string &text, const Point &pos, uint32_t color, float h_scale = 1.0f) {
         uint32_t *dst = text_buf.data();
 
@@ -1031,49 +1198,67 @@ public:
     }
 
     void draw_anim_pixel(const float zoom, int x, int y, uint32_t color) {
-        do_draw_pixel(zoom, x, y, color, anim.data());
+        const int izoom = (int)std::ceil(zoom);
+        add_op(x, y, izoom, izoom, 0, color, true);
     }
 
-    void draw_image_pixel(const float zoom, int x, int y, uint32_t color) {
-        do_draw_pixel(zoom, x, y, color, image.data());
+    // Update the image layer at x, y, keeping the bits of the current
+    // color that are set in mask (e.g. the other color channels).
+    void draw_image_pixel(const float zoom, int x, int y, uint32_t mask, uint32_t bits) {
+        const int izoom = (int)std::ceil(zoom);
+        add_op(x, y, izoom, izoom, mask, bits, false);
     }
 
     void fill_realization(uint32_t color, const FuncInfo &fi, const halide_trace_packet_t &p) {
-        do_fill_realization(image.data(), color, fi, p);
+        do_fill_realization(color, fi, p);
     }
 
-    void composite() {
-        // Composite text over anim over image
-        uint32_t *anim_decay_px = anim_decay.data();
-        uint32_t *anim_px = anim.data();
-        uint32_t *image_px = image.data();
-        uint32_t *text_px = text_buf.data();
-        uint32_t *blend_px = blend.data();
-        for (size_t i = 0; i < image.size(); i++) {
-            // anim over anim_decay -> anim_decay
-            composite_one(anim_decay_px, anim_px, anim_decay_px);
-            // anim_decay over image -> blend
-            composite_one(image_px, anim_decay_px, blend_px);
-            // text over blend -> blend
-            composite_one(blend_px, text_px, blend_px);
-            anim_decay_px++;
-            anim_px++;
-            image_px++;
-            text_px++;
-            blend_px++;
-        }
+    // Draw everything recorded since the last call.
+    void flush() {
+        pool.run([&](int b) {
+            for (const DrawOp &op : band_ops[b]) {
+                draw_op(op, band_start[b], band_start[b + 1]);
+            }
+            band_ops[b].clear();
+        });
+        pending_ops = 0;
     }
 
-    void decay_animations(int decay_factor_after_compute, int decay_factor_during_compute) {
-        // Decay the anim_decay
-        do_decay(decay_factor_after_compute, anim_decay.data());
-
-        // Also decay the anim
-        do_decay(decay_factor_during_compute, anim.data());
+    // Composite text over anim over image, and decay the animations
+    // for the next frame. If output is false, the frame will not be
+    // written, so only the state that carries over to later frames is
+    // updated.
+    void composite_and_decay(bool output, int decay_factor_after_compute, int decay_factor_during_compute) {
+        for_each_band([&](size_t begin, size_t end) {
+            uint32_t *anim_decay_px = anim_decay.data() + begin;
+            uint32_t *anim_px = anim.data() + begin;
+            uint32_t *image_px = image.data() + begin;
+            uint32_t *text_px = text_buf.data() + begin;
+            uint32_t *blend_px = blend.data() + begin;
+            for (size_t i = begin; i < end; i++) {
+                // anim over anim_decay -> anim_decay
+                composite_one(anim_decay_px, anim_px, anim_decay_px);
+                if (output) {
+                    // anim_decay over image -> blend
+                    composite_one(image_px, anim_decay_px, blend_px);
+                    // text over blend -> blend
+                    composite_one(blend_px, text_px, blend_px);
+                }
+                anim_decay_px++;
+                anim_px++;
+                image_px++;
+                text_px++;
+                blend_px++;
+            }
+            do_decay(decay_factor_after_compute, anim_decay.data() + begin, anim_decay.data() + end);
+            do_decay(decay_factor_during_compute, anim.data() + begin, anim.data() + end);
+        });
     }
 
     void clear_animations() {
-        std::fill(anim.begin(), anim.end(), 0);
+        for_each_band([&](size_t begin, size_t end) {
+            std::fill(anim.begin() + begin, anim.begin() + end, 0);
+        });
     }
 };
 
@@ -1115,7 +1300,7 @@ int run(bool ignore_trace_tags, FlagProcessor flag_processor) {
         flag_processor(&state);
 
         // allocate the surface after all tags and flags are processed
-        surface = std::unique_ptr<Surface>(new Surface(state.globals.frame_size));
+        surface = std::unique_ptr<Surface>(new Surface(state.globals.frame_size, state.options.num_threads));
 
         if (state.globals.auto_layout_grid.x < 0 || state.globals.auto_layout_grid.y < 0) {
             int cells_needed = 0;
@@ -1158,6 +1343,7 @@ int run(bool ignore_trace_tags, FlagProcessor flag_processor) {
     std::list<std::pair<Label, int>> labels_being_drawn;
     size_t end_counter = 0;
     size_t packet_clock = 0;
+    bool past_end_frame = false;
     for (;;) {
         // Hold for some number of frames once the trace has finished.
         if (end_counter) {
@@ -1172,7 +1358,16 @@ int run(bool ignore_trace_tags, FlagProcessor flag_processor) {
 
             const int64_t frame_bytes = surface->frame_elems() * sizeof(uint32_t);
 
+            // Draw everything since the last frame.
+            surface->flush();
+
             while (halide_clock > video_clock) {
+                const int64_t frame = video_clock / state.globals.timestep;
+                if (frame >= state.options.end_frame) {
+                    past_end_frame = true;
+                    break;
+                }
+
                 // Always render text last, since it's on top of everything
                 // and there's no need to re-render for every packet.
                 for (auto it = labels_being_drawn.begin(); it != labels_being_drawn.end();) {
@@ -1194,18 +1389,26 @@ int run(bool ignore_trace_tags, FlagProcessor flag_processor) {
                     }
                 }
 
-                // Composite text over anim over image
-                surface->composite();
+                // Composite text over anim over image. Frames before
+                // the first one requested are not composited or
+                // written, but their animations still decay.
+                const bool output = frame >= state.options.first_frame;
+                surface->composite_and_decay(output, state.globals.decay_factor_after_compute, state.globals.decay_factor_during_compute);
 
                 // Dump the frame
-                int64_t bytes_written = write(STDOUT_FILENO, surface->frame_data(), frame_bytes);
-                if (bytes_written < frame_bytes) {
-                    fail() << "Could not write frame to stdout.";
+                if (output) {
+                    int64_t bytes_written = write(STDOUT_FILENO, surface->frame_data(), frame_bytes);
+                    if (bytes_written < frame_bytes) {
+                        fail() << "Could not write frame to stdout.";
+                    }
                 }
 
                 video_clock += state.globals.timestep;
+            }
 
-                surface->decay_animations(state.globals.decay_factor_after_compute, state.globals.decay_factor_during_compute);
+            if (past_end_frame) {
+                // There's no need to read the rest of the trace.
+                break;
             }
 
             // Blank anim
@@ -1363,9 +1566,6 @@ int run(bool ignore_trace_tags, FlagProcessor flag_processor) {
                 // image layer in case it's a store or a load from
                 // the input.
                 if (p.event == halide_trace_store || fi.stats.num_realizations == 0 /* load from an input */) {
-                    // Get the old color, in case we're only
-                    // updating one of the color channels.
-                    uint32_t image_color = surface->get_image_pixel(x, y);
                     double value = get_value_as<double>(p, lane);
 
                     // Normalize it.
@@ -1377,15 +1577,14 @@ int run(bool ignore_trace_tags, FlagProcessor flag_processor) {
 
                     if (fi.config.color_dim < 0) {
                         // Grayscale
-                        image_color = (int_value * 0x00010101) | 0xff000000;
+                        surface->draw_image_pixel(fi.config.zoom, x, y, 0, (int_value * 0x00010101) | 0xff000000);
                     } else {
-                        // Color
+                        // Color: only update one of the color channels
+                        // of the old color.
                         uint32_t channel = coords[fi.config.color_dim * p.type.lanes + lane];
                         uint32_t mask = ~(255 << (channel * 8));
-                        image_color &= mask;
-                        image_color |= int_value << (channel * 8);
+                        surface->draw_image_pixel(fi.config.zoom, x, y, mask, int_value << (channel * 8));
                     }
-                    surface->draw_image_pixel(fi.config.zoom, x, y, image_color);
                 }
 
                 // Stores are orange, loads are blue.